@@ -0,0 +1,13 @@
+#version 400 core
+#include "vertex_decode.glsl"
+// Benchmark "vertexformat": todos os pontos caem fora do volume de recorte,
+// entao so a busca e a decodificacao dos vertices sao medidas
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec3 aNormal;
+void main()
+{
+    vec3 p = decodePosition(aPos);
+    vec3 n = decodeNormal(aNormal);
+    gl_Position = vec4(2.0 + 1e-6 * (dot(p, n) + aTexCoord.x + aTexCoord.y), 0.0, 0.0, 1.0);
+}
@@ -0,0 +1,6 @@
+#version 400 core
+out vec4 FragColor;
+void main()
+{
+    FragColor = vec4(1.0);
+}
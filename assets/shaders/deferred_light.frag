@@ -0,0 +1,51 @@
+#version 400 core
+// Passada de iluminacao do caminho deferred: cada fragmento coberto pelo volume de
+// uma luz le o G-buffer, reconstroi a posicao pela profundidade e soma a
+// contribuicao difusa + especular da luz (blending aditivo)
+flat in vec4 LightPositionRadius;
+flat in vec3 LightColor;
+
+out vec4 FragColor;
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+uniform mat4 invViewProjection;
+uniform vec2 screenSize;
+uniform vec3 viewPos;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if (depth == 1.0) // fundo
+        discard;
+
+    vec4 ndc = vec4(gl_FragCoord.xy / screenSize, depth, 1.0) * 2.0 - 1.0;
+    vec4 world = invViewProjection * ndc;
+    vec3 P = world.xyz / world.w;
+
+    vec3 toLight = LightPositionRadius.xyz - P;
+    float d = length(toLight);
+    float radius = LightPositionRadius.w;
+    if (d >= radius)
+        discard;
+    float x = d / radius;
+    float att = (1.0 - x * x) * (1.0 - x * x);
+
+    vec4 albedo = texelFetch(gAlbedo, pixel, 0);
+    vec4 normal = texelFetch(gNormal, pixel, 0);
+    vec3 N = normalize(normal.xyz);
+    vec3 L = toLight / d;
+    float diff = max(dot(N, L), 0.0);
+    vec3 result = albedo.rgb * diff;
+
+    if (albedo.a > 0.0)
+    {
+        vec3 V = normalize(viewPos - P);
+        vec3 R = reflect(-L, N);
+        result += albedo.a * pow(max(dot(V, R), 0.0), normal.w);
+    }
+
+    FragColor = vec4(result * LightColor * att, 1.0);
+}
@@ -0,0 +1,21 @@
+#version 400 core
+#include "vertex_decode.glsl"
+// Volume de luz do caminho deferred: uma esfera por luz pontual (instanciada)
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in vec4 iPositionRadius; // xyz: posicao, w: raio
+layout (location = 4) in vec4 iColor;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform float volumeScale; // a esfera poligonal fica dentro da esfera real: aumenta um pouco
+
+flat out vec4 LightPositionRadius;
+flat out vec3 LightColor;
+
+void main()
+{
+    vec3 worldPos = decodePosition(aPos) * iPositionRadius.w * volumeScale + iPositionRadius.xyz;
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+    LightPositionRadius = iPositionRadius;
+    LightColor = iColor.rgb;
+}
@@ -0,0 +1,5 @@
+#version 400 core
+// Passadas so de profundidade (shadow map e pre-pass): so o depth buffer e escrito
+void main()
+{
+}
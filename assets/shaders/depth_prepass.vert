@@ -0,0 +1,19 @@
+#version 400 core
+#include "vertex_decode.glsl"
+// Pre-pass de profundidade (ver src/DepthPrepass.h): so a posicao e a matriz de
+// modelo por instancia. gl_Position e calculado com a mesma expressao do uber.vert,
+// e os dois o declaram invariant, para que a passada de shading com GL_EQUAL
+// encontre exatamente a mesma profundidade.
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 iModel; // ocupa as locations 3-6
+
+uniform mat4 projection;
+uniform mat4 view;
+
+invariant gl_Position;
+
+void main()
+{
+    vec4 worldPos = iModel * vec4(decodePosition(aPos), 1.0);
+    gl_Position = projection * view * worldPos;
+}
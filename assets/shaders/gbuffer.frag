@@ -0,0 +1,42 @@
+#version 400 core
+// Passada de geometria do caminho deferred (ver src/DeferredRenderer.h); usado com
+// uber.vert e as mesmas variantes do uber-shader:
+//   HAS_TEXTURE   cor base = objectColor * textura
+//   HAS_SPECULAR  grava ks e shininess (sem ele a superficie nao tem brilho)
+// A nevoa (HAS_FOG) nao e aplicada neste caminho.
+in vec3 FragPos;
+in vec3 Normal;
+#ifdef HAS_TEXTURE
+in vec2 TexCoord;
+uniform sampler2D texture1;
+#endif
+
+layout (location = 0) out vec4 gAlbedo; // rgb: cor base * kd, a: ks
+layout (location = 1) out vec4 gNormal; // xyz: normal (mundo), w: shininess
+layout (location = 2) out vec4 gLight;  // acumulacao: comeca com o termo ambiente
+
+uniform vec3 objectColor;
+uniform vec3 ambientColor;
+uniform float ka;
+uniform float kd;
+#ifdef HAS_SPECULAR
+uniform float ks;
+uniform float shininess;
+#endif
+
+void main()
+{
+    vec3 base = objectColor;
+#ifdef HAS_TEXTURE
+    base *= texture(texture1, TexCoord).rgb;
+#endif
+
+#ifdef HAS_SPECULAR
+    gAlbedo = vec4(base * kd, ks);
+    gNormal = vec4(normalize(Normal), shininess);
+#else
+    gAlbedo = vec4(base * kd, 0.0);
+    gNormal = vec4(normalize(Normal), 1.0);
+#endif
+    gLight = vec4(ka * ambientColor * base, 1.0);
+}
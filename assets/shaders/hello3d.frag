@@ -0,0 +1,7 @@
+#version 450
+in vec4 finalColor;
+out vec4 color;
+void main()
+{
+color = finalColor;
+}
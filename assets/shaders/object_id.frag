@@ -0,0 +1,10 @@
+#version 400 core
+// Grava o indice do objeto + 1 (0 fica para o fundo) no alvo R32UI
+flat in uint ObjectId;
+
+layout (location = 0) out uint FragId;
+
+void main()
+{
+    FragId = ObjectId;
+}
@@ -0,0 +1,19 @@
+#version 400 core
+#include "vertex_decode.glsl"
+// Buffer de ids para a selecao pela GPU (ver src/ObjectIdBuffer.h): posicao, matriz
+// de modelo e o indice do objeto + 1, guardado no w da primeira coluna da matriz
+// normal (location 7, lida com 4 componentes)
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 iModel;  // ocupa as locations 3-6
+layout (location = 7) in vec4 iNormal0;
+
+uniform mat4 projection;
+uniform mat4 view;
+
+flat out uint ObjectId;
+
+void main()
+{
+    gl_Position = projection * view * iModel * vec4(decodePosition(aPos), 1.0);
+    ObjectId = uint(iNormal0.w);
+}
@@ -0,0 +1,22 @@
+#version 400 core
+#include "vertex_decode.glsl"
+// Passada de profundidade do shadow map (ver src/ShadowMap.h)
+//   INSTANCED  matriz de modelo por instancia (locations 3-6) em vez do uniform
+layout (location = 0) in vec3 aPos;
+#ifdef INSTANCED
+layout (location = 3) in mat4 iModel;
+#else
+uniform mat4 model;
+#endif
+
+uniform mat4 lightSpace; // projection * view da luz
+
+void main()
+{
+#ifdef INSTANCED
+    mat4 modelMatrix = iModel;
+#else
+    mat4 modelMatrix = model;
+#endif
+    gl_Position = lightSpace * modelMatrix * vec4(decodePosition(aPos), 1.0);
+}
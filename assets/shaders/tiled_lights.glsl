@@ -0,0 +1,24 @@
+// Lista de luzes por tile de tela (ver src/TiledLighting.h; as constantes devem
+// ser as mesmas de la). Usado por light_culling.comp e pelo uber.frag (TILED_LIGHTS).
+#define TILE_SIZE 16
+#define MAX_LIGHTS_PER_TILE 255
+#define TILE_STRIDE 256
+
+struct Light
+{
+    vec4 positionRadius; // xyz: posicao (mundo), w: raio
+    vec4 color;
+};
+
+layout (std430, binding = 0) buffer LightBuffer
+{
+    Light lights[];
+};
+
+// Tile t ocupa [t * TILE_STRIDE, (t + 1) * TILE_STRIDE): quantidade e indices das luzes
+layout (std430, binding = 1) buffer TileBuffer
+{
+    uint tileLights[];
+};
+
+uniform ivec2 tileCount;
@@ -0,0 +1,116 @@
+#version 400 core
+// Uber-shader de Phong: variantes por #define (ver src/Material.h)
+//   HAS_TEXTURE    cor base = objectColor * textura
+//   HAS_SPECULAR   termo especular
+//   HAS_FOG        nevoa linear pela distancia a camera
+//   TILED_LIGHTS   todas as luzes pontuais do tile do fragmento (src/TiledLighting.h)
+//                  em vez da luz unica lightPos
+//   HAS_SHADOWS    sombra da luz lightPos (shadow map com PCF 3x3, src/ShadowMap.h);
+//                  nao se aplica as luzes do TILED_LIGHTS
+#ifdef TILED_LIGHTS
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_ARB_shading_language_420pack : require
+#endif
+in vec3 FragPos;
+in vec3 Normal;
+#ifdef HAS_TEXTURE
+in vec2 TexCoord;
+uniform sampler2D texture1;
+#endif
+
+out vec4 FragColor;
+
+#ifdef TILED_LIGHTS
+#include "tiled_lights.glsl"
+uniform vec3 ambientColor;
+#else
+uniform vec3 lightPos;
+uniform vec3 lightColor;
+#endif
+uniform vec3 viewPos;
+uniform vec3 objectColor;
+uniform float ka;
+uniform float kd;
+#ifdef HAS_SPECULAR
+uniform float ks;
+uniform float shininess;
+#endif
+#ifdef HAS_FOG
+uniform vec3 fogColor;
+uniform float fogStart;
+uniform float fogEnd;
+#endif
+#ifdef HAS_SHADOWS
+in vec4 LightSpacePos;
+uniform sampler2DShadow shadowMap;
+uniform float shadowBias;
+
+// Fracao iluminada: 9 amostras com comparacao de profundidade (cada uma ja e
+// filtrada bilinearmente pelo hardware)
+float shadowFactor()
+{
+    vec3 p = LightSpacePos.xyz / LightSpacePos.w * 0.5 + 0.5;
+    if (p.z > 1.0)
+        return 1.0;
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0));
+    float lit = 0.0;
+    for (int y = -1; y <= 1; ++y)
+    {
+        for (int x = -1; x <= 1; ++x)
+            lit += texture(shadowMap, vec3(p.xy + vec2(x, y) * texel, p.z - shadowBias));
+    }
+    return lit / 9.0;
+}
+#endif
+
+// Difuso + especular de uma luz de cor 'color' vinda da direcao L
+vec3 lightContribution(vec3 N, vec3 L, vec3 base, vec3 color)
+{
+    float diff = max(dot(N, L), 0.0);
+    vec3 result = kd * diff * color * base;
+#ifdef HAS_SPECULAR
+    vec3 V = normalize(viewPos - FragPos);
+    vec3 R = reflect(-L, N);
+    result += ks * pow(max(dot(V, R), 0.0), shininess) * color;
+#endif
+    return result;
+}
+
+void main()
+{
+    vec3 base = objectColor;
+#ifdef HAS_TEXTURE
+    base *= texture(texture1, TexCoord).rgb;
+#endif
+
+    vec3 N = normalize(Normal);
+#ifdef TILED_LIGHTS
+    vec3 result = ka * ambientColor * base;
+    ivec2 tile = ivec2(gl_FragCoord.xy) / TILE_SIZE;
+    uint first = uint(tile.y * tileCount.x + tile.x) * uint(TILE_STRIDE);
+    uint count = tileLights[first];
+    for (uint i = 0u; i < count; ++i)
+    {
+        Light light = lights[tileLights[first + 1u + i]];
+        vec3 toLight = light.positionRadius.xyz - FragPos;
+        float d = length(toLight);
+        float x = min(d / light.positionRadius.w, 1.0);
+        float att = (1.0 - x * x) * (1.0 - x * x);
+        result += lightContribution(N, toLight / max(d, 1e-4), base, light.color.rgb) * att;
+    }
+#else
+    vec3 L = normalize(lightPos - FragPos);
+#ifdef HAS_SHADOWS
+    vec3 result = ka * lightColor * base + shadowFactor() * lightContribution(N, L, base, lightColor);
+#else
+    vec3 result = ka * lightColor * base + lightContribution(N, L, base, lightColor);
+#endif
+#endif
+
+#ifdef HAS_FOG
+    float fog = clamp((length(viewPos - FragPos) - fogStart) / (fogEnd - fogStart), 0.0, 1.0);
+    result = mix(result, fogColor, fog);
+#endif
+
+    FragColor = vec4(result, 1.0);
+}
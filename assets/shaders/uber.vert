@@ -0,0 +1,60 @@
+#version 400 core
+#include "vertex_decode.glsl"
+// Uber-shader de Phong: variantes por #define (ver src/Material.h)
+//   INSTANCED      matriz de modelo por instancia (locations 3-9)
+//   NORMAL_MATRIX  normal pela inversa transposta (escala nao uniforme)
+//   HAS_TEXTURE    repassa a coordenada de textura
+//   HAS_SHADOWS    posicao no espaco da luz, para o shadow map
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec3 aNormal;
+#ifdef INSTANCED
+layout (location = 3) in mat4 iModel;  // ocupa as locations 3-6
+layout (location = 7) in mat3 iNormal; // ocupa as locations 7-9
+#else
+uniform mat4 model;
+uniform mat3 normalMatrix;
+#endif
+
+uniform mat4 projection;
+uniform mat4 view;
+
+// Mesma profundidade do depth_prepass.vert (passada de shading com GL_EQUAL)
+invariant gl_Position;
+
+out vec3 FragPos;
+out vec3 Normal;
+#ifdef HAS_TEXTURE
+out vec2 TexCoord;
+#endif
+#ifdef HAS_SHADOWS
+uniform mat4 lightSpace;
+out vec4 LightSpacePos;
+#endif
+
+void main()
+{
+#ifdef INSTANCED
+    mat4 modelMatrix = iModel;
+#else
+    mat4 modelMatrix = model;
+#endif
+    vec4 worldPos = modelMatrix * vec4(decodePosition(aPos), 1.0);
+    gl_Position = projection * view * worldPos;
+    FragPos = vec3(worldPos);
+
+#if defined(NORMAL_MATRIX) && defined(INSTANCED)
+    Normal = iNormal * decodeNormal(aNormal);
+#elif defined(NORMAL_MATRIX)
+    Normal = normalMatrix * decodeNormal(aNormal);
+#else
+    Normal = mat3(modelMatrix) * decodeNormal(aNormal); // rotacao + escala uniforme
+#endif
+
+#ifdef HAS_TEXTURE
+    TexCoord = aTexCoord;
+#endif
+#ifdef HAS_SHADOWS
+    LightSpacePos = lightSpace * worldPos;
+#endif
+}
@@ -0,0 +1,22 @@
+// Decodificacao dos formatos de vertice compactos (ver src/VertexFormat.h).
+// Incluir logo apos #version; as entradas sao usadas como decodePosition(aPos)
+// e decodeNormal(aNormal). Para malhas em float: positionScale = 1,
+// positionOffset = 0 e normalEncoding = 0 (setVertexDecodeUniforms em src/Mesh.h).
+uniform vec3 positionScale;  // meia extensao da AABB
+uniform vec3 positionOffset; // centro da AABB
+uniform int normalEncoding;  // 1: octaedrica
+
+vec3 decodePosition(vec3 p)
+{
+    return p * positionScale + positionOffset;
+}
+
+vec3 decodeNormal(vec3 n)
+{
+    if (normalEncoding != 1)
+        return n;
+    vec3 v = vec3(n.xy, 1.0 - abs(n.x) - abs(n.y));
+    if (v.z < 0.0)
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(v);
+}
@@ -0,0 +1,1100 @@
+/*
+ * Benchmarks - medições de desempenho dos subsistemas usados nos exercícios
+ *
+ * Uso: Benchmarks <modo> [parâmetros]
+ *
+ * Modos:
+ *   drawlist [objetos]   montagem da lista de desenho (culling + empacotamento)
+ *                        com 1, 2, 4, ... threads (padrão: 100000 objetos)
+ *   stream [matrizes]    envio de matrizes por frame: ring buffer persistente vs.
+ *                        glBufferData e orphaning + glBufferSubData (padrão: 100000)
+ *   simplify [pasta]     simplificação QEM dos modelos Suzanne: velocidade
+ *                        (triângulos/s) e qualidade (distância de Hausdorff)
+ *                        (padrão: ../assets/Modelos3D/)
+ *   vertexformat [seg]   formatos de vértice (VertexFormat.h): memória, erro de
+ *                        quantização e vazão de busca de vértices numa esfera
+ *                        com seg x seg segmentos (padrão: 1024)
+ *   shaders              programas dos exercícios: compilação a partir das fontes
+ *                        vs. carga do binário em cache (ARB_get_program_binary)
+ *   lights [luzes...]    muitas luzes pontuais em 1280x720 (padrão: 1 16 256 1024):
+ *                        tempo de GPU do deferred (geometria + iluminação), do
+ *                        tiled forward (distribuição por tile + shading) e do
+ *                        forward com uma passada por luz (até 64 luzes)
+ *   shadows [objetos]    shadow map (ShadowMap.h) de uma grade de esferas com 10%
+ *                        delas em movimento: redesenho completo a cada frame vs.
+ *                        camada estática em cache (padrão: 2000)
+ *   scene [objetos]      leitura de uma cena JSON gerada com esse número de cubos:
+ *                        SAX direto para os arrays (SceneLoader.h) vs. DOM do
+ *                        json.hpp, em objetos/s e pico de memória (padrão: 200000)
+ *   snapshot [objetos] [cena.json]
+ *                        a cena (padrão ../assets/cube.json) replicada até esse
+ *                        número de cubos (padrão: 1000000): leitura do JSON vs.
+ *                        .scene mapeado (SceneSnapshot.h)
+ *   picking [objetos]    seleção por raio: grade com hash (SpatialHash.h) vs.
+ *                        varredura linear, em consultas/s, e custo de atualizar a
+ *                        grade com 10% dos objetos em movimento (padrão: 100000)
+ *
+ * Os modos que usam OpenGL criam uma janela invisível; em máquinas sem GPU rodam
+ * sobre o llvmpipe (Mesa), que é justamente o caso que queremos medir.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "JobSystem.h"
+#include "DrawList.h"
+#include "GLExtensions.h"
+#include "StreamBuffer.h"
+#include "MeshIO.h"
+#include "MeshSimplify.h"
+#include "Mesh.h"
+#include "ShaderManager.h"
+#include "Material.h"
+#include "Lights.h"
+#include "DeferredRenderer.h"
+#include "TiledLighting.h"
+#include "ShadowMap.h"
+#include "SceneSnapshot.h"
+#include "SpatialHash.h"
+
+using namespace std;
+using namespace glm;
+
+typedef chrono::high_resolution_clock Clock;
+
+// Bytes alocados com new no momento e o máximo desde resetHeapPeak (modo scene).
+// Cada bloco guarda o próprio tamanho num cabeçalho que mantém o alinhamento.
+static atomic<size_t> heapBytes{0}, heapPeak{0};
+static const size_t HEAP_HEADER = alignof(max_align_t);
+
+void *operator new(size_t size)
+{
+	void *block = malloc(size + HEAP_HEADER);
+	if (!block)
+		throw bad_alloc();
+	*(size_t *)block = size;
+	size_t current = heapBytes += size;
+	size_t peak = heapPeak.load();
+	while (current > peak && !heapPeak.compare_exchange_weak(peak, current))
+		;
+	return (char *)block + HEAP_HEADER;
+}
+
+void operator delete(void *p) noexcept
+{
+	if (!p)
+		return;
+	char *block = (char *)p - HEAP_HEADER;
+	heapBytes -= *(size_t *)block;
+	free(block);
+}
+
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+static void resetHeapPeak() { heapPeak = heapBytes.load(); }
+
+static double elapsedMs(Clock::time_point start)
+{
+	return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// Cria uma janela invisível com contexto OpenGL para os modos que precisam de GPU
+static GLFWwindow *createHiddenContext(int width = 64, int height = 64)
+{
+	if (!glfwInit())
+	{
+		cout << "Failed to initialize GLFW\n";
+		return nullptr;
+	}
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	GLFWwindow *window = glfwCreateWindow(width, height, "Benchmarks", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Failed to create GLFW window\n";
+		glfwTerminate();
+		return nullptr;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD\n";
+		glfwTerminate();
+		return nullptr;
+	}
+	glext::load();
+	cout << "Renderer: " << glGetString(GL_RENDERER) << ", OpenGL " << glGetString(GL_VERSION) << endl;
+	return window;
+}
+
+static GLuint compileProgram(const char *vsSource, const char *fsSource)
+{
+	GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vs, 1, &vsSource, nullptr);
+	glCompileShader(vs);
+	GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(fs, 1, &fsSource, nullptr);
+	glCompileShader(fs);
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, vs);
+	glAttachShader(program, fs);
+	glLinkProgram(program);
+
+	GLint success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		GLchar infoLog[512];
+		glGetProgramInfoLog(program, 512, NULL, infoLog);
+		cout << "Error linking shader program:\n"
+			 << infoLog << endl;
+	}
+	glDeleteShader(vs);
+	glDeleteShader(fs);
+	return program;
+}
+
+// --- drawlist ---------------------------------------------------------------
+
+struct BenchObject
+{
+	vec3 position;
+	vec3 rotation;
+	vec3 scale;
+	uint32_t batch;
+};
+
+static int benchDrawList(size_t count)
+{
+	const uint32_t numBatches = 3;
+	const int iterations = 20;
+
+	vector<BenchObject> objects(count);
+	size_t side = (size_t)ceil(cbrt((double)count));
+	for (size_t i = 0; i < count; ++i)
+	{
+		objects[i].position = vec3((float)(i % side), (float)((i / side) % side), -(float)(i / (side * side))) * 2.0f - vec3((float)side, (float)side, 5.0f);
+		objects[i].rotation = vec3((float)(i % 360), (float)((i * 7) % 360), 0.0f);
+		objects[i].scale = vec3(1.0f);
+		objects[i].batch = (uint32_t)(i % numBatches);
+	}
+
+	mat4 projection = perspective(radians(45.0f), 800.0f / 600.0f, 0.1f, 1000.0f);
+	mat4 view = lookAt(vec3(0.0f, 0.0f, 3.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f));
+	Frustum frustum = Frustum::fromMatrix(projection * view);
+
+	cout << "drawlist: " << count << " objetos, " << iterations << " iterações por configuração" << endl;
+
+	double baseline = 0.0;
+	unsigned maxThreads = max(1u, thread::hardware_concurrency());
+	for (unsigned threads = 1;; threads = min(threads * 2, maxThreads))
+	{
+		JobSystem jobs(threads);
+		DrawList drawList;
+		vector<InstanceData> staging;
+
+		double total = 0.0;
+		size_t visible = 0;
+		for (int it = 0; it < iterations + 1; ++it)
+		{
+			Clock::time_point start = Clock::now();
+			drawList.build(jobs, objects.size(), numBatches, [&](size_t i, InstanceData &out, uint32_t &batch)
+						   {
+				const BenchObject &o = objects[i];
+				if (!frustum.intersectsSphere(o.position, 0.87f))
+					return false;
+				packInstance(composeModel(o.position, o.rotation, o.scale), out);
+				batch = o.batch;
+				return true; });
+			staging.resize(drawList.totalCount());
+			drawList.gather(jobs, staging.data());
+			if (it > 0) // a primeira iteração só aquece os buffers
+				total += elapsedMs(start);
+			visible = drawList.totalCount();
+		}
+
+		double avg = total / iterations;
+		if (threads == 1)
+			baseline = avg;
+		cout << "  threads " << setw(2) << threads << ": " << fixed << setprecision(3) << avg << " ms/frame"
+			 << "  (speedup " << setprecision(2) << baseline / avg << "x, visíveis " << visible << ")" << endl;
+
+		if (threads == maxThreads)
+			break;
+	}
+	return 0;
+}
+
+// --- stream -----------------------------------------------------------------
+
+// Cada frame escreve 'count' matrizes no buffer e desenha um ponto por matriz,
+// forçando a GPU a ler os dados (senão o driver poderia nunca sincronizar)
+static int benchStream(size_t count)
+{
+	const int frames = 300;
+
+	GLFWwindow *window = createHiddenContext();
+	if (!window)
+		return 1;
+
+	const char *vs = R"(
+#version 400 core
+layout (location = 0) in mat4 iModel;
+void main()
+{
+    gl_Position = iModel * vec4(0.0, 0.0, 0.0, 1.0);
+}
+)";
+	const char *fs = R"(
+#version 400 core
+out vec4 FragColor;
+void main()
+{
+    FragColor = vec4(1.0);
+}
+)";
+	GLuint program = compileProgram(vs, fs);
+	glUseProgram(program);
+
+	GLuint vao;
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+
+	size_t bytes = count * sizeof(mat4);
+	cout << "stream: " << count << " matrizes (" << bytes / (1024.0 * 1024.0) << " MB) por frame, " << frames << " frames" << endl;
+
+	StreamBuffer::Mode modes[] = {StreamBuffer::BUFFER_DATA, StreamBuffer::ORPHAN_SUBDATA, StreamBuffer::PERSISTENT_RING};
+	for (StreamBuffer::Mode mode : modes)
+	{
+		StreamBuffer stream;
+		if (!stream.create(GL_ARRAY_BUFFER, bytes, mode) || stream.activeMode() != mode)
+		{
+			cout << "  " << setw(26) << left << StreamBuffer::modeName(mode) << right << ": indisponível" << endl;
+			continue;
+		}
+
+		glFinish();
+		Clock::time_point start = Clock::now();
+		for (int f = 0; f < frames; ++f)
+		{
+			size_t offset;
+			mat4 *dst = (mat4 *)stream.map(bytes, offset, sizeof(mat4));
+			for (size_t i = 0; i < count; ++i)
+				dst[i] = translate(mat4(1.0f), vec3((float)(i % 64) / 32.0f - 1.0f, (float)(f % 64) / 32.0f - 1.0f, 0.0f));
+			stream.unmap();
+
+			glBindBuffer(GL_ARRAY_BUFFER, stream.id());
+			for (GLuint c = 0; c < 4; ++c)
+			{
+				glEnableVertexAttribArray(c);
+				glVertexAttribDivisor(c, 0);
+				glVertexAttribPointer(c, 4, GL_FLOAT, GL_FALSE, sizeof(mat4), (void *)(offset + c * sizeof(vec4)));
+			}
+			glClear(GL_COLOR_BUFFER_BIT);
+			glDrawArrays(GL_POINTS, 0, (GLsizei)count);
+			stream.endFrame();
+			glfwSwapBuffers(window);
+		}
+		glFinish();
+		double ms = elapsedMs(start) / frames;
+
+		cout << "  " << setw(26) << left << StreamBuffer::modeName(mode) << right << ": " << fixed << setprecision(3) << ms << " ms/frame, "
+			 << setprecision(2) << (bytes / (1024.0 * 1024.0 * 1024.0)) / (ms / 1000.0) << " GB/s";
+		if (mode == StreamBuffer::PERSISTENT_RING)
+			cout << ", esperas por fence: " << stream.stalls();
+		cout << endl;
+	}
+
+	glDeleteVertexArrays(1, &vao);
+	glDeleteProgram(program);
+	glfwTerminate();
+	return 0;
+}
+
+// --- simplify ---------------------------------------------------------------
+
+static int benchSimplify(const string &folder)
+{
+	const char *models[] = {"Suzanne.obj", "SuzanneSubdiv1.obj"};
+	const float ratios[] = {0.5f, 0.25f, 0.1f};
+	const int repetitions = 5;
+
+	for (const char *model : models)
+	{
+		MeshData input;
+		if (!loadMeshFile(folder + model, input))
+			return 1;
+
+		float diagonal = 0.0f;
+		{
+			vec3 lo(1e30f), hi(-1e30f);
+			for (const vec3 &p : input.positions)
+			{
+				lo = min(lo, p);
+				hi = max(hi, p);
+			}
+			diagonal = length(hi - lo);
+		}
+
+		for (float ratio : ratios)
+		{
+			size_t target = (size_t)(input.triangleCount() * ratio);
+			MeshData output;
+			float estimate = 0.0f;
+
+			Clock::time_point start = Clock::now();
+			for (int r = 0; r < repetitions; ++r)
+				output = simplifyMesh(input, target, &estimate);
+			double ms = elapsedMs(start) / repetitions;
+
+			float hausdorff = hausdorffDistance(input, output);
+			cout << "  " << setw(20) << left << model << right << " " << setw(5) << input.triangleCount() << " -> " << setw(5) << output.triangleCount()
+				 << ": " << fixed << setprecision(3) << setw(7) << ms << " ms, " << setprecision(2) << input.triangleCount() / (ms / 1000.0) / 1e6 << " M tri/s"
+				 << ", Hausdorff " << setprecision(5) << hausdorff << " (" << setprecision(3) << 100.0f * hausdorff / diagonal << "% da diagonal)"
+				 << ", estimativa QEM " << setprecision(5) << estimate << endl;
+		}
+	}
+	return 0;
+}
+
+// --- vertexformat -----------------------------------------------------------
+
+static int benchVertexFormat(int segments)
+{
+	const int draws = 50;
+
+	MeshData sphere = buildSphere(1.0f, segments, segments);
+	cout << "Esfera " << segments << "x" << segments << ": " << sphere.vertexCount() << " vértices, " << sphere.triangleCount() << " triângulos" << endl;
+
+	GLFWwindow *window = createHiddenContext();
+	if (!window)
+		return 1;
+
+	ShaderManager shaders;
+	shaders.setBinaryCache(false);
+	GLuint program = shaders.load("bench_vertexfetch.vert", "bench_white.frag");
+	if (!program)
+		return 1;
+	glUseProgram(program);
+
+	GLuint query;
+	glGenQueries(1, &query);
+
+	const VertexFormat formats[] = {VertexFormat::full(), VertexFormat::compact(), VertexFormat::compact(NORMAL_INT_2_10_10_10)};
+	size_t fullBytes = 0;
+	for (const VertexFormat &format : formats)
+	{
+		// Erro de quantização em relação aos atributos originais
+		PackedVertices packed = packVertices(sphere, format);
+		float positionError = 0.0f, normalError = 0.0f, texCoordError = 0.0f;
+		for (size_t i = 0; i < sphere.vertexCount(); ++i)
+		{
+			vec3 p, n;
+			vec2 t;
+			unpackVertex(packed, i, p, t, n);
+			positionError = std::max(positionError, length(p - sphere.positions[i]));
+			normalError = std::max(normalError, degrees(acos(std::min(dot(n, sphere.normals[i]), 1.0f))));
+			texCoordError = std::max(texCoordError, std::max(std::abs(t.s - sphere.texCoords[i].s), std::abs(t.t - sphere.texCoords[i].t)));
+		}
+
+		Mesh mesh = uploadMesh(sphere, format);
+		if (fullBytes == 0)
+			fullBytes = mesh.byteSize();
+		glBindVertexArray(mesh.VAO);
+		setVertexDecodeUniforms(program, mesh);
+
+		glDrawArrays(GL_POINTS, 0, mesh.vertexCount); // aquecimento
+		glFinish();
+
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		Clock::time_point start = Clock::now();
+		for (int d = 0; d < draws; ++d)
+			glDrawArrays(GL_POINTS, 0, mesh.vertexCount);
+		glEndQuery(GL_TIME_ELAPSED);
+		glFinish();
+		double cpuMs = elapsedMs(start);
+		GLuint64 gpuNs = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &gpuNs);
+		double ms = gpuNs > 0 ? gpuNs / 1e6 : cpuMs;
+
+		double vertices = (double)mesh.vertexCount * draws;
+		cout << "  " << setw(36) << left << format.name() << right << " " << setw(2) << format.stride() << " B/vértice, "
+			 << fixed << setprecision(2) << setw(7) << mesh.byteSize() / (1024.0 * 1024.0) << " MB (" << setprecision(0) << 100.0 * mesh.byteSize() / fullBytes << "%), "
+			 << setprecision(1) << vertices / (ms / 1000.0) / 1e6 << " M vértices/s, " << setprecision(2) << vertices * format.stride() / (ms / 1000.0) / 1e9 << " GB/s"
+			 << " | erro: posição " << scientific << setprecision(1) << positionError << ", normal " << fixed << setprecision(3) << normalError << "°, uv " << scientific << setprecision(1) << texCoordError
+			 << defaultfloat << endl;
+
+		deleteMesh(mesh);
+	}
+
+	glDeleteQueries(1, &query);
+	shaders.release();
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
+
+// --- shaders ----------------------------------------------------------------
+
+static int benchShaders()
+{
+	// Variantes do uber-shader usadas pelos exercícios (TriangleTex e SpherePhong) e a mais completa
+	struct BenchProgram
+	{
+		const char *vert, *frag;
+		uint32_t features;
+	};
+	const BenchProgram programs[] = {
+		{"hello3d.vert", "hello3d.frag", 0},
+		{"uber.vert", "uber.frag", FEATURE_INSTANCING | FEATURE_TEXTURE | FEATURE_SPECULAR},
+		{"uber.vert", "uber.frag", FEATURE_SPECULAR},
+		{"uber.vert", "uber.frag", FEATURE_SPECULAR | FEATURE_TEXTURE},
+		{"uber.vert", "uber.frag", FEATURE_TEXTURE | FEATURE_SPECULAR | FEATURE_NORMAL_MATRIX | FEATURE_INSTANCING | FEATURE_FOG},
+		{"bench_vertexfetch.vert", "bench_white.frag", 0}};
+	const string cacheDir = "shader_cache_bench/";
+
+	GLFWwindow *window = createHiddenContext();
+	if (!window)
+		return 1;
+	if (!glext::hasProgramBinary)
+		cout << "Aviso: driver sem ARB_get_program_binary, o cache em disco fica desativado" << endl;
+
+	std::error_code error;
+	filesystem::remove_all(cacheDir, error);
+
+	// 1) cache vazio: compila e grava os binários; 2) nova instância: carrega do disco.
+	// O driver pode ter seu próprio cache de shaders, o que também acelera a primeira passada.
+	const char *passNames[] = {"compilação (cache vazio)", "binário em cache"};
+	ShaderManager::Stats results[2];
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		ShaderManager shaders("../assets/shaders/", cacheDir);
+		for (const BenchProgram &program : programs)
+		{
+			if (!shaders.load(program.vert, program.frag, featureDefines(program.features)))
+				return 1;
+		}
+		results[pass] = shaders.stats();
+		shaders.release();
+	}
+
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		const ShaderManager::Stats &r = results[pass];
+		double ms = r.compileMs + r.cacheMs;
+		cout << "  " << setw(26) << left << passNames[pass] << right << ": " << fixed << setprecision(2) << setw(8) << ms << " ms ("
+			 << r.compiled << " compilados, " << r.cacheHits << " do cache)" << defaultfloat << endl;
+	}
+	if (results[1].cacheMs > 0.0)
+		cout << "  aceleração: " << fixed << setprecision(1) << results[0].compileMs / results[1].cacheMs << "x" << defaultfloat << endl;
+
+	filesystem::remove_all(cacheDir, error);
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
+
+// --- lights -----------------------------------------------------------------
+
+// Grade de esferas que cobre a tela, desenhadas uma a uma com o uber-shader
+struct BenchScene
+{
+	Mesh sphere;
+	vector<mat4> models;
+	mat4 projection, view;
+
+	void draw(GLuint program) const
+	{
+		glBindVertexArray(sphere.VAO);
+		setVertexDecodeUniforms(program, sphere);
+		GLint modelLocation = glGetUniformLocation(program, "model");
+		for (const mat4 &model : models)
+		{
+			glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &model[0][0]);
+			glDrawElements(GL_TRIANGLES, sphere.indexCount, GL_UNSIGNED_INT, 0);
+		}
+	}
+};
+
+static void setBenchUniforms(GLuint program, const BenchScene &scene, const Material &material)
+{
+	glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, &scene.projection[0][0]);
+	glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, &scene.view[0][0]);
+	glUniform3f(glGetUniformLocation(program, "viewPos"), 0.0f, 0.0f, 0.0f);
+	glUniform3f(glGetUniformLocation(program, "ambientColor"), 1.0f, 1.0f, 1.0f);
+	ShaderPermutations::applyMaterial(program, material);
+}
+
+// Tempo de GPU de 'frames' repetições de 'pass' (tempo de CPU com glFinish se o
+// driver não tiver GL_TIME_ELAPSED)
+template <typename Pass>
+static double gpuMs(GLuint query, int frames, Pass pass)
+{
+	pass(); // aquecimento
+	glFinish();
+	glBeginQuery(GL_TIME_ELAPSED, query);
+	Clock::time_point start = Clock::now();
+	for (int f = 0; f < frames; ++f)
+		pass();
+	glEndQuery(GL_TIME_ELAPSED);
+	glFinish();
+	double cpuMs = elapsedMs(start);
+	GLuint64 gpuNs = 0;
+	glGetQueryObjectui64v(query, GL_QUERY_RESULT, &gpuNs);
+	return (gpuNs > 0 ? gpuNs / 1e6 : cpuMs) / frames;
+}
+
+static int benchLights(const vector<size_t> &lightCounts)
+{
+	const int width = 1280, height = 720;
+	const int frames = 10;
+	const size_t maxForwardLights = 64;
+
+	GLFWwindow *window = createHiddenContext();
+	if (!window)
+		return 1;
+
+	BenchScene scene;
+	scene.sphere = uploadMesh(buildSphere(0.45f, 24, 24));
+	for (int y = -6; y <= 6; ++y)
+	{
+		for (int x = -12; x <= 12; ++x)
+			scene.models.push_back(translate(mat4(1.0f), vec3((float)x, (float)y, -10.0f)));
+	}
+	scene.projection = perspective(radians(45.0f), (float)width / height, 0.1f, 100.0f);
+	scene.view = mat4(1.0f);
+
+	Material material;
+	material.ambient = 0.05f;
+	uint32_t features = material.features(false);
+
+	ShaderManager shaders;
+	shaders.setBinaryCache(false);
+	DeferredRenderer deferred(shaders);
+	if (!deferred.create(width, height))
+		return 1;
+	GLuint geometryProgram = deferred.geometryPermutations().get(features);
+	GLuint forwardProgram = ShaderPermutations(shaders).get(features);
+	if (!geometryProgram || !forwardProgram)
+		return 1;
+
+	TiledLighting tiled;
+	GLuint tiledProgram = 0;
+	if (tiled.create(shaders, width, height))
+		tiledProgram = ShaderPermutations(shaders).get(features | FEATURE_TILED_LIGHTS);
+
+	// Alvo do forward: cor em ponto flutuante + profundidade, do mesmo tamanho do G-buffer
+	GLuint forwardFBO, forwardColor, forwardDepth;
+	glGenFramebuffers(1, &forwardFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, forwardFBO);
+	glGenRenderbuffers(1, &forwardColor);
+	glBindRenderbuffer(GL_RENDERBUFFER, forwardColor);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA16F, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, forwardColor);
+	glGenRenderbuffers(1, &forwardDepth);
+	glBindRenderbuffer(GL_RENDERBUFFER, forwardDepth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, forwardDepth);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	GLuint query;
+	glGenQueries(1, &query);
+
+	cout << "lights: " << scene.models.size() << " esferas (" << scene.models.size() * scene.sphere.indexCount / 3 << " triângulos), "
+		 << width << "x" << height << ", G-buffer " << deferred.byteSize() / (1024.0 * 1024.0) << " MB" << endl;
+
+	glUseProgram(geometryProgram);
+	setBenchUniforms(geometryProgram, scene, material);
+	double geometryMs = gpuMs(query, frames, [&]()
+							  {
+		deferred.beginGeometryPass(vec3(0.0f));
+		glUseProgram(geometryProgram);
+		scene.draw(geometryProgram); });
+	cout << "  passada de geometria: " << fixed << setprecision(2) << geometryMs << " ms (independe do número de luzes)" << defaultfloat << endl;
+
+	for (size_t count : lightCounts)
+	{
+		// Luzes na frente da grade, com raio fixo: o custo cresce com a área coberta
+		vector<PointLight> lights = generateLights(count, vec3(-12.0f, -6.0f, -11.0f), vec3(12.0f, 6.0f, -8.0f), 2.5f);
+
+		double lightingMs = gpuMs(query, frames, [&]()
+								  { deferred.lightingPass(lights, scene.projection, scene.view, vec3(0.0f)); });
+
+		cout << "  " << setw(5) << count << " luzes: deferred " << fixed << setprecision(2) << setw(7) << geometryMs + lightingMs << " ms (iluminação "
+			 << setw(7) << lightingMs << " ms, " << setprecision(2) << setw(6) << 1000.0 * lightingMs / count << " us/luz)";
+
+		if (tiledProgram)
+		{
+			double cullMs = gpuMs(query, frames, [&]()
+								  { tiled.cull(lights, scene.projection, scene.view); });
+			glUseProgram(tiledProgram);
+			setBenchUniforms(tiledProgram, scene, material);
+			tiled.setUniforms(tiledProgram);
+			double shadingMs = gpuMs(query, frames, [&]()
+									 {
+				glBindFramebuffer(GL_FRAMEBUFFER, forwardFBO);
+				glViewport(0, 0, width, height);
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				glEnable(GL_DEPTH_TEST);
+				scene.draw(tiledProgram); });
+			cout << ", tiled " << setw(7) << cullMs + shadingMs << " ms (distribuição " << setw(6) << cullMs << " ms, "
+				 << tiled.overflowTiles() << " tiles com luzes descartadas)";
+		}
+
+		if (count <= maxForwardLights)
+		{
+			// Forward: a cena inteira uma vez por luz, somando as contribuições
+			glUseProgram(forwardProgram);
+			setBenchUniforms(forwardProgram, scene, material);
+			double forwardMs = gpuMs(query, std::max(1, frames / 5), [&]()
+									 {
+				glBindFramebuffer(GL_FRAMEBUFFER, forwardFBO);
+				glViewport(0, 0, width, height);
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				glEnable(GL_DEPTH_TEST);
+				glDepthFunc(GL_LEQUAL);
+				for (size_t l = 0; l < lights.size(); ++l)
+				{
+					glUniform3fv(glGetUniformLocation(forwardProgram, "lightPos"), 1, &lights[l].position[0]);
+					glUniform3fv(glGetUniformLocation(forwardProgram, "lightColor"), 1, &lights[l].color[0]);
+					glUniform1f(glGetUniformLocation(forwardProgram, "ka"), l == 0 ? material.ambient : 0.0f);
+					if (l == 1)
+					{
+						glEnable(GL_BLEND);
+						glBlendFunc(GL_ONE, GL_ONE);
+						glDepthMask(GL_FALSE);
+					}
+					scene.draw(forwardProgram);
+				}
+				glDisable(GL_BLEND);
+				glDepthMask(GL_TRUE);
+				glDepthFunc(GL_LESS); });
+			cout << ", forward " << setw(8) << forwardMs << " ms";
+		}
+		cout << defaultfloat << endl;
+	}
+
+	glDeleteQueries(1, &query);
+	tiled.release();
+	glDeleteFramebuffers(1, &forwardFBO);
+	glDeleteRenderbuffers(1, &forwardColor);
+	glDeleteRenderbuffers(1, &forwardDepth);
+	deleteMesh(scene.sphere);
+	deferred.release();
+	shaders.release();
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
+
+// --- shadows ----------------------------------------------------------------
+
+static int benchShadows(size_t count)
+{
+	const int width = 1280, height = 720;
+	const int frames = 20;
+
+	GLFWwindow *window = createHiddenContext();
+	if (!window)
+		return 1;
+
+	// Grade quadrada no plano y = 0; uma esfera em cada dez se move
+	BenchScene staticScene, dynamicScene;
+	staticScene.sphere = uploadMesh(buildSphere(0.4f, 16, 16));
+	dynamicScene.sphere = staticScene.sphere;
+	int side = std::max(1, (int)std::ceil(std::sqrt((double)count)));
+	for (size_t i = 0; i < count; ++i)
+	{
+		vec3 position((float)(i % side) - side * 0.5f, 0.0f, (float)(i / side) - side * 0.5f);
+		(i % 10 == 0 ? dynamicScene : staticScene).models.push_back(translate(mat4(1.0f), position));
+	}
+	staticScene.projection = dynamicScene.projection = perspective(radians(45.0f), (float)width / height, 0.1f, 4.0f * side);
+	staticScene.view = dynamicScene.view = lookAt(vec3(0.0f, side * 0.6f, side * 0.8f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+
+	ShaderManager shaders;
+	shaders.setBinaryCache(false);
+	ShadowMap shadowMap;
+	if (!shadowMap.create(shaders, 2048, false))
+		return 1;
+	shadowMap.setLight(vec3(side * 0.3f, side * 1.5f, side * 0.2f), vec3(0.0f), side * 0.75f);
+
+	Material material;
+	GLuint program = ShaderPermutations(shaders).get(material.features(false) | FEATURE_SHADOWS);
+	if (!program)
+		return 1;
+
+	GLuint query;
+	glGenQueries(1, &query);
+
+	cout << "shadows: " << count << " esferas (" << dynamicScene.models.size() << " em movimento), "
+		 << count * staticScene.sphere.indexCount / 3 << " triângulos, shadow map 2048x2048" << endl;
+
+	float time = 0.0f;
+	auto update = [&](bool hasDynamic)
+	{
+		// As esferas dinâmicas sobem e descem; as estáticas não mudam
+		time += 0.016f;
+		for (size_t i = 0; i < dynamicScene.models.size(); ++i)
+			dynamicScene.models[i][3][1] = std::sin(time + (float)i);
+		shadowMap.update([&](GLuint p)
+						 { staticScene.draw(p); },
+						 [&](GLuint p)
+						 { dynamicScene.draw(p); },
+						 hasDynamic);
+	};
+
+	shadowMap.setCaching(false);
+	double alwaysMs = gpuMs(query, frames, [&]()
+							{ update(true); });
+	shadowMap.setCaching(true);
+	shadowMap.invalidate();
+	double cachedMs = gpuMs(query, frames, [&]()
+							{ update(true); });
+	double idleMs = gpuMs(query, frames, [&]()
+						  { update(false); });
+
+	// Custo da amostragem com PCF na passada principal (fixo, com ou sem cache)
+	glUseProgram(program);
+	setBenchUniforms(program, staticScene, material);
+	glUniform3f(glGetUniformLocation(program, "lightPos"), side * 0.3f, side * 1.5f, side * 0.2f);
+	glUniform3f(glGetUniformLocation(program, "lightColor"), 1.0f, 1.0f, 1.0f);
+	shadowMap.setUniforms(program);
+	double shadingMs = gpuMs(query, frames, [&]()
+							 {
+		glViewport(0, 0, width, height);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glEnable(GL_DEPTH_TEST);
+		staticScene.draw(program);
+		dynamicScene.draw(program); });
+
+	cout << fixed << setprecision(2)
+		 << "  redesenho completo:        " << setw(7) << alwaysMs << " ms/frame\n"
+		 << "  cache + objetos dinâmicos: " << setw(7) << cachedMs << " ms/frame (" << alwaysMs / cachedMs << "x)\n"
+		 << "  cache, nada se move:       " << setw(7) << idleMs << " ms/frame (" << alwaysMs / idleMs << "x)\n"
+		 << "  passada principal com PCF: " << setw(7) << shadingMs << " ms/frame" << defaultfloat << endl;
+
+	glDeleteQueries(1, &query);
+	shadowMap.release();
+	deleteMesh(staticScene.sphere);
+	shaders.release();
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
+
+// --- scene ------------------------------------------------------------------
+
+// Cena no formato do TriangleTex: texturas repetidas, e parte dos cubos com escala,
+// material e trajetória (os campos opcionais que o leitor precisa tratar)
+static void writeBenchScene(const string &path, size_t count)
+{
+	ofstream out(path);
+	const char *textures[] = {"../assets/tex/areia.jpg", "../assets/tex/madeira.jpg", "../assets/tex/pixelWall.png"};
+	out << "{\n  \"ambient\": [0.2, 0.2, 0.2],\n  \"lights\": [{\"position\": [3.0, 3.0, 3.0], \"intensity\": 1.0}],\n  \"cubes\": [\n";
+	size_t side = (size_t)ceil(cbrt((double)count));
+	for (size_t i = 0; i < count; ++i)
+	{
+		vec3 p = vec3((float)(i % side), (float)((i / side) % side), -(float)(i / (side * side))) * 2.0f;
+		out << "    {\"id\": " << i + 1 << ", \"texture\": \"" << textures[i % 3] << "\", \"initial_position\": ["
+			<< p.x << ", " << p.y << ", " << p.z << "]";
+		if (i % 4 == 0)
+			out << ", \"scale\": [1.0, 0.5, 1.0]";
+		if (i % 3 == 0)
+			out << ", \"material\": {\"color\": [1.0, 0.5, 0.25], \"specular\": 0.3, \"shininess\": 16.0}";
+		out << ", \"trajectory\": [";
+		if (i % 10 == 0)
+			out << "[" << p.x << ", " << p.y + 1.0f << ", " << p.z << "], [" << p.x + 1.0f << ", " << p.y << ", " << p.z << "]";
+		out << "]}" << (i + 1 < count ? ",\n" : "\n");
+	}
+	out << "  ]\n}\n";
+}
+
+static int benchScene(size_t count)
+{
+	const int iterations = 3;
+	string path = (filesystem::temp_directory_path() / "bench_scene.json").string();
+	writeBenchScene(path, count);
+	double fileMB = filesystem::file_size(path) / (1024.0 * 1024.0);
+	cout << "scene: " << count << " cubos, " << fixed << setprecision(1) << fileMB << " MB de JSON (" << path << "), melhor de "
+		 << iterations << defaultfloat << endl;
+
+	struct Loader
+	{
+		const char *name;
+		bool (*load)(const string &, SceneDescription &);
+	};
+	const Loader loaders[] = {{"DOM (file >> json)", loadSceneJSONDOM}, {"SAX (SceneLoader)  ", loadSceneJSON}};
+
+	double baseline = 0.0;
+	size_t loaded[2] = {0, 0};
+	for (int l = 0; l < 2; ++l)
+	{
+		double best = 1e30;
+		size_t peak = 0;
+		for (int it = 0; it < iterations; ++it)
+		{
+			SceneDescription scene;
+			resetHeapPeak();
+			size_t before = heapBytes;
+			Clock::time_point start = Clock::now();
+			if (!loaders[l].load(path, scene))
+				return 1;
+			best = min(best, elapsedMs(start));
+			peak = heapPeak - before;
+			loaded[l] = scene.size();
+		}
+		if (l == 0)
+			baseline = best;
+		cout << "  " << loaders[l].name << ": " << fixed << setprecision(1) << setw(8) << best << " ms, "
+			 << setw(6) << count / best / 1000.0 << " Mobjetos/s, pico " << setw(7) << peak / (1024.0 * 1024.0) << " MB ("
+			 << setprecision(0) << (double)peak / count << " bytes/cubo)" << setprecision(2) << " " << baseline / best << "x" << defaultfloat << endl;
+	}
+
+	filesystem::remove(path);
+	if (loaded[0] != loaded[1] || loaded[0] != count)
+	{
+		cout << "Contagens diferentes: DOM " << loaded[0] << ", SAX " << loaded[1] << endl;
+		return 1;
+	}
+	return 0;
+}
+
+// --- snapshot ---------------------------------------------------------------
+
+static int benchSnapshot(size_t count, const string &sourcePath)
+{
+	const int iterations = 3;
+	SceneDescription source;
+	if (!loadSceneJSON(sourcePath, source))
+		return 1;
+	replicateScene(source, count);
+
+	filesystem::path folder = filesystem::temp_directory_path();
+	string jsonPath = (folder / "bench_snapshot.json").string();
+	string binaryPath = (folder / "bench_snapshot.scene").string();
+	if (!saveSceneJSON(jsonPath, source) || !writeSceneBinary(binaryPath, source))
+		return 1;
+	cout << "snapshot: " << source.size() << " cubos a partir de " << sourcePath << ", melhor de " << iterations
+		 << " (arquivos recém-gravados, no cache do sistema)" << endl;
+	cout << fixed << setprecision(1) << "  JSON " << filesystem::file_size(jsonPath) / (1024.0 * 1024.0) << " MB, .scene "
+		 << filesystem::file_size(binaryPath) / (1024.0 * 1024.0) << " MB" << defaultfloat << endl;
+
+	auto measure = [&](const char *name, auto &&load)
+	{
+		double best = 1e30;
+		for (int it = 0; it < iterations; ++it)
+		{
+			Clock::time_point start = Clock::now();
+			size_t loaded = load();
+			best = min(best, elapsedMs(start));
+			if (loaded != source.size())
+				cout << "  " << name << ": " << loaded << " cubos lidos" << endl;
+		}
+		cout << "  " << name << ": " << fixed << setprecision(2) << setw(9) << best << " ms, "
+			 << setw(8) << source.size() / best / 1000.0 << " Mobjetos/s" << defaultfloat << endl;
+		return best;
+	};
+
+	double jsonMs = measure("JSON (SAX)                  ", [&]()
+							{
+		SceneDescription scene;
+		loadSceneJSON(jsonPath, scene);
+		return scene.size(); });
+	double copyMs = measure(".scene -> SceneDescription  ", [&]()
+							{
+		SceneDescription scene;
+		readSceneBinary(binaryPath, scene);
+		return scene.size(); });
+	// Só o mapeamento, mais uma passada pelas posições (as páginas são lidas no uso)
+	double mapMs = measure(".scene mapeado + leitura    ", [&]()
+						   {
+		SceneSnapshot snapshot;
+		if (!snapshot.open(binaryPath))
+			return (size_t)0;
+		vec3 sum(0.0f);
+		for (size_t i = 0; i < snapshot.size(); ++i)
+			sum += snapshot.positions[i];
+		return sum.x == 1e30f ? 0 : snapshot.size(); });
+
+	cout << fixed << setprecision(1) << "  .scene: " << jsonMs / copyMs << "x mais rápido com cópia, " << jsonMs / mapMs << "x mapeado" << defaultfloat << endl;
+	filesystem::remove(jsonPath);
+	filesystem::remove(binaryPath);
+	return 0;
+}
+
+// --- picking ----------------------------------------------------------------
+
+static int benchPicking(size_t count)
+{
+	const size_t queries = 20000;
+	const float radius = 0.87f; // cubo unitário
+
+	// A grade do drawlist, com raios da câmera do TriangleTex para pontos aleatórios
+	// dentro da caixa dos objetos
+	vector<vec3> centers(count);
+	size_t side = (size_t)ceil(cbrt((double)count));
+	vec3 minCorner(1e30f), maxCorner(-1e30f);
+	for (size_t i = 0; i < count; ++i)
+	{
+		centers[i] = vec3((float)(i % side), (float)((i / side) % side), -(float)(i / (side * side))) * 2.0f - vec3((float)side, (float)side, 5.0f);
+		minCorner = glm::min(minCorner, centers[i]);
+		maxCorner = glm::max(maxCorner, centers[i]);
+	}
+	uint32_t state = 1;
+	auto next = [&state]()
+	{
+		state = state * 1664525u + 1013904223u;
+		return (state >> 8) / 16777216.0f;
+	};
+	vec3 origin(0.0f, 0.0f, 3.0f);
+	vector<vec3> dirs(queries);
+	for (vec3 &d : dirs)
+		d = (minCorner + (maxCorner - minCorner) * vec3(next(), next(), next()) - origin) * 2.0f;
+
+	auto hitSphere = [&](uint32_t i, const vec3 &o, const vec3 &d, float &t)
+	{
+		vec3 oc = o - centers[i];
+		float a = dot(d, d), b = dot(oc, d), c = dot(oc, oc) - radius * radius;
+		float discriminant = b * b - a * c;
+		if (discriminant < 0.0f)
+			return false;
+		float root = sqrt(discriminant);
+		if ((-b + root) / a < 0.0f)
+			return false;
+		t = std::max((-b - root) / a, 0.0f);
+		return true;
+	};
+
+	Clock::time_point start = Clock::now();
+	SpatialHash grid(2.0f * radius);
+	for (size_t i = 0; i < count; ++i)
+		grid.insert((uint32_t)i, centers[i], radius);
+	double buildMs = elapsedMs(start);
+	cout << "picking: " << count << " objetos, " << queries << " raios; grade com " << grid.cellCount() << " células montada em "
+		 << fixed << setprecision(1) << buildMs << " ms" << defaultfloat << endl;
+
+	// A varredura linear é lenta: mede uma parte das consultas
+	size_t linearQueries = std::max<size_t>(100, std::min(queries, (size_t)2e9 / std::max<size_t>(count, 1) / 1000));
+	vector<int> linearHits(linearQueries);
+	start = Clock::now();
+	for (size_t q = 0; q < linearQueries; ++q)
+	{
+		int best = -1;
+		float bestT = 1.0f, t;
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (hitSphere((uint32_t)i, origin, dirs[q], t) && t < bestT)
+			{
+				bestT = t;
+				best = (int)i;
+			}
+		}
+		linearHits[q] = best;
+	}
+	double linearUs = elapsedMs(start) * 1000.0 / linearQueries;
+
+	size_t hits = 0, mismatches = 0;
+	start = Clock::now();
+	for (size_t q = 0; q < queries; ++q)
+	{
+		float t;
+		int hit = grid.raycast(origin, dirs[q], 1.0f, t, hitSphere);
+		hits += hit >= 0;
+		if (q < linearQueries && hit != linearHits[q])
+			mismatches++;
+	}
+	double gridUs = elapsedMs(start) * 1000.0 / queries;
+
+	// Um frame com 10% dos objetos andando um pouco (a maioria fica nas mesmas células)
+	const int frames = 10;
+	start = Clock::now();
+	for (int f = 0; f < frames; ++f)
+	{
+		for (size_t i = f % 10; i < count; i += 10)
+		{
+			centers[i] += vec3(0.05f, 0.0f, 0.0f);
+			grid.update((uint32_t)i, centers[i], radius);
+		}
+	}
+	double updateMs = elapsedMs(start) / frames;
+
+	cout << fixed << setprecision(2)
+		 << "  varredura linear: " << setw(10) << linearUs << " us/consulta (" << linearQueries << " consultas)\n"
+		 << "  grade com hash:   " << setw(10) << gridUs << " us/consulta, " << setprecision(0) << 1e6 / gridUs << " consultas/s ("
+		 << setprecision(1) << linearUs / gridUs << "x), " << hits << " acertos\n"
+		 << "  atualização:      " << setw(10) << setprecision(2) << updateMs << " ms/frame com " << count / 10 << " objetos em movimento"
+		 << defaultfloat << endl;
+	if (mismatches > 0)
+	{
+		cout << "  " << mismatches << " consultas com resultado diferente da varredura linear" << endl;
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	string mode = argc > 1 ? argv[1] : "";
+
+	if (mode == "drawlist")
+		return benchDrawList(argc > 2 ? stoul(argv[2]) : 100000);
+	if (mode == "stream")
+		return benchStream(argc > 2 ? stoul(argv[2]) : 100000);
+	if (mode == "simplify")
+		return benchSimplify(argc > 2 ? argv[2] : "../assets/Modelos3D/");
+	if (mode == "vertexformat")
+		return benchVertexFormat(argc > 2 ? stoi(argv[2]) : 1024);
+	if (mode == "shaders")
+		return benchShaders();
+	if (mode == "lights")
+	{
+		vector<size_t> lightCounts;
+		for (int i = 2; i < argc; ++i)
+			lightCounts.push_back(stoul(argv[i]));
+		if (lightCounts.empty())
+			lightCounts = {1, 16, 256, 1024};
+		return benchLights(lightCounts);
+	}
+	if (mode == "shadows")
+		return benchShadows(argc > 2 ? stoul(argv[2]) : 2000);
+	if (mode == "scene")
+		return benchScene(argc > 2 ? stoul(argv[2]) : 200000);
+	if (mode == "snapshot")
+		return benchSnapshot(argc > 2 ? stoul(argv[2]) : 1000000, argc > 3 ? argv[3] : "../assets/cube.json");
+	if (mode == "picking")
+		return benchPicking(argc > 2 ? stoul(argv[2]) : 100000);
+
+	cout << "Uso: Benchmarks <modo> [parâmetros]\n"
+		 << "  drawlist [objetos]\n"
+		 << "  stream [matrizes]\n"
+		 << "  simplify [pasta]\n"
+		 << "  vertexformat [segmentos]\n"
+		 << "  shaders\n"
+		 << "  lights [luzes...]\n"
+		 << "  shadows [objetos]\n"
+		 << "  scene [objetos]\n"
+		 << "  snapshot [objetos] [cena.json]\n"
+		 << "  picking [objetos]\n";
+	return 1;
+}
@@ -0,0 +1,142 @@
+/*
+ * Camera.h - câmera FPS (yaw/pitch em graus) com base e matrizes em cache
+ *
+ * A base (front, right, up) só é recalculada quando a orientação muda, e as
+ * matrizes (view, projection * view) e os planos do frustum só quando são pedidos
+ * depois de uma mudança de posição, orientação ou projeção (flags de sujeira).
+ * Uma câmera parada não custa nada por frame, e mover uma não recalcula nenhum
+ * seno: várias câmeras (tela dividida, vista da luz para sombras) saem baratas.
+ *
+ * Uso:
+ *   Camera camera(vec3(0, 0, 3));
+ *   camera.setPerspective(radians(45.0f), 800.0f / 600.0f, 0.1f, 1000.0f);
+ *   camera.rotate(dx, dy); camera.moveForward(d);
+ *   camera.getViewMatrix(); camera.getViewProjection(); camera.getFrustum();
+ *   Camera light = Camera::lookingAt(lightPos, center); // vista de outro ponto
+ */
+
+#pragma once
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "DrawList.h"
+
+class Camera
+{
+public:
+	Camera(glm::vec3 pos = glm::vec3(0.0f, 0.0f, 3.0f), float y = -90.0f, float p = 0.0f)
+		: position(pos)
+	{
+		setOrientation(y, p);
+	}
+
+	// Câmera em 'eye' olhando para 'target' (pitch limitado a +-89 graus)
+	static Camera lookingAt(const glm::vec3 &eye, const glm::vec3 &target)
+	{
+		glm::vec3 d = glm::normalize(target - eye);
+		return Camera(eye, glm::degrees(std::atan2(d.z, d.x)), glm::degrees(std::asin(glm::clamp(d.y, -1.0f, 1.0f))));
+	}
+
+	void setPerspective(float fovy, float aspect, float zNear, float zFar)
+	{
+		projection = glm::perspective(fovy, aspect, zNear, zFar);
+		viewProjectionDirty = true;
+	}
+
+	void setOrthographic(float left, float right, float bottom, float top, float zNear, float zFar)
+	{
+		projection = glm::ortho(left, right, bottom, top, zNear, zFar);
+		viewProjectionDirty = true;
+	}
+
+	void setPosition(const glm::vec3 &pos)
+	{
+		if (pos == position)
+			return;
+		position = pos;
+		viewDirty = true;
+	}
+
+	void setOrientation(float y, float p)
+	{
+		p = glm::clamp(p, -89.0f, 89.0f);
+		if (y == yaw && p == pitch && !basisDirty)
+			return;
+		yaw = y;
+		pitch = p;
+		basisDirty = false;
+
+		front.x = std::cos(glm::radians(yaw)) * std::cos(glm::radians(pitch));
+		front.y = std::sin(glm::radians(pitch));
+		front.z = std::sin(glm::radians(yaw)) * std::cos(glm::radians(pitch));
+		front = glm::normalize(front);
+		right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+		up = glm::cross(right, front);
+		viewDirty = true;
+	}
+
+	void rotate(float deltaYaw, float deltaPitch) { setOrientation(yaw + deltaYaw, pitch + deltaPitch); }
+	void moveForward(float delta) { setPosition(position + delta * front); }
+	void moveRight(float delta) { setPosition(position + delta * right); }
+	void moveUp(float delta) { setPosition(position + glm::vec3(0.0f, delta, 0.0f)); }
+
+	const glm::vec3 &getPosition() const { return position; }
+	float getYaw() const { return yaw; }
+	float getPitch() const { return pitch; }
+	const glm::vec3 &getFront() const { return front; }
+	const glm::vec3 &getRight() const { return right; }
+	const glm::vec3 &getUp() const { return up; }
+
+	// Mesmo resultado de lookAt(position, position + front, up), montado direto da base
+	const glm::mat4 &getViewMatrix()
+	{
+		if (viewDirty)
+		{
+			view = glm::mat4(1.0f);
+			for (int c = 0; c < 3; ++c)
+			{
+				view[c][0] = right[c];
+				view[c][1] = up[c];
+				view[c][2] = -front[c];
+			}
+			view[3][0] = -glm::dot(right, position);
+			view[3][1] = -glm::dot(up, position);
+			view[3][2] = glm::dot(front, position);
+			viewDirty = false;
+			viewProjectionDirty = true;
+		}
+		return view;
+	}
+
+	const glm::mat4 &getProjectionMatrix() const { return projection; }
+
+	const glm::mat4 &getViewProjection()
+	{
+		getViewMatrix();
+		if (viewProjectionDirty)
+		{
+			viewProjection = projection * view;
+			frustum = Frustum::fromMatrix(viewProjection);
+			viewProjectionDirty = false;
+		}
+		return viewProjection;
+	}
+
+	const Frustum &getFrustum()
+	{
+		getViewProjection();
+		return frustum;
+	}
+
+private:
+	glm::vec3 position;
+	float yaw = 0.0f, pitch = 0.0f;
+	glm::vec3 front, right, up;
+	glm::mat4 view{1.0f}, projection{1.0f}, viewProjection{1.0f};
+	Frustum frustum;
+	bool basisDirty = true; // só até o primeiro setOrientation
+	bool viewDirty = true, viewProjectionDirty = true;
+};
@@ -0,0 +1,265 @@
+/*
+ * DeferredRenderer.h - iluminação deferred para muitas luzes pontuais
+ *
+ * No forward cada fragmento de cada objeto calcula todas as luzes (custo
+ * objetos x luzes). Aqui a cena é desenhada uma vez para o G-buffer e a
+ * iluminação é feita depois, só nos pixels que cada luz alcança:
+ *
+ * 1) Passada de geometria (uber.vert + gbuffer.frag, as mesmas variantes do
+ *    uber-shader dos materiais) grava em três texturas:
+ *      albedo   RGBA8    cor base * kd, ks
+ *      normal   RGBA16F  normal em coordenadas de mundo, shininess
+ *      luz      RGBA16F  acumulação, começa com o termo ambiente (ka * base)
+ *    e a profundidade em uma textura DEPTH24.
+ * 2) Passada de iluminação: uma esfera (volume de luz) por luz, instanciada, com
+ *    blending aditivo sobre a textura de acumulação. O fragment shader reconstrói
+ *    a posição pela profundidade e descarta os pixels fora do raio. Só as faces
+ *    internas são desenhadas, então a câmera pode estar dentro do volume.
+ *    Luzes fora do frustum são descartadas na CPU.
+ * 3) present() copia a acumulação para o framebuffer da janela (glBlitFramebuffer).
+ *
+ * Uso por frame:
+ *   renderer.beginGeometryPass(clearColor);
+ *   ... desenhos com renderer.geometryPermutations() (uniform ambientColor) ...
+ *   renderer.lightingPass(lights, projection, view, eye);
+ *   renderer.present();
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "DrawList.h"
+#include "Lights.h"
+#include "Material.h"
+#include "Mesh.h"
+#include "ShaderManager.h"
+
+class DeferredRenderer
+{
+public:
+	// Segmentos da esfera usada como volume de luz
+	static const int VOLUME_LAT_SEGMENTS = 8;
+	static const int VOLUME_LON_SEGMENTS = 12;
+
+	explicit DeferredRenderer(ShaderManager &shaders)
+		: shaders(shaders), geometry(shaders, "uber.vert", "gbuffer.frag") {}
+
+	~DeferredRenderer() { release(); }
+
+	DeferredRenderer(const DeferredRenderer &) = delete;
+	DeferredRenderer &operator=(const DeferredRenderer &) = delete;
+
+	bool create(int w, int h)
+	{
+		release();
+		width = w;
+		height = h;
+
+		albedoTexture = createTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+		normalTexture = createTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT);
+		lightTexture = createTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT);
+		depthTexture = createTexture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT);
+
+		glGenFramebuffers(1, &gBuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedoTexture, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normalTexture, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, lightTexture, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+		const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
+		glDrawBuffers(3, drawBuffers);
+		bool complete = checkFramebuffer("G-buffer");
+
+		// A passada de iluminação escreve só na acumulação: a profundidade é lida
+		// como textura, e não pode estar ligada ao framebuffer ao mesmo tempo
+		glGenFramebuffers(1, &lightBuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, lightBuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, lightTexture, 0);
+		complete = checkFramebuffer("acumulação de luz") && complete;
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+		// Volume de luz: esfera de raio 1 escalada por luz, com os atributos instanciados
+		// (locations 3 e 4) apontando para o buffer de luzes
+		volume = uploadMesh(buildSphere(1.0f, VOLUME_LAT_SEGMENTS, VOLUME_LON_SEGMENTS));
+		glGenBuffers(1, &lightInstanceBuffer);
+		glBindVertexArray(volume.VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, lightInstanceBuffer);
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(LightData), (void *)offsetof(LightData, positionRadius));
+		glVertexAttribDivisor(3, 1);
+		glEnableVertexAttribArray(4);
+		glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(LightData), (void *)offsetof(LightData, color));
+		glVertexAttribDivisor(4, 1);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		// O polígono fica dentro da esfera real (os centros das faces estão a
+		// cos(meio passo) do centro em cada direção): aumenta o volume para cobrir o raio
+		const float pi = 3.14159265358979323846f;
+		volumeScale = 1.0f / (std::cos(pi / (2 * VOLUME_LAT_SEGMENTS)) * std::cos(pi / VOLUME_LON_SEGMENTS));
+
+		if (!shaders.load("deferred_light.vert", "deferred_light.frag"))
+			complete = false;
+		return complete;
+	}
+
+	void release()
+	{
+		if (gBuffer == 0)
+			return;
+		GLuint textures[] = {albedoTexture, normalTexture, lightTexture, depthTexture};
+		glDeleteTextures(4, textures);
+		glDeleteFramebuffers(1, &gBuffer);
+		glDeleteFramebuffers(1, &lightBuffer);
+		glDeleteBuffers(1, &lightInstanceBuffer);
+		deleteMesh(volume);
+		gBuffer = lightBuffer = lightInstanceBuffer = 0;
+		albedoTexture = normalTexture = lightTexture = depthTexture = 0;
+	}
+
+	// Variantes do uber-shader para a passada de geometria (uber.vert + gbuffer.frag)
+	ShaderPermutations &geometryPermutations() { return geometry; }
+
+	// Liga o G-buffer e limpa: o fundo da acumulação fica com 'clearColor'
+	void beginGeometryPass(const glm::vec3 &clearColor)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+		glViewport(0, 0, width, height);
+		const GLfloat zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+		const GLfloat background[4] = {clearColor.r, clearColor.g, clearColor.b, 1.0f};
+		const GLfloat farDepth = 1.0f;
+		glClearBufferfv(GL_COLOR, 0, zero);
+		glClearBufferfv(GL_COLOR, 1, zero);
+		glClearBufferfv(GL_COLOR, 2, background);
+		glClearBufferfv(GL_DEPTH, 0, &farDepth);
+		glEnable(GL_DEPTH_TEST);
+	}
+
+	// Soma as luzes na acumulação; devolve quantas passaram pelo culling
+	size_t lightingPass(const std::vector<PointLight> &lights, const glm::mat4 &projection, const glm::mat4 &view, const glm::vec3 &eye)
+	{
+		glm::mat4 viewProjection = projection * view;
+		Frustum frustum = Frustum::fromMatrix(viewProjection);
+		visibleLights.clear();
+		for (const PointLight &light : lights)
+		{
+			if (frustum.intersectsSphere(light.position, light.radius))
+				visibleLights.push_back(light);
+		}
+		lastVisibleLights = visibleLights.size();
+
+		glBindFramebuffer(GL_FRAMEBUFFER, lightBuffer);
+		if (visibleLights.empty())
+			return 0;
+
+		packLights(visibleLights, lightData);
+		glBindBuffer(GL_ARRAY_BUFFER, lightInstanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, lightData.size() * sizeof(LightData), lightData.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		GLuint program = shaders.load("deferred_light.vert", "deferred_light.frag");
+		glUseProgram(program);
+		glm::mat4 invViewProjection = glm::inverse(viewProjection);
+		glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+		glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(view));
+		glUniformMatrix4fv(glGetUniformLocation(program, "invViewProjection"), 1, GL_FALSE, glm::value_ptr(invViewProjection));
+		glUniform2f(glGetUniformLocation(program, "screenSize"), (float)width, (float)height);
+		glUniform3fv(glGetUniformLocation(program, "viewPos"), 1, glm::value_ptr(eye));
+		glUniform1f(glGetUniformLocation(program, "volumeScale"), volumeScale);
+		setVertexDecodeUniforms(program, volume);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, albedoTexture);
+		glUniform1i(glGetUniformLocation(program, "gAlbedo"), 0);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, normalTexture);
+		glUniform1i(glGetUniformLocation(program, "gNormal"), 1);
+		glActiveTexture(GL_TEXTURE2);
+		glBindTexture(GL_TEXTURE_2D, depthTexture);
+		glUniform1i(glGetUniformLocation(program, "gDepth"), 2);
+
+		// Só as faces internas de cada esfera: cada pixel é iluminado uma vez por luz,
+		// mesmo com a câmera dentro do volume. buildSphere gera os triângulos em
+		// sentido horário vistos de fora.
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+		glEnable(GL_CULL_FACE);
+		glFrontFace(GL_CW);
+		glCullFace(GL_FRONT);
+
+		glBindVertexArray(volume.VAO);
+		glDrawElementsInstanced(GL_TRIANGLES, volume.indexCount, GL_UNSIGNED_INT, 0, (GLsizei)visibleLights.size());
+		glBindVertexArray(0);
+
+		glFrontFace(GL_CCW);
+		glCullFace(GL_BACK);
+		glDisable(GL_CULL_FACE);
+		glDisable(GL_BLEND);
+		glEnable(GL_DEPTH_TEST);
+		glActiveTexture(GL_TEXTURE0);
+		return visibleLights.size();
+	}
+
+	// Copia a imagem iluminada para o framebuffer da janela
+	void present()
+	{
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, lightBuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	size_t visibleLightCount() const { return lastVisibleLights; }
+
+	// Memória ocupada pelas texturas do G-buffer (4 + 8 + 8 + 4 bytes por pixel)
+	size_t byteSize() const { return (size_t)width * height * 24; }
+
+private:
+	ShaderManager &shaders;
+	ShaderPermutations geometry;
+	int width = 0, height = 0;
+
+	GLuint gBuffer = 0, lightBuffer = 0;
+	GLuint albedoTexture = 0, normalTexture = 0, lightTexture = 0, depthTexture = 0;
+
+	Mesh volume;
+	float volumeScale = 1.0f;
+	GLuint lightInstanceBuffer = 0;
+	std::vector<PointLight> visibleLights;
+	std::vector<LightData> lightData;
+	size_t lastVisibleLights = 0;
+
+	GLuint createTexture(GLenum internalFormat, GLenum format, GLenum type)
+	{
+		GLuint texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, (GLint)internalFormat, width, height, 0, format, type, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return texture;
+	}
+
+	static bool checkFramebuffer(const char *name)
+	{
+		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		if (status != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "Framebuffer incompleto (" << name << "): 0x" << std::hex << status << std::dec << std::endl;
+			return false;
+		}
+		return true;
+	}
+};
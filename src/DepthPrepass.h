@@ -0,0 +1,236 @@
+/*
+ * DepthPrepass.h - pré-passada de profundidade para reduzir o custo de shading
+ *
+ * Com cubos sobrepostos, o fragment shader de Phong roda para fragmentos que
+ * depois são cobertos (overdraw). A pré-passada desenha a cena só com posição
+ * (depth_prepass.vert + depth_only.frag, sem escrever cor), e a passada de shading
+ * seguinte usa glDepthFunc(GL_EQUAL) sem escrever profundidade: cada pixel é
+ * sombreado uma única vez, ao custo de processar os vértices duas vezes.
+ *
+ * Medição (queries, lidas alguns frames depois para não travar a CPU):
+ *   GL_SAMPLES_PASSED na pré-passada   fragmentos que passariam no teste de
+ *                                      profundidade sem ela (na mesma ordem)
+ *   GL_SAMPLES_PASSED no shading       fragmentos sombreados (com a pré-passada:
+ *                                      os visíveis)
+ *   GL_FRAGMENT_SHADER_INVOCATIONS     invocações do fragment shader no shading,
+ *                                      quando há ARB_pipeline_statistics_query
+ * overdraw = pré-passada / visíveis. No modo automático a pré-passada fica ligada
+ * enquanto o overdraw passa do limite; desligada, ela ainda roda em um frame a cada
+ * PROBE_INTERVAL para medir de novo.
+ *
+ * Uso por frame:
+ *   bool prepass = depthPrepass.beginFrame();
+ *   if (prepass) depthPrepass.depthPass(projection, view, draw); // draw(GLuint program)
+ *   depthPrepass.beginShading();
+ *   ... desenhos com os programas normais ...
+ *   depthPrepass.endShading();
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include <glad/glad.h>
+
+#include "GLExtensions.h"
+#include "ShaderManager.h"
+
+class DepthPrepass
+{
+public:
+	enum Mode
+	{
+		PREPASS_OFF,
+		PREPASS_ON,
+		PREPASS_AUTO
+	};
+
+	// Frames entre medições quando a pré-passada está desligada no modo automático
+	static const int PROBE_INTERVAL = 120;
+	// Frames até os resultados das queries serem lidos
+	static const int QUERY_FRAMES = 3;
+
+	struct Stats
+	{
+		uint64_t prepassFragments = 0;	   // passaram na pré-passada (0 se ela não rodou)
+		uint64_t shadedFragments = 0;	   // passaram no teste de profundidade do shading
+		uint64_t fragmentInvocations = 0;  // 0 sem ARB_pipeline_statistics_query
+		float overdraw = 0.0f;			   // última medição (0 antes da primeira)
+	};
+
+	DepthPrepass() {}
+	~DepthPrepass() { release(); }
+
+	DepthPrepass(const DepthPrepass &) = delete;
+	DepthPrepass &operator=(const DepthPrepass &) = delete;
+
+	bool create(ShaderManager &shaderManager, Mode prepassMode, float overdrawThreshold = 1.5f)
+	{
+		release();
+		shaders = &shaderManager;
+		mode = prepassMode;
+		threshold = overdrawThreshold;
+		for (FrameQueries &f : frames)
+		{
+			glGenQueries(3, f.queries);
+			f.pending = false;
+		}
+
+		// Sem o programa a pré-passada fica desligada, mas as contagens continuam
+		bool loaded = mode == PREPASS_OFF || shaders->load("depth_prepass.vert", "depth_only.frag") != 0;
+		if (!loaded)
+			mode = PREPASS_OFF;
+		enabled = mode == PREPASS_ON;
+		pipelineStatistics = glext::hasPipelineStatistics;
+		std::cout << "Pré-passada de profundidade: " << modeName(mode);
+		if (mode == PREPASS_AUTO)
+			std::cout << " (liga com overdraw acima de " << threshold << ")";
+		std::cout << (pipelineStatistics ? ", com" : ", sem") << " contagem de invocações do fragment shader" << std::endl;
+		return loaded;
+	}
+
+	void release()
+	{
+		if (shaders == nullptr)
+			return;
+		for (FrameQueries &f : frames)
+			glDeleteQueries(3, f.queries);
+		shaders = nullptr;
+	}
+
+	// Lê as queries de QUERY_FRAMES frames atrás e decide se este frame tem pré-passada
+	bool beginFrame()
+	{
+		current = &frames[frameIndex % QUERY_FRAMES];
+		if (current->pending)
+			collect(*current);
+
+		bool probe = mode == PREPASS_AUTO && !enabled && frameIndex % PROBE_INTERVAL == 0;
+		current->prepass = enabled || probe;
+		current->pending = true;
+		frameIndex++;
+		return current->prepass;
+	}
+
+	// Só profundidade: draw(program) desenha a cena com o programa da pré-passada em
+	// uso; 'projection' e 'view' devem ser os mesmos da passada de shading
+	template <typename Draw>
+	void depthPass(const float *projection, const float *view, Draw &&draw)
+	{
+		GLuint program = shaders->load("depth_prepass.vert", "depth_only.frag");
+		glUseProgram(program);
+		glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, projection);
+		glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, view);
+
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		glDepthFunc(GL_LESS);
+		glBeginQuery(GL_SAMPLES_PASSED, current->queries[0]);
+		draw(program);
+		glEndQuery(GL_SAMPLES_PASSED);
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	}
+
+	// Com a pré-passada: só os fragmentos com a profundidade exata da superfície visível
+	void beginShading()
+	{
+		if (current->prepass)
+		{
+			glDepthFunc(GL_EQUAL);
+			glDepthMask(GL_FALSE);
+		}
+		glBeginQuery(GL_SAMPLES_PASSED, current->queries[1]);
+		if (pipelineStatistics)
+			glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB, current->queries[2]);
+	}
+
+	void endShading()
+	{
+		glEndQuery(GL_SAMPLES_PASSED);
+		if (pipelineStatistics)
+			glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB);
+		glDepthFunc(GL_LESS);
+		glDepthMask(GL_TRUE);
+	}
+
+	bool isEnabled() const { return enabled; }
+	Mode activeMode() const { return mode; }
+	const Stats &stats() const { return statistics; }
+
+	static const char *modeName(Mode m)
+	{
+		switch (m)
+		{
+		case PREPASS_OFF:
+			return "desligada";
+		case PREPASS_ON:
+			return "ligada";
+		default:
+			return "automática";
+		}
+	}
+
+	static bool parseMode(const std::string &name, Mode &out)
+	{
+		if (name == "off")
+			out = PREPASS_OFF;
+		else if (name == "on")
+			out = PREPASS_ON;
+		else if (name == "auto")
+			out = PREPASS_AUTO;
+		else
+			return false;
+		return true;
+	}
+
+private:
+	struct FrameQueries
+	{
+		GLuint queries[3] = {0, 0, 0}; // pré-passada, shading, invocações
+		bool prepass = false;
+		bool pending = false;
+	};
+
+	ShaderManager *shaders = nullptr;
+	Mode mode = PREPASS_OFF;
+	float threshold = 1.5f;
+	bool enabled = false;
+	bool pipelineStatistics = false;
+	FrameQueries frames[QUERY_FRAMES];
+	FrameQueries *current = &frames[0];
+	uint64_t frameIndex = 0;
+	Stats statistics;
+
+	void collect(FrameQueries &f)
+	{
+		f.pending = false;
+		GLuint available = 0;
+		glGetQueryObjectuiv(f.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			return; // GPU muito atrasada: descarta a medição em vez de esperar
+
+		GLuint64 prepassSamples = 0, shadedSamples = 0, invocations = 0;
+		if (f.prepass)
+			glGetQueryObjectui64v(f.queries[0], GL_QUERY_RESULT, &prepassSamples);
+		glGetQueryObjectui64v(f.queries[1], GL_QUERY_RESULT, &shadedSamples);
+		if (pipelineStatistics)
+			glGetQueryObjectui64v(f.queries[2], GL_QUERY_RESULT, &invocations);
+		statistics.prepassFragments = prepassSamples;
+		statistics.shadedFragments = shadedSamples;
+		statistics.fragmentInvocations = invocations;
+
+		if (!f.prepass || shadedSamples == 0)
+			return;
+		statistics.overdraw = (float)prepassSamples / (float)shadedSamples;
+
+		// Histerese de 10% para não alternar a cada medição perto do limite
+		if (mode == PREPASS_AUTO)
+		{
+			bool wasEnabled = enabled;
+			enabled = enabled ? statistics.overdraw > threshold * 0.9f : statistics.overdraw > threshold;
+			if (enabled != wasEnabled)
+				std::cout << "Pré-passada de profundidade " << (enabled ? "ligada" : "desligada") << " (overdraw " << statistics.overdraw << ")" << std::endl;
+		}
+	}
+};
@@ -0,0 +1,159 @@
+/*
+ * DrawList.h - geração paralela da lista de desenho (draw list)
+ *
+ * O trabalho por objeto (montar a matriz de modelo, culling contra o frustum e
+ * empacotar os dados de instância) roda nas lanes do JobSystem. Cada lane escreve
+ * em buffers lineares próprios, separados por "batch" (ex.: uma textura), e no
+ * final os buffers são concatenados em um único array contíguo ordenado por batch,
+ * pronto para um único upload e uma chamada instanciada por batch.
+ *
+ * Este arquivo não faz chamadas OpenGL: o upload/desenho fica a cargo do programa.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "JobSystem.h"
+
+// Dados por instância enviados ao vertex shader (atributos instanciados)
+// A matriz normal é calculada aqui uma vez por objeto, e não por vértice no shader
+struct InstanceData
+{
+	glm::mat4 model;
+	glm::vec4 normalMatrix[3]; // colunas da mat3, com padding para 16 bytes (o w da
+	                           // primeira fica livre, ex.: id do objeto no ObjectIdBuffer.h)
+};
+
+// Intervalo contíguo de instâncias que compartilham o mesmo estado (textura)
+struct DrawBatch
+{
+	uint32_t first;
+	uint32_t count;
+};
+
+// Planos do frustum extraídos da matriz projection * view (Gribb/Hartmann)
+struct Frustum
+{
+	glm::vec4 planes[6];
+
+	static Frustum fromMatrix(const glm::mat4 &m)
+	{
+		Frustum f;
+		for (int i = 0; i < 3; ++i)
+		{
+			glm::vec4 row(m[0][i], m[1][i], m[2][i], m[3][i]);
+			glm::vec4 w(m[0][3], m[1][3], m[2][3], m[3][3]);
+			f.planes[i * 2 + 0] = w + row;
+			f.planes[i * 2 + 1] = w - row;
+		}
+		for (glm::vec4 &p : f.planes)
+			p /= glm::length(glm::vec3(p));
+		return f;
+	}
+
+	bool intersectsSphere(const glm::vec3 &center, float radius) const
+	{
+		for (const glm::vec4 &p : planes)
+		{
+			if (glm::dot(glm::vec3(p), center) + p.w < -radius)
+				return false;
+		}
+		return true;
+	}
+};
+
+// Matriz de modelo: translação, rotações em X/Y/Z (graus) e escala
+inline glm::mat4 composeModel(const glm::vec3 &position, const glm::vec3 &rotation, const glm::vec3 &scaling)
+{
+	glm::mat4 model = glm::mat4(1.0f);
+	model = glm::translate(model, position);
+	model = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1, 0, 0));
+	model = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0, 1, 0));
+	model = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0, 0, 1));
+	model = glm::scale(model, scaling);
+	return model;
+}
+
+inline void packInstance(const glm::mat4 &model, InstanceData &out)
+{
+	out.model = model;
+	glm::mat3 normal = glm::transpose(glm::inverse(glm::mat3(model)));
+	for (int c = 0; c < 3; ++c)
+		out.normalMatrix[c] = glm::vec4(normal[c], 0.0f);
+}
+
+class DrawList
+{
+public:
+	// Quantidade de objetos por job: grande o bastante para amortizar o custo do
+	// agendamento, pequena o bastante para permitir roubo de trabalho
+	static const size_t GRAIN = 1024;
+
+	// fn(i, InstanceData &out, uint32_t &batch) -> bool: empacota o objeto i e
+	// retorna false se ele foi descartado (culling). Roda nas threads do JobSystem.
+	template <typename Fn>
+	void build(JobSystem &jobs, size_t objectCount, uint32_t batchCount, Fn &&fn)
+	{
+		unsigned numLanes = jobs.laneCount();
+		laneBuffers.resize((size_t)numLanes * batchCount);
+		for (std::vector<InstanceData> &buffer : laneBuffers)
+			buffer.clear(); // mantém a capacidade: sem realocação em regime permanente
+		numBatches = batchCount;
+
+		jobs.parallelFor(objectCount, GRAIN, [&](size_t begin, size_t end, unsigned lane)
+						 {
+			std::vector<InstanceData> *buffers = &laneBuffers[(size_t)lane * numBatches];
+			InstanceData data;
+			uint32_t batch = 0;
+			for (size_t i = begin; i < end; ++i)
+			{
+				if (fn(i, data, batch))
+					buffers[batch].push_back(data);
+			} });
+
+		// Offsets de cada (batch, lane) no array final, agrupado por batch
+		batchList.assign(batchCount, DrawBatch{0, 0});
+		laneOffsets.resize(laneBuffers.size());
+		uint32_t offset = 0;
+		for (uint32_t b = 0; b < batchCount; ++b)
+		{
+			batchList[b].first = offset;
+			for (unsigned lane = 0; lane < numLanes; ++lane)
+			{
+				size_t index = (size_t)lane * batchCount + b;
+				laneOffsets[index] = offset;
+				offset += (uint32_t)laneBuffers[index].size();
+			}
+			batchList[b].count = offset - batchList[b].first;
+		}
+		total = offset;
+	}
+
+	// Copia os buffers de todas as lanes para dst (totalCount() elementos), em paralelo
+	void gather(JobSystem &jobs, InstanceData *dst) const
+	{
+		jobs.parallelFor(laneBuffers.size(), 1, [&](size_t begin, size_t end, unsigned)
+						 {
+			for (size_t i = begin; i < end; ++i)
+			{
+				if (!laneBuffers[i].empty())
+					std::memcpy(dst + laneOffsets[i], laneBuffers[i].data(), laneBuffers[i].size() * sizeof(InstanceData));
+			} });
+	}
+
+	size_t totalCount() const { return total; }
+	const std::vector<DrawBatch> &batches() const { return batchList; }
+
+private:
+	std::vector<std::vector<InstanceData>> laneBuffers; // [lane * numBatches + batch]
+	std::vector<uint32_t> laneOffsets;
+	std::vector<DrawBatch> batchList;
+	uint32_t numBatches = 0;
+	size_t total = 0;
+};
@@ -0,0 +1,141 @@
+/*
+ * FileWatcher.h - avisa quando arquivos de uma pasta são alterados
+ *
+ * No Linux usa inotify (sem custo enquanto nada muda: poll() é uma leitura não
+ * bloqueante). Nos outros sistemas compara a data de modificação dos arquivos,
+ * no máximo a cada 'POLL_INTERVAL_MS'.
+ *
+ * Uso (uma vez por frame):
+ *   FileWatcher watcher;
+ *   watcher.watch("../assets/shaders/");
+ *   for (const std::string &file : watcher.poll()) ...  // nomes relativos à pasta
+ */
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+class FileWatcher
+{
+public:
+	static const int POLL_INTERVAL_MS = 250;
+
+	FileWatcher() {}
+	~FileWatcher() { stop(); }
+
+	FileWatcher(const FileWatcher &) = delete;
+	FileWatcher &operator=(const FileWatcher &) = delete;
+
+	bool watch(const std::string &directory)
+	{
+		stop();
+		dir = directory;
+#ifdef __linux__
+		fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (fd < 0)
+			return false;
+		// Editores costumam salvar em um arquivo temporário e renomear: IN_MOVED_TO.
+		// Sem IN_CREATE: o arquivo recém-criado ainda está vazio ou pela metade, e o
+		// IN_CLOSE_WRITE chega quando a gravação termina.
+		if (inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+		{
+			stop();
+			return false;
+		}
+		return true;
+#else
+		std::error_code error;
+		if (!std::filesystem::is_directory(dir, error))
+			return false;
+		modified = scan();
+		lastPoll = std::chrono::steady_clock::now();
+		return true;
+#endif
+	}
+
+	void stop()
+	{
+#ifdef __linux__
+		if (fd >= 0)
+			close(fd);
+		fd = -1;
+#endif
+		modified.clear();
+	}
+
+	// Arquivos alterados desde a última chamada (sem repetições)
+	std::vector<std::string> poll()
+	{
+		std::vector<std::string> changed;
+#ifdef __linux__
+		if (fd < 0)
+			return changed;
+		alignas(inotify_event) char buffer[4096];
+		ssize_t length;
+		while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+		{
+			for (char *p = buffer; p < buffer + length;)
+			{
+				const inotify_event *event = (const inotify_event *)p;
+				if (event->len > 0)
+					addUnique(changed, event->name);
+				p += sizeof(inotify_event) + event->len;
+			}
+		}
+#else
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (dir.empty() || now - lastPoll < std::chrono::milliseconds(POLL_INTERVAL_MS))
+			return changed;
+		lastPoll = now;
+
+		std::map<std::string, std::filesystem::file_time_type> current = scan();
+		for (const auto &entry : current)
+		{
+			auto it = modified.find(entry.first);
+			if (it == modified.end() || it->second != entry.second)
+				changed.push_back(entry.first);
+		}
+		modified.swap(current);
+#endif
+		return changed;
+	}
+
+private:
+	std::string dir;
+	std::map<std::string, std::filesystem::file_time_type> modified;
+	std::chrono::steady_clock::time_point lastPoll;
+#ifdef __linux__
+	int fd = -1;
+#endif
+
+	static void addUnique(std::vector<std::string> &files, const std::string &file)
+	{
+		for (const std::string &f : files)
+		{
+			if (f == file)
+				return;
+		}
+		files.push_back(file);
+	}
+
+	std::map<std::string, std::filesystem::file_time_type> scan() const
+	{
+		std::map<std::string, std::filesystem::file_time_type> times;
+		std::error_code error;
+		for (const auto &entry : std::filesystem::directory_iterator(dir, error))
+		{
+			if (entry.is_regular_file(error))
+				times[entry.path().filename().string()] = entry.last_write_time(error);
+		}
+		return times;
+	}
+};
@@ -0,0 +1,157 @@
+/*
+ * FixedStep.h - simulação em passo fixo numa thread própria
+ *
+ * FixedStepThread chama step(tick, time) a cada 1/hz segundos de tempo real numa
+ * thread dedicada, independente do frame rate: a simulação avança sempre com o
+ * mesmo dt (resultado determinístico e sem depender de quanto o render demora).
+ * Se a thread atrasar (ex.: sem CPU por um tempo), recupera até MAX_CATCH_UP passos
+ * seguidos e descarta o resto, para não entrar em espiral.
+ *
+ * TripleBuffer<T> entrega o estado publicado pela simulação ao render sem trava:
+ * o escritor preenche o slot de trás e o troca atomicamente com o do meio; o
+ * leitor, quando há um novo, troca o da frente pelo do meio. Nenhum dos dois
+ * espera o outro, e o leitor sempre enxerga o estado completo mais recente (os
+ * intermediários que ele não chegou a ler são pulados).
+ *
+ * Para interpolar, cada estado publicado leva o passo anterior e o atual e o
+ * instante do atual ('time', em FixedStepThread::now()); o render mostra
+ *   mix(anterior, atual, (now() - time) / dt)
+ * isto é, a simulação com um passo de atraso, sem saltos entre os passos.
+ *
+ * Uso:
+ *   TripleBuffer<Snapshot> snapshots;
+ *   sim.start(60.0, [&](uint64_t tick, double time) {
+ *       ... avança um passo de sim.stepSeconds() ...
+ *       Snapshot &s = snapshots.back(); ... preenche ...; snapshots.publish(); });
+ *   // no render:
+ *   snapshots.acquire(); const Snapshot &s = snapshots.front();
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+template <typename T>
+class TripleBuffer
+{
+public:
+	// Escritor: slot livre para montar o próximo estado
+	T &back() { return slots[backIndex]; }
+
+	// Escritor: torna back() o estado mais recente
+	void publish()
+	{
+		backIndex = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	// Leitor: passa para o estado mais recente, se houver um novo (false: nada mudou)
+	bool acquire()
+	{
+		if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+			return false;
+		frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+		return true;
+	}
+
+	// Leitor: último estado adquirido (o padrão de T antes da primeira publicação)
+	const T &front() const { return slots[frontIndex]; }
+
+	// Só com o escritor parado: volta ao estado inicial
+	void reset()
+	{
+		for (T &slot : slots)
+			slot = T();
+		frontIndex = 0;
+		middle.store(1, std::memory_order_relaxed);
+		backIndex = 2;
+	}
+
+private:
+	static const uint32_t INDEX_MASK = 3, FRESH = 4;
+
+	T slots[3];
+	uint32_t frontIndex = 0; // só o leitor
+	std::atomic<uint32_t> middle{1};
+	uint32_t backIndex = 2; // só o escritor
+};
+
+class FixedStepThread
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	// Passos seguidos para recuperar um atraso; o que passar disso é descartado
+	static const int MAX_CATCH_UP = 8;
+
+	FixedStepThread() {}
+	~FixedStepThread() { stop(); }
+
+	FixedStepThread(const FixedStepThread &) = delete;
+	FixedStepThread &operator=(const FixedStepThread &) = delete;
+
+	// Segundos desde uma origem fixa, no mesmo relógio dos instantes passados a step
+	static double now()
+	{
+		return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+	}
+
+	// step(tick, time): um passo de stepSeconds(); 'time' é o instante (now()) que o
+	// estado ao fim do passo representa
+	template <typename Step>
+	void start(double hz, Step step)
+	{
+		stop();
+		dt = 1.0 / hz;
+		running.store(true);
+		worker = std::thread([this, step]() mutable
+							 {
+			const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dt));
+			Clock::time_point next = Clock::now() + period;
+			while (running.load(std::memory_order_relaxed))
+			{
+				std::this_thread::sleep_until(next);
+				int steps = 0;
+				while (Clock::now() >= next && steps < MAX_CATCH_UP)
+				{
+					Clock::time_point begin = Clock::now();
+					step(tickCount.load(std::memory_order_relaxed), std::chrono::duration<double>(next.time_since_epoch()).count());
+					busy.fetch_add((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count(), std::memory_order_relaxed);
+					tickCount.fetch_add(1, std::memory_order_relaxed);
+					next += period;
+					steps++;
+				}
+				if (Clock::now() >= next)
+				{
+					Clock::time_point current = Clock::now();
+					dropped.fetch_add((uint64_t)((current - next) / period) + 1, std::memory_order_relaxed);
+					next = current + period;
+				}
+			} });
+	}
+
+	// Espera o passo em andamento terminar (no máximo um período)
+	void stop()
+	{
+		if (!worker.joinable())
+			return;
+		running.store(false);
+		worker.join();
+	}
+
+	bool isRunning() const { return worker.joinable(); }
+	double stepSeconds() const { return dt; }
+
+	// Estatísticas (podem ser lidas de qualquer thread)
+	uint64_t ticks() const { return tickCount.load(std::memory_order_relaxed); }
+	uint64_t droppedTicks() const { return dropped.load(std::memory_order_relaxed); }
+	double busySeconds() const { return busy.load(std::memory_order_relaxed) * 1e-9; }
+
+private:
+	std::thread worker;
+	std::atomic<bool> running{false};
+	double dt = 1.0 / 60.0;
+	std::atomic<uint64_t> tickCount{0}, dropped{0}, busy{0};
+};
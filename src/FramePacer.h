@@ -0,0 +1,302 @@
+/*
+ * FramePacer.h - modo de apresentação (vsync) e ritmo dos frames
+ *
+ * Modos (--present):
+ *   vsync     glfwSwapInterval(1): um frame por atualização do monitor
+ *   adaptive  glfwSwapInterval(-1): vsync enquanto o frame cabe no intervalo; um
+ *             frame atrasado é apresentado na hora (com tearing) em vez de esperar a
+ *             próxima atualização e cair para metade da taxa. Precisa de
+ *             WGL/GLX_EXT_swap_control_tear; sem a extensão, volta para vsync
+ *   uncapped  glfwSwapInterval(0), sem espera: o máximo de frames possível
+ *   N         glfwSwapInterval(0) com um frame a cada 1/N s, marcado pelo relógio
+ *
+ * O limite de N fps espera no início do frame (antes de ler a entrada, para não
+ * somar a espera à latência): dorme até um pouco antes do prazo e termina em espera
+ * ativa. A margem da espera ativa acompanha o atraso medido do sleep do sistema
+ * (grosseiro no Windows): média mais 4 desvios médios, como a estimativa de RTT do
+ * TCP. A precisão fica abaixo de 0,1 ms sem gastar um núcleo inteiro girando, e um
+ * atraso isolado do sistema não prende a margem no alto.
+ *
+ * Com vsync, o controle de baixa latência (--pacing low-latency) atrasa o início do
+ * frame para que ele termine logo antes da próxima atualização: a entrada é lida o
+ * mais tarde possível. O atraso é o orçamento do frame menos o tempo de trabalho
+ * previsto (média móvel, sem o frame que segue um skipFrame: esse inclui a espera
+ * ociosa nos eventos) e uma folga; a folga cresce a cada frame perdido e encolhe
+ * devagar enquanto os frames cabem, trocando latência por suavidade só quando
+ * precisa. Supõe que glfwSwapBuffers volta na troca; um driver que enfileira
+ * frames reduz o ganho.
+ *
+ * Estatísticas do intervalo entre apresentações nos últimos HISTORY frames: média,
+ * desvio padrão (jitter), p50, p99, máximo e frames que passaram de 1,5 orçamento.
+ * São impressas a cada REPORT_INTERVAL segundos e resumidas em summary().
+ *
+ * Uso:
+ *   FramePacer pacer;
+ *   pacer.setup(FramePacer::PRESENT_VSYNC, 0.0, false);
+ *   while (...) {
+ *       pacer.waitForFrame();
+ *       ... eventos, entrada, desenho (frame não desenhado: pacer.skipFrame()) ...
+ *       pacer.present(window); // no lugar de glfwSwapBuffers
+ *   }
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GLFW/glfw3.h>
+
+class FramePacer
+{
+public:
+	enum Mode
+	{
+		PRESENT_VSYNC,
+		PRESENT_ADAPTIVE,
+		PRESENT_UNCAPPED,
+		PRESENT_CAPPED
+	};
+
+	static const int HISTORY = 240;					// intervalos guardados para as estatísticas
+	static constexpr double REPORT_INTERVAL = 10.0; // segundos
+
+	struct Stats
+	{
+		double budgetMs = 0.0; // 0: sem limite
+		double meanMs = 0.0, jitterMs = 0.0, p50Ms = 0.0, p99Ms = 0.0, maxMs = 0.0;
+		size_t frames = 0;	   // intervalos considerados
+		size_t missed = 0;	   // acima de 1,5 orçamento
+		double delayMs = 0.0; // atraso do início do frame (baixa latência)
+	};
+
+	// "vsync", "adaptive", "uncapped" ou um número de fps (modo com limite)
+	static bool parseMode(const std::string &name, Mode &out, double &capHz)
+	{
+		if (name == "vsync")
+			out = PRESENT_VSYNC;
+		else if (name == "adaptive")
+			out = PRESENT_ADAPTIVE;
+		else if (name == "uncapped")
+			out = PRESENT_UNCAPPED;
+		else
+		{
+			char *end = nullptr;
+			double hz = std::strtod(name.c_str(), &end);
+			if (end == name.c_str() || *end != '\0' || hz <= 0.0)
+				return false;
+			out = PRESENT_CAPPED;
+			capHz = hz;
+		}
+		return true;
+	}
+
+	static const char *modeName(Mode mode)
+	{
+		const char *names[] = {"vsync", "adaptive", "uncapped", "limitado"};
+		return names[mode];
+	}
+
+	// Segundos desde uma origem fixa (relógio monotônico)
+	static double now()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Com o contexto da janela já atual. Retorna false se o modo pedido não é
+	// suportado (adaptive sem a extensão: fica em vsync).
+	bool setup(Mode m, double capHz, bool lowLatencyPacing)
+	{
+		bool supported = true;
+		if (m == PRESENT_ADAPTIVE && !glfwExtensionSupported("WGL_EXT_swap_control_tear") && !glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+		{
+			std::cout << "Vsync adaptativo indisponível (sem EXT_swap_control_tear), usando vsync" << std::endl;
+			m = PRESENT_VSYNC;
+			supported = false;
+		}
+		mode = m;
+		glfwSwapInterval(mode == PRESENT_VSYNC ? 1 : mode == PRESENT_ADAPTIVE ? -1
+																			 : 0);
+
+		const GLFWvidmode *video = glfwGetVideoMode(glfwGetPrimaryMonitor());
+		int refreshRate = video && video->refreshRate > 0 ? video->refreshRate : 60;
+		period = mode == PRESENT_CAPPED ? 1.0 / capHz : mode == PRESENT_UNCAPPED ? 0.0
+																			   : 1.0 / refreshRate;
+		lowLatency = lowLatencyPacing && (mode == PRESENT_VSYNC || mode == PRESENT_ADAPTIVE);
+		intervals.assign(HISTORY, 0.0);
+		intervalCount = 0;
+		nextStart = lastPresent = 0.0;
+		reportStart = now();
+
+		std::cout << "Apresentação: " << modeName(mode);
+		if (period > 0.0)
+			std::cout << ", orçamento de " << period * 1000.0 << " ms (" << 1.0 / period << " Hz)";
+		if (lowLatency)
+			std::cout << ", início do frame atrasado para reduzir a latência";
+		std::cout << std::endl;
+		return supported;
+	}
+
+	Mode getMode() const { return mode; }
+
+	// Início do frame: espera o prazo do limite de fps ou o atraso de baixa latência
+	void waitForFrame()
+	{
+		double current = now();
+		double target = 0.0;
+		if (mode == PRESENT_CAPPED)
+		{
+			// Atrasado mais de um frame (ou voltando de ocioso): não tenta recuperar
+			if (nextStart < current - period)
+				nextStart = current;
+			target = nextStart;
+			nextStart += period;
+		}
+		else if (lowLatency && lastPresent > 0.0)
+		{
+			delay = std::max(period - predictedWork - safety, 0.0);
+			target = lastPresent + delay;
+		}
+		if (target > current)
+			sleepUntil(target);
+		frameStart = now();
+	}
+
+	// Frame não desenhado (render sob demanda): o próximo intervalo e o tempo de
+	// trabalho não são medidos
+	void skipFrame() { lastPresent = 0.0; }
+
+	// Troca os buffers e mede o intervalo desde a apresentação anterior
+	void present(GLFWwindow *window)
+	{
+		double swapStart = now();
+		glfwSwapBuffers(window);
+		double current = now();
+
+		if (lastPresent > 0.0)
+		{
+			// Depois de um skipFrame o frame começou dormindo nos eventos: fica fora
+			double work = swapStart - frameStart;
+			predictedWork = predictedWork == 0.0 ? work : predictedWork + (work - predictedWork) * 0.1;
+			double interval = current - lastPresent;
+			intervals[intervalCount % HISTORY] = interval;
+			intervalCount++;
+			if (lowLatency)
+			{
+				// Frame perdido: mais folga; cabendo, devolve a folga aos poucos
+				if (interval > period * 1.5)
+					safety = std::min(safety + 0.0005, period);
+				else
+					safety = std::max(safety - 0.00001, MIN_SAFETY);
+			}
+		}
+		lastPresent = current;
+		report(current);
+	}
+
+	// Estatísticas dos últimos HISTORY intervalos
+	Stats stats() const
+	{
+		Stats s;
+		s.budgetMs = period * 1000.0;
+		s.delayMs = lowLatency ? delay * 1000.0 : 0.0;
+		s.frames = std::min(intervalCount, (size_t)HISTORY);
+		if (s.frames == 0)
+			return s;
+		std::vector<double> sorted(intervals.begin(), intervals.begin() + s.frames);
+		std::sort(sorted.begin(), sorted.end());
+		double sum = 0.0, sumSquares = 0.0;
+		for (double v : sorted)
+		{
+			sum += v;
+			sumSquares += v * v;
+			if (period > 0.0 && v > period * 1.5)
+				s.missed++;
+		}
+		double mean = sum / s.frames;
+		s.meanMs = mean * 1000.0;
+		s.jitterMs = std::sqrt(std::max(sumSquares / s.frames - mean * mean, 0.0)) * 1000.0;
+		s.p50Ms = sorted[s.frames / 2] * 1000.0;
+		s.p99Ms = sorted[std::min(s.frames - 1, s.frames * 99 / 100)] * 1000.0;
+		s.maxMs = sorted.back() * 1000.0;
+		return s;
+	}
+
+	// Resumo curto para o título da janela
+	std::string summary() const
+	{
+		Stats s = stats();
+		std::string text = std::string(modeName(mode));
+		if (mode == PRESENT_CAPPED)
+			text += " " + std::to_string((int)std::lround(1.0 / period)) + " fps";
+		text += ", jitter " + fixed(s.jitterMs) + " ms, p99 " + fixed(s.p99Ms) + " ms";
+		if (period > 0.0)
+			text += ", " + std::to_string(s.missed) + " perdidos";
+		return text;
+	}
+
+private:
+	static constexpr double MIN_SAFETY = 0.001;	   // folga mínima do controle de latência
+	static constexpr double MIN_SPIN = 0.0002;	   // margem mínima da espera ativa
+	static constexpr double MAX_SPIN = 0.02;	   // margem máxima (sleep de 15,6 ms do Windows)
+
+	Mode mode = PRESENT_VSYNC;
+	double period = 0.0; // orçamento do frame (0: sem limite)
+	bool lowLatency = false;
+
+	double frameStart = 0.0, lastPresent = 0.0, nextStart = 0.0;
+	double predictedWork = 0.0, safety = 0.002, delay = 0.0;
+	double sleepOvershoot = 0.001, sleepDeviation = 0.00025; // estimativa do atraso do sleep
+	double spinMargin = 0.002;
+
+	std::vector<double> intervals;
+	size_t intervalCount = 0;
+	double reportStart = 0.0;
+
+	// Dorme até perto de 'target' e completa em espera ativa
+	void sleepUntil(double target)
+	{
+		double wake = target - spinMargin;
+		double current = now();
+		if (wake > current)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double>(wake - current));
+			double overshoot = now() - wake;
+			sleepDeviation += (std::abs(overshoot - sleepOvershoot) - sleepDeviation) * 0.25;
+			sleepOvershoot += (overshoot - sleepOvershoot) * 0.125;
+			spinMargin = std::clamp(sleepOvershoot + 4.0 * sleepDeviation, MIN_SPIN, MAX_SPIN);
+		}
+		while (now() < target)
+			std::this_thread::yield();
+	}
+
+	void report(double current)
+	{
+		if (current - reportStart < REPORT_INTERVAL)
+			return;
+		reportStart = current;
+		Stats s = stats();
+		std::cout << "Frames (" << modeName(mode) << ", últimos " << s.frames << "): média " << fixed(s.meanMs) << " ms, jitter " << fixed(s.jitterMs)
+				  << " ms, p50 " << fixed(s.p50Ms) << " ms, p99 " << fixed(s.p99Ms) << " ms, máx " << fixed(s.maxMs) << " ms";
+		if (period > 0.0)
+			std::cout << ", " << s.missed << " acima de " << fixed(s.budgetMs * 1.5) << " ms";
+		if (lowLatency)
+			std::cout << ", início atrasado " << fixed(s.delayMs) << " ms";
+		std::cout << std::endl;
+	}
+
+	static std::string fixed(double value)
+	{
+		char text[32];
+		std::snprintf(text, sizeof(text), "%.2f", value);
+		return text;
+	}
+};
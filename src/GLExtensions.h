@@ -0,0 +1,135 @@
+/*
+ * GLExtensions.h - funções OpenGL posteriores à versão 4.0
+ *
+ * O glad do repositório (include/glad) foi gerado para GL 4.0 sem extensões.
+ * As funções mais novas usadas pelos exercícios são carregadas aqui em tempo de
+ * execução, e cada recurso tem uma flag indicando se o driver o suporta, para que
+ * o código possa escolher um caminho alternativo quando ele não existir.
+ *
+ * Uso (depois de gladLoadGLLoader):
+ *   glext::load();
+ *   if (glext::hasBufferStorage) glext::glBufferStorage(...);
+ *
+ * Recursos: ARB_buffer_storage (StreamBuffer.h), ARB_get_program_binary e
+ * KHR_parallel_shader_compile (ShaderManager.h), ARB_compute_shader e
+ * ARB_shader_storage_buffer_object (TiledLighting.h), ARB_pipeline_statistics_query
+ * (DepthPrepass.h)
+ */
+
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// GL 4.4 / ARB_buffer_storage
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+// GL 4.1 / ARB_get_program_binary
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// KHR_parallel_shader_compile / ARB_parallel_shader_compile (mesmos valores)
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// GL 4.3 / ARB_compute_shader e ARB_shader_storage_buffer_object
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+#ifndef GL_BUFFER_UPDATE_BARRIER_BIT
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#endif
+
+// GL 4.6 / ARB_pipeline_statistics_query (só novos alvos de glBeginQuery)
+#ifndef GL_FRAGMENT_SHADER_INVOCATIONS_ARB
+#define GL_FRAGMENT_SHADER_INVOCATIONS_ARB 0x82F4
+#endif
+
+namespace glext
+{
+	typedef void(APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+	typedef void(APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+	typedef void(APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+	typedef void(APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+	typedef void(APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+	typedef void(APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ);
+	typedef void(APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+
+	inline PFNGLBUFFERSTORAGEPROC glBufferStorage = nullptr;
+	inline PFNGLGETPROGRAMBINARYPROC glGetProgramBinary = nullptr;
+	inline PFNGLPROGRAMBINARYPROC glProgramBinary = nullptr;
+	inline PFNGLPROGRAMPARAMETERIPROC glProgramParameteri = nullptr;
+	inline PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glMaxShaderCompilerThreadsKHR = nullptr;
+	inline PFNGLDISPATCHCOMPUTEPROC glDispatchCompute = nullptr;
+	inline PFNGLMEMORYBARRIERPROC glMemoryBarrier = nullptr;
+
+	inline bool hasBufferStorage = false;
+	inline bool hasProgramBinary = false; // além da extensão, o driver precisa oferecer ao menos um formato binário
+	inline bool hasParallelShaderCompile = false;
+	inline bool hasComputeShader = false;
+	inline bool hasShaderStorage = false; // SSBO nos shaders #version 400, com layout(binding) (420pack)
+	inline bool hasPipelineStatistics = false;
+
+	// Versão do contexto atual no formato 10 * major + minor (ex.: 45)
+	inline int contextVersion()
+	{
+		GLint major = 0, minor = 0;
+		glGetIntegerv(GL_MAJOR_VERSION, &major);
+		glGetIntegerv(GL_MINOR_VERSION, &minor);
+		return major * 10 + minor;
+	}
+
+	// Um recurso está disponível se o contexto tem a versão em que ele entrou no core
+	// ou se o driver anuncia a extensão ARB/KHR correspondente
+	inline bool supports(int coreVersion, const char *extension)
+	{
+		return contextVersion() >= coreVersion || glfwExtensionSupported(extension);
+	}
+
+	template <typename Proc>
+	inline bool loadProc(Proc &proc, const char *name)
+	{
+		proc = reinterpret_cast<Proc>(glfwGetProcAddress(name));
+		return proc != nullptr;
+	}
+
+	// Deve ser chamada com um contexto ativo, depois do gladLoadGLLoader
+	inline void load()
+	{
+		hasBufferStorage = supports(44, "GL_ARB_buffer_storage") && loadProc(glBufferStorage, "glBufferStorage");
+
+		hasProgramBinary = supports(41, "GL_ARB_get_program_binary") && loadProc(glGetProgramBinary, "glGetProgramBinary") &&
+						   loadProc(glProgramBinary, "glProgramBinary") && loadProc(glProgramParameteri, "glProgramParameteri");
+		if (hasProgramBinary)
+		{
+			GLint formats = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+			hasProgramBinary = formats > 0;
+		}
+
+		// Não entrou no core: só a extensão KHR ou a ARB equivalente
+		hasParallelShaderCompile = (glfwExtensionSupported("GL_KHR_parallel_shader_compile") && loadProc(glMaxShaderCompilerThreadsKHR, "glMaxShaderCompilerThreadsKHR")) ||
+								   (glfwExtensionSupported("GL_ARB_parallel_shader_compile") && loadProc(glMaxShaderCompilerThreadsKHR, "glMaxShaderCompilerThreadsARB"));
+
+		hasShaderStorage = supports(43, "GL_ARB_shader_storage_buffer_object") && supports(42, "GL_ARB_shading_language_420pack");
+		hasComputeShader = hasShaderStorage && supports(43, "GL_ARB_compute_shader") && loadProc(glDispatchCompute, "glDispatchCompute") &&
+						   loadProc(glMemoryBarrier, "glMemoryBarrier");
+
+		hasPipelineStatistics = supports(46, "GL_ARB_pipeline_statistics_query");
+	}
+}
@@ -23,44 +23,43 @@ using namespace std;
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "GLExtensions.h"
+#include "ShaderManager.h"
+#include "RenderOnDemand.h"
+#include "FramePacer.h"
+
 
 // Protótipo da função de callback de teclado
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 
 // Protótipos das funções
-int setupShader();
 int setupGeometry();
 
 // Dimensões da janela (pode ser alterado em tempo de execução)
 const GLuint WIDTH = 1000, HEIGHT = 1000;
 
-// Código fonte do Vertex Shader (em GLSL): ainda hardcoded
-const GLchar* vertexShaderSource = "#version 450\n"
-"layout (location = 0) in vec3 position;\n"
-"layout (location = 1) in vec3 color;\n"
-"uniform mat4 model;\n"
-"out vec4 finalColor;\n"
-"void main()\n"
-"{\n"
-//...pode ter mais linhas de código aqui!
-"gl_Position = model * vec4(position, 1.0);\n"
-"finalColor = vec4(color, 1.0);\n"
-"}\0";
-
-//Códifo fonte do Fragment Shader (em GLSL): ainda hardcoded
-const GLchar* fragmentShaderSource = "#version 450\n"
-"in vec4 finalColor;\n"
-"out vec4 color;\n"
-"void main()\n"
-"{\n"
-"color = finalColor;\n"
-"}\n\0";
-
 bool rotateX=false, rotateY=false, rotateZ=false;
 
 // Função MAIN
-int main()
+//   --redraw on-demand  só desenha quando algo muda (a pirâmide parada não gasta frames)
+//   --present M  vsync (padrão), adaptive, uncapped ou N (limite de N fps; ver FramePacer.h)
+//   --pacing low-latency  com vsync, atrasa o início do frame para reduzir a latência
+int main(int argc, char **argv)
 {
+	bool onDemandEnabled = false, lowLatencyPacing = false;
+	FramePacer::Mode presentMode = FramePacer::PRESENT_VSYNC;
+	double fpsCap = 0.0;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		string arg = argv[i];
+		if (arg == "--redraw")
+			onDemandEnabled = string(argv[i + 1]) == "on-demand";
+		else if (arg == "--present" && !FramePacer::parseMode(argv[i + 1], presentMode, fpsCap))
+			cout << "Modo de apresentação desconhecido: " << argv[i + 1] << " (use vsync, adaptive, uncapped ou um número de fps)" << endl;
+		else if (arg == "--pacing")
+			lowLatencyPacing = string(argv[i + 1]) == "low-latency";
+	}
+
 	// Inicialização da GLFW
 	glfwInit();
 
@@ -90,6 +89,7 @@ int main()
 		std::cout << "Failed to initialize GLAD" << std::endl;
 
 	}
+	glext::load();
 
 	// Obtendo as informações de versão
 	const GLubyte* renderer = glGetString(GL_RENDERER); /* get renderer string */
@@ -103,8 +103,11 @@ int main()
 	glViewport(0, 0, width, height);
 
 
-	// Compilando e buildando o programa de shader
-	GLuint shaderID = setupShader();
+	// Compilando e buildando o programa de shader (arquivos em assets/shaders, com cache
+	// do programa linkado entre execuções)
+	ShaderManager shaders;
+	GLuint shaderID = shaders.load("hello3d.vert", "hello3d.frag");
+	shaders.printStats();
 
 	// Gerando um buffer simples, com a geometria de um triângulo
 	GLuint VAO = setupGeometry();
@@ -120,12 +123,24 @@ int main()
 
 	glEnable(GL_DEPTH_TEST);
 
+	RenderOnDemand onDemand(window, onDemandEnabled);
+	FramePacer pacer;
+	pacer.setup(presentMode, fpsCap, lowLatencyPacing);
 
 	// Loop da aplicação - "game loop"
 	while (!glfwWindowShouldClose(window))
 	{
+		pacer.waitForFrame(); // limite de fps ou atraso de baixa latência
+
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
-		glfwPollEvents();
+		// (no modo sob demanda, dorme até chegar um se a pirâmide está parada)
+		onDemand.waitEvents();
+		onDemand.setAnimating(rotateX || rotateY || rotateZ);
+		if (!onDemand.beginFrame())
+		{
+			pacer.skipFrame();
+			continue;
+		}
 
 		// Limpa o buffer de cor
 		glClearColor(1.0f, 1.0f, 1.0f, 1.0f); //cor de fundo
@@ -167,7 +182,7 @@ int main()
 		glBindVertexArray(0);
 
 		// Troca os buffers da tela
-		glfwSwapBuffers(window);
+		pacer.present(window);
 	}
 	// Pede pra OpenGL desalocar os buffers
 	glDeleteVertexArrays(1, &VAO);
@@ -209,54 +224,6 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
 }
 
-//Esta função está basntante hardcoded - objetivo é compilar e "buildar" um programa de
-// shader simples e único neste exemplo de código
-// O código fonte do vertex e fragment shader está nos arrays vertexShaderSource e
-// fragmentShader source no iniçio deste arquivo
-// A função retorna o identificador do programa de shader
-int setupShader()
-{
-	// Vertex shader
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	// Checando erros de compilação (exibição via log no terminal)
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-	}
-	// Fragment shader
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	// Checando erros de compilação (exibição via log no terminal)
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-	}
-	// Linkando os shaders e criando o identificador do programa de shader
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	// Checando por erros de linkagem
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success) {
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	return shaderProgram;
-}
-
 // Esta função está bastante harcoded - objetivo é criar os buffers que armazenam a 
 // geometria de um triângulo
 // Apenas atributo coordenada nos vértices
@@ -0,0 +1,380 @@
+/*
+ * Input.h - entrada por eventos, mapeamento de ações e gravação/reprodução
+ *
+ * Em vez de consultar cada tecla com glfwGetKey a cada frame, os callbacks do GLFW
+ * (teclado, botões e posição do mouse) só enfileiram eventos numa fila circular sem
+ * trava (SpscQueue: um produtor, um consumidor, só dois índices atômicos). update(),
+ * uma vez por frame, consome a fila e atualiza o estado das ações: um frame sem
+ * eventos não custa nada além de ler os dois índices.
+ *
+ * As teclas não aparecem no código: cada ação tem um nome, e a tabela de ligações
+ * (ação -> tecla ou botão) é dado, montada com bind()/bindAll() e opcionalmente lida
+ * de um arquivo texto (loadBindings), uma ligação por linha: "ação TECLA", com '#'
+ * para comentários. Nomes de teclas: A-Z, 0-9, UP, DOWN, LEFT, RIGHT, ESCAPE, SPACE,
+ * ENTER, TAB, F1-F12, MOUSE_LEFT, MOUSE_RIGHT e MOUSE_MIDDLE.
+ *
+ * record(path) grava os eventos consumidos com o número do frame; replay(path) passa a
+ * ignorar a entrada real e entrega os eventos gravados nos mesmos frames (sessões
+ * repetíveis para benchmarks). O arquivo é texto: "frame tipo código ação x y".
+ *
+ * Uso:
+ *   enum { MOVE_FORWARD, QUIT };
+ *   InputSystem input({"move_forward", "quit"});
+ *   input.bindAll({{"move_forward", "W"}, {"quit", "ESCAPE"}});
+ *   input.attach(window);
+ *   // a cada frame, depois de glfwPollEvents:
+ *   input.update();
+ *   if (input.down(MOVE_FORWARD)) ...; if (input.pressed(QUIT)) ...;
+ *   for (const InputEvent &e : input.events()) ... // cursor e cliques, com posição
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <GLFW/glfw3.h>
+
+// Fila circular de capacidade fixa (potência de 2) para um produtor e um consumidor
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "Capacity deve ser potência de 2");
+
+public:
+	// Produtor: false se a fila estiver cheia
+	bool push(const T &item)
+	{
+		size_t tail = tailIndex.load(std::memory_order_relaxed);
+		if (tail - headIndex.load(std::memory_order_acquire) == Capacity)
+			return false;
+		items[tail & (Capacity - 1)] = item;
+		tailIndex.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumidor: false se a fila estiver vazia
+	bool pop(T &item)
+	{
+		size_t head = headIndex.load(std::memory_order_relaxed);
+		if (head == tailIndex.load(std::memory_order_acquire))
+			return false;
+		item = items[head & (Capacity - 1)];
+		headIndex.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	T items[Capacity];
+	alignas(64) std::atomic<size_t> headIndex{0};
+	alignas(64) std::atomic<size_t> tailIndex{0};
+};
+
+struct InputEvent
+{
+	enum Type : uint8_t
+	{
+		KEY,
+		MOUSE_BUTTON,
+		CURSOR
+	};
+
+	uint32_t frame = 0; // frame em que foi consumido (preenchido por update)
+	Type type = KEY;
+	int code = 0;	// tecla GLFW ou InputSystem::MOUSE_BASE + botão
+	int action = 0; // GLFW_PRESS, GLFW_RELEASE ou GLFW_REPEAT
+	double x = 0.0, y = 0.0; // posição do cursor (CURSOR e MOUSE_BUTTON)
+};
+
+class InputSystem
+{
+public:
+	static const size_t QUEUE_CAPACITY = 4096;
+	static const int MOUSE_BASE = 1000; // códigos dos botões: MOUSE_BASE + GLFW_MOUSE_BUTTON_*
+	static const int NO_ACTION = -1;
+
+	struct Binding
+	{
+		const char *action;
+		const char *key;
+	};
+
+	// Ações na ordem dos ids usados pelo programa
+	explicit InputSystem(std::initializer_list<const char *> actions)
+	{
+		for (const char *name : actions)
+			actionNames.push_back(name);
+		held.assign(actionNames.size(), 0);
+		pressedFrame.assign(actionNames.size(), UINT32_MAX);
+	}
+
+	~InputSystem()
+	{
+		if (active == this)
+			active = nullptr;
+		if (recordFile)
+			std::fclose(recordFile);
+	}
+
+	InputSystem(const InputSystem &) = delete;
+	InputSystem &operator=(const InputSystem &) = delete;
+
+	// Liga a tecla 'key' (nome, ver acima) à ação; false se algum dos nomes não existir
+	bool bind(const std::string &action, const std::string &key)
+	{
+		int a = actionId(action), code = keyCode(key);
+		if (a == NO_ACTION || code < 0)
+		{
+			std::cout << "Ligação inválida: " << action << " " << key << std::endl;
+			return false;
+		}
+		bindings[code].push_back(a);
+		return true;
+	}
+
+	bool bindAll(std::initializer_list<Binding> table)
+	{
+		bool ok = true;
+		for (const Binding &b : table)
+			ok = bind(b.action, b.key) && ok;
+		return ok;
+	}
+
+	// Troca as ligações das ações citadas no arquivo (as outras ficam como estão)
+	bool loadBindings(const std::string &path)
+	{
+		std::ifstream file(path);
+		if (!file)
+		{
+			std::cout << "Não foi possível abrir " << path << std::endl;
+			return false;
+		}
+		std::vector<std::pair<std::string, std::string>> entries;
+		std::string line;
+		while (std::getline(file, line))
+		{
+			std::istringstream in(line.substr(0, line.find('#')));
+			std::string action, key;
+			if (in >> action >> key)
+				entries.push_back(std::make_pair(action, key));
+		}
+		for (const auto &e : entries)
+		{
+			int a = actionId(e.first);
+			for (auto &b : bindings)
+				b.second.erase(std::remove(b.second.begin(), b.second.end(), a), b.second.end());
+		}
+		bool ok = true;
+		for (const auto &e : entries)
+			ok = bind(e.first, e.second) && ok;
+		std::cout << "Ligações lidas de " << path << ": " << entries.size() << std::endl;
+		return ok;
+	}
+
+	// Instala os callbacks de teclado e mouse na janela (um InputSystem por programa)
+	void attach(GLFWwindow *window)
+	{
+		active = this;
+		glfwSetKeyCallback(window, keyCallback);
+		glfwSetMouseButtonCallback(window, mouseButtonCallback);
+		glfwSetCursorPosCallback(window, cursorCallback);
+	}
+
+	bool record(const std::string &path)
+	{
+		recordFile = std::fopen(path.c_str(), "w");
+		if (recordFile == nullptr)
+		{
+			std::cout << "Não foi possível gravar a entrada em " << path << std::endl;
+			return false;
+		}
+		std::cout << "Gravando a entrada em " << path << std::endl;
+		return true;
+	}
+
+	bool replay(const std::string &path)
+	{
+		std::ifstream file(path);
+		if (!file)
+		{
+			std::cout << "Não foi possível abrir " << path << std::endl;
+			return false;
+		}
+		replayEvents.clear();
+		InputEvent e;
+		int type;
+		while (file >> e.frame >> type >> e.code >> e.action >> e.x >> e.y)
+		{
+			e.type = (InputEvent::Type)type;
+			replayEvents.push_back(e);
+		}
+		replayNext = 0;
+		replaying = true;
+		std::cout << "Reproduzindo " << replayEvents.size() << " eventos de " << path << std::endl;
+		return true;
+	}
+
+	bool isReplaying() const { return replaying; }
+	bool replayFinished() const { return replaying && replayNext == replayEvents.size(); }
+
+	// Uma vez por frame: consome os eventos (da fila ou da gravação) e atualiza as ações
+	void update()
+	{
+		frame++;
+		frameEvents.clear();
+		InputEvent e;
+		while (queue.pop(e))
+		{
+			if (replaying)
+				continue; // a entrada real é ignorada durante a reprodução
+			e.frame = frame;
+			frameEvents.push_back(e);
+		}
+		while (replaying && replayNext < replayEvents.size() && replayEvents[replayNext].frame <= frame)
+			frameEvents.push_back(replayEvents[replayNext++]);
+
+		for (const InputEvent &ev : frameEvents)
+		{
+			if (recordFile)
+				std::fprintf(recordFile, "%u %d %d %d %.17g %.17g\n", frame, (int)ev.type, ev.code, ev.action, ev.x, ev.y);
+			if (ev.type == InputEvent::CURSOR || ev.action == GLFW_REPEAT)
+				continue;
+			auto it = bindings.find(ev.code);
+			if (it == bindings.end())
+				continue;
+			for (int a : it->second)
+			{
+				if (ev.action == GLFW_PRESS)
+				{
+					held[a]++;
+					pressedFrame[a] = frame;
+				}
+				else if (held[a] > 0)
+					held[a]--;
+			}
+		}
+	}
+
+	// Ação com alguma tecla pressionada
+	bool down(int action) const { return held[action] > 0; }
+	// Ação acionada neste frame (borda de subida)
+	bool pressed(int action) const { return pressedFrame[action] == frame; }
+	// Eventos consumidos neste frame, na ordem (cursor e cliques com posição)
+	const std::vector<InputEvent> &events() const { return frameEvents; }
+
+	// Se o evento aciona a ação (tecla ou botão ligado a ela)
+	bool triggers(const InputEvent &e, int action) const
+	{
+		if (e.type == InputEvent::CURSOR || e.action != GLFW_PRESS)
+			return false;
+		auto it = bindings.find(e.code);
+		return it != bindings.end() && std::find(it->second.begin(), it->second.end(), action) != it->second.end();
+	}
+
+	uint32_t frameIndex() const { return frame; }
+	uint64_t droppedEvents() const { return dropped.load(std::memory_order_relaxed); }
+
+	int actionId(const std::string &name) const
+	{
+		for (size_t a = 0; a < actionNames.size(); ++a)
+		{
+			if (actionNames[a] == name)
+				return (int)a;
+		}
+		return NO_ACTION;
+	}
+
+	// Código GLFW da tecla (ou MOUSE_BASE + botão) pelo nome; -1 se desconhecido
+	static int keyCode(const std::string &name)
+	{
+		if (name.size() == 1 && name[0] >= 'A' && name[0] <= 'Z')
+			return GLFW_KEY_A + (name[0] - 'A');
+		if (name.size() == 1 && name[0] >= '0' && name[0] <= '9')
+			return GLFW_KEY_0 + (name[0] - '0');
+		if (name.size() >= 2 && name[0] == 'F' && name.find_first_not_of("0123456789", 1) == std::string::npos)
+		{
+			int n = std::stoi(name.substr(1));
+			return n >= 1 && n <= 12 ? GLFW_KEY_F1 + n - 1 : -1;
+		}
+		static const std::pair<const char *, int> named[] = {
+			{"UP", GLFW_KEY_UP}, {"DOWN", GLFW_KEY_DOWN}, {"LEFT", GLFW_KEY_LEFT}, {"RIGHT", GLFW_KEY_RIGHT},
+			{"ESCAPE", GLFW_KEY_ESCAPE}, {"SPACE", GLFW_KEY_SPACE}, {"ENTER", GLFW_KEY_ENTER}, {"TAB", GLFW_KEY_TAB},
+			{"MOUSE_LEFT", MOUSE_BASE + GLFW_MOUSE_BUTTON_LEFT}, {"MOUSE_RIGHT", MOUSE_BASE + GLFW_MOUSE_BUTTON_RIGHT},
+			{"MOUSE_MIDDLE", MOUSE_BASE + GLFW_MOUSE_BUTTON_MIDDLE}};
+		for (const auto &n : named)
+		{
+			if (name == n.first)
+				return n.second;
+		}
+		return -1;
+	}
+
+private:
+	static InputSystem *active;
+
+	SpscQueue<InputEvent, QUEUE_CAPACITY> queue;
+	std::atomic<uint64_t> dropped{0};
+	std::vector<std::string> actionNames;
+	std::unordered_map<int, std::vector<int>> bindings; // código -> ações
+	std::vector<int> held;				 // teclas ligadas pressionadas, por ação
+	std::vector<uint32_t> pressedFrame; // último frame em que a ação foi acionada
+	std::vector<InputEvent> frameEvents;
+	uint32_t frame = 0;
+
+	std::FILE *recordFile = nullptr;
+	std::vector<InputEvent> replayEvents;
+	size_t replayNext = 0;
+	bool replaying = false;
+
+	void enqueue(const InputEvent &e)
+	{
+		if (!queue.push(e))
+			dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static void keyCallback(GLFWwindow *, int key, int, int action, int)
+	{
+		if (active == nullptr || key == GLFW_KEY_UNKNOWN)
+			return;
+		InputEvent e;
+		e.type = InputEvent::KEY;
+		e.code = key;
+		e.action = action;
+		active->enqueue(e);
+	}
+
+	static void mouseButtonCallback(GLFWwindow *window, int button, int action, int)
+	{
+		if (active == nullptr)
+			return;
+		InputEvent e;
+		e.type = InputEvent::MOUSE_BUTTON;
+		e.code = MOUSE_BASE + button;
+		e.action = action;
+		glfwGetCursorPos(window, &e.x, &e.y);
+		active->enqueue(e);
+	}
+
+	static void cursorCallback(GLFWwindow *, double x, double y)
+	{
+		if (active == nullptr)
+			return;
+		InputEvent e;
+		e.type = InputEvent::CURSOR;
+		e.x = x;
+		e.y = y;
+		active->enqueue(e);
+	}
+};
+
+inline InputSystem *InputSystem::active = nullptr;
@@ -0,0 +1,192 @@
+/*
+ * JobSystem.h - sistema de jobs com roubo de trabalho (work-stealing)
+ *
+ * Cada "lane" (a thread que chama parallelFor é a lane 0, os workers são 1..N)
+ * possui sua própria fila de tarefas. O dono consome do fim da fila e as lanes
+ * ociosas roubam do início das filas vizinhas, equilibrando a carga quando os
+ * pedaços (chunks) têm custos diferentes (ex.: objetos descartados pelo culling).
+ *
+ * O índice da lane é repassado ao callback para que o chamador mantenha buffers
+ * lineares por thread sem nenhuma sincronização.
+ *
+ * Uso:
+ *   JobSystem jobs;                 // hardware_concurrency() lanes
+ *   jobs.parallelFor(n, 1024, [&](size_t begin, size_t end, unsigned lane) { ... });
+ *
+ * parallelFor é bloqueante e deve ser chamado sempre da mesma thread (a thread
+ * de render); chamadas aninhadas dentro de um job não são suportadas.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem
+{
+public:
+	// numLanes = 0 usa todos os núcleos disponíveis
+	explicit JobSystem(unsigned numLanes = 0)
+	{
+		if (numLanes == 0)
+			numLanes = std::thread::hardware_concurrency();
+		if (numLanes == 0)
+			numLanes = 1;
+
+		lanes = std::vector<Lane>(numLanes);
+		for (unsigned i = 1; i < numLanes; ++i)
+			workers.emplace_back(&JobSystem::workerLoop, this, i);
+	}
+
+	~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			stopping = true;
+		}
+		wakeUp.notify_all();
+		for (std::thread &t : workers)
+			t.join();
+	}
+
+	JobSystem(const JobSystem &) = delete;
+	JobSystem &operator=(const JobSystem &) = delete;
+
+	unsigned laneCount() const { return (unsigned)lanes.size(); }
+
+	// Divide [0, count) em pedaços de até 'grain' elementos e executa fn(begin, end, lane)
+	// em todas as lanes. Retorna apenas quando todos os pedaços terminaram.
+	template <typename Fn>
+	void parallelFor(size_t count, size_t grain, Fn &&fn)
+	{
+		if (count == 0)
+			return;
+		if (grain == 0)
+			grain = 1;
+
+		size_t numChunks = (count + grain - 1) / grain;
+		if (lanes.size() == 1 || numChunks == 1)
+		{
+			for (size_t begin = 0; begin < count; begin += grain)
+				fn(begin, begin + grain < count ? begin + grain : count, 0u);
+			return;
+		}
+
+		Batch batch;
+		batch.context = &fn;
+		batch.invoke = [](void *ctx, size_t b, size_t e, unsigned lane)
+		{ (*static_cast<Fn *>(ctx))(b, e, lane); };
+		batch.pending.store(numChunks, std::memory_order_relaxed);
+
+		// Distribui os pedaços em blocos contíguos por lane (melhor localidade);
+		// o roubo corrige o desequilíbrio depois
+		size_t perLane = (numChunks + lanes.size() - 1) / lanes.size();
+		for (size_t l = 0; l < lanes.size(); ++l)
+		{
+			std::lock_guard<std::mutex> lock(lanes[l].mutex);
+			for (size_t c = l * perLane; c < (l + 1) * perLane && c < numChunks; ++c)
+			{
+				size_t begin = c * grain;
+				size_t end = begin + grain < count ? begin + grain : count;
+				lanes[l].tasks.push_back(Task{&batch, begin, end});
+			}
+		}
+		queuedTasks.fetch_add(numChunks, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		wakeUp.notify_all();
+
+		// A thread chamadora também trabalha enquanto espera
+		while (batch.pending.load(std::memory_order_acquire) != 0)
+		{
+			if (!runOneTask(0))
+				std::this_thread::yield();
+		}
+	}
+
+private:
+	struct Batch
+	{
+		void *context = nullptr;
+		void (*invoke)(void *, size_t, size_t, unsigned) = nullptr;
+		std::atomic<size_t> pending{0};
+	};
+
+	struct Task
+	{
+		Batch *batch;
+		size_t begin, end;
+	};
+
+	struct Lane
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<Lane> lanes;
+	std::vector<std::thread> workers;
+
+	std::atomic<size_t> queuedTasks{0};
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+	bool stopping = false;
+
+	bool popLocal(unsigned lane, Task &out)
+	{
+		std::lock_guard<std::mutex> lock(lanes[lane].mutex);
+		if (lanes[lane].tasks.empty())
+			return false;
+		out = lanes[lane].tasks.back();
+		lanes[lane].tasks.pop_back();
+		return true;
+	}
+
+	bool steal(unsigned thief, Task &out)
+	{
+		for (size_t i = 1; i < lanes.size(); ++i)
+		{
+			size_t victim = (thief + i) % lanes.size();
+			std::unique_lock<std::mutex> lock(lanes[victim].mutex, std::try_to_lock);
+			if (!lock.owns_lock() || lanes[victim].tasks.empty())
+				continue;
+			out = lanes[victim].tasks.front();
+			lanes[victim].tasks.pop_front();
+			return true;
+		}
+		return false;
+	}
+
+	bool runOneTask(unsigned lane)
+	{
+		Task task;
+		if (!popLocal(lane, task) && !steal(lane, task))
+			return false;
+
+		queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+		task.batch->invoke(task.batch->context, task.begin, task.end, lane);
+		task.batch->pending.fetch_sub(1, std::memory_order_acq_rel);
+		return true;
+	}
+
+	void workerLoop(unsigned lane)
+	{
+		for (;;)
+		{
+			if (runOneTask(lane))
+				continue;
+
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			wakeUp.wait(lock, [this]
+						{ return stopping || queuedTasks.load(std::memory_order_acquire) != 0; });
+			if (stopping)
+				return;
+		}
+	}
+};
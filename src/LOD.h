@@ -0,0 +1,106 @@
+/*
+ * LOD.h - níveis de detalhe (LOD) e seleção por erro projetado na tela
+ *
+ * Uma cadeia de LOD é uma lista de malhas do mais detalhado (nível 0, a original)
+ * ao mais simples, cada uma com seu erro geométrico em unidades do modelo:
+ *  - malhas OBJ: níveis gerados pelo simplificador QEM (MeshSimplify.h);
+ *  - esferas: tesselações com menos segmentos (getSphereMesh), com erro igual à
+ *    flecha (sagitta) da maior corda.
+ *
+ * LODSelector escolhe, por objeto, o nível mais simples cujo erro projetado fica
+ * abaixo de um limite em pixels. A histerese (só simplifica com folga) evita que
+ * objetos perto do limite fiquem trocando de nível a cada frame.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "MeshData.h"
+#include "MeshSimplify.h"
+
+struct LODLevel
+{
+	MeshData mesh;
+	float error; // desvio máximo estimado em relação ao nível 0 (unidades do modelo)
+};
+
+// Simplifica 'base' sucessivamente pela razão 'ratio' até 'maxLevels' níveis, parando
+// quando a simplificação não consegue mais reduzir a malha de forma significativa
+inline std::vector<LODLevel> buildLODChain(const MeshData &base, int maxLevels = 4, float ratio = 0.5f)
+{
+	std::vector<LODLevel> chain;
+	chain.push_back(LODLevel{base, 0.0f});
+
+	MeshSimplifier simplifier(base);
+	for (int level = 1; level < maxLevels; ++level)
+	{
+		size_t previous = chain.back().mesh.triangleCount();
+		simplifier.simplifyTo((size_t)(previous * ratio));
+		if (simplifier.triangleCount() > previous * 0.85f)
+			break;
+		chain.push_back(LODLevel{simplifier.result(), simplifier.error()});
+	}
+	return chain;
+}
+
+// Erro de uma esfera tesselada: flecha da maior corda entre segmentos vizinhos
+inline float sphereTessellationError(float radius, int latSegments, int lonSegments)
+{
+	const float pi = 3.14159265358979323846f;
+	float maxAngle = std::max(pi / latSegments, 2.0f * pi / lonSegments);
+	return radius * (1.0f - std::cos(maxAngle * 0.5f));
+}
+
+struct LODSelector
+{
+	float pixelsPerUnit = 1.0f; // pixels por unidade a distância 1 (perspectiva) ou em qualquer distância (ortográfica)
+	bool perspective = true;
+	float threshold = 1.0f;	 // erro máximo tolerado na tela, em pixels
+	float hysteresis = 0.25f; // só simplifica quando o erro fica abaixo de threshold * (1 - hysteresis)
+
+	static LODSelector forPerspective(float fovyRadians, float viewportHeight)
+	{
+		LODSelector s;
+		s.pixelsPerUnit = viewportHeight / (2.0f * std::tan(fovyRadians * 0.5f));
+		s.perspective = true;
+		return s;
+	}
+
+	static LODSelector forOrtho(float orthoHeight, float viewportHeight)
+	{
+		LODSelector s;
+		s.pixelsPerUnit = viewportHeight / orthoHeight;
+		s.perspective = false;
+		return s;
+	}
+
+	float projectedError(float worldError, float distance) const
+	{
+		if (!perspective)
+			return worldError * pixelsPerUnit;
+		return worldError * pixelsPerUnit / std::max(distance, 1e-4f);
+	}
+
+	// errors[i]: erro do nível i (crescente), em unidades do modelo; 'scale' converte
+	// para unidades do mundo. Retorna o novo nível a partir do nível atual.
+	int select(const float *errors, int levelCount, float scale, float distance, int current) const
+	{
+		int fine = 0, coarse = 0;
+		for (int level = 1; level < levelCount; ++level)
+		{
+			float pixels = projectedError(errors[level] * scale, distance);
+			if (pixels <= threshold)
+				fine = level;
+			if (pixels <= threshold * (1.0f - hysteresis))
+				coarse = level;
+		}
+		if (current > fine)
+			return fine; // o nível atual ficou visível demais: refina imediatamente
+		if (coarse > current)
+			return coarse; // simplifica apenas com folga
+		return std::min(current, levelCount - 1);
+	}
+};
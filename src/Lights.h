@@ -0,0 +1,66 @@
+/*
+ * Lights.h - luzes pontuais da cena
+ *
+ * Cada luz tem posição, cor (já multiplicada pela intensidade) e raio de alcance.
+ * A atenuação cai suavemente até zero no raio:
+ *   att = (1 - (d / raio)^2)^2
+ * o que permite limitar cada luz a um volume (esfera) e ignorá-la fora dele.
+ *
+ * Na cena JSON (TriangleTex), "lights" é uma lista de objetos:
+ *   {"position": [x, y, z], "color": [r, g, b], "intensity": i, "radius": r}
+ * com "color", "intensity" e "radius" opcionais.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+struct PointLight
+{
+	glm::vec3 position = glm::vec3(0.0f);
+	glm::vec3 color = glm::vec3(1.0f);
+	float radius = 10.0f;
+};
+
+// Layout na GPU (atributo instanciado ou buffer std140/std430): 32 bytes por luz
+struct LightData
+{
+	glm::vec4 positionRadius; // xyz: posição, w: raio
+	glm::vec4 color;		  // rgb: cor * intensidade, w: não usado
+};
+
+inline void packLights(const std::vector<PointLight> &lights, std::vector<LightData> &out)
+{
+	out.resize(lights.size());
+	for (size_t i = 0; i < lights.size(); ++i)
+	{
+		out[i].positionRadius = glm::vec4(lights[i].position, lights[i].radius);
+		out[i].color = glm::vec4(lights[i].color, 0.0f);
+	}
+}
+
+// Luzes espalhadas pela caixa [minCorner, maxCorner], com cores saturadas e raio
+// fixo; a sequência é determinística (mesmas luzes em toda execução, para os benchmarks)
+inline std::vector<PointLight> generateLights(size_t count, const glm::vec3 &minCorner, const glm::vec3 &maxCorner, float radius, uint32_t seed = 1)
+{
+	uint32_t state = seed;
+	auto next = [&state]()
+	{
+		state = state * 1664525u + 1013904223u; // LCG (Numerical Recipes)
+		return (state >> 8) / 16777216.0f;		// [0, 1)
+	};
+
+	std::vector<PointLight> lights(count);
+	for (PointLight &light : lights)
+	{
+		light.position = minCorner + (maxCorner - minCorner) * glm::vec3(next(), next(), next());
+		float hue = next() * 6.0f;
+		light.color = glm::clamp(glm::vec3(std::abs(hue - 3.0f) - 1.0f, 2.0f - std::abs(hue - 2.0f), 2.0f - std::abs(hue - 4.0f)), 0.0f, 1.0f);
+		light.radius = radius;
+	}
+	return lights;
+}
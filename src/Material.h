@@ -0,0 +1,172 @@
+/*
+ * Material.h - materiais e variantes do shader de iluminação (uber-shader)
+ *
+ * assets/shaders/uber.vert e uber.frag implementam o modelo de Phong dos exercícios
+ * com partes opcionais, ligadas por #define:
+ *   HAS_TEXTURE    amostra a textura e multiplica pela cor do material
+ *   HAS_SPECULAR   termo especular (normalize/reflect/pow no fragment shader)
+ *   NORMAL_MATRIX  normal pela inversa transposta (necessária com escala não uniforme);
+ *                  sem ela a normal usa mat3(model)
+ *   INSTANCED      matriz de modelo por instância (locations 3-9) em vez do uniform
+ *   HAS_FOG        névoa linear pela distância à câmera
+ *   TILED_LIGHTS   soma as luzes pontuais do tile (TiledLighting.h) em vez da luz
+ *                  única; não é do material, e sim do caminho de renderização
+ *   HAS_SHADOWS    sombra da luz lightPos (ShadowMap.h); também do caminho, não do material
+ *
+ * Cada material pede só os recursos que usa (Material::features) e
+ * ShaderPermutations compila apenas as combinações pedidas, de preferência
+ * todas no carregamento da cena (prepare), para não haver compilação durante o jogo.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "ShaderManager.h"
+
+enum ShaderFeature : uint32_t
+{
+	FEATURE_TEXTURE = 1u << 0,
+	FEATURE_SPECULAR = 1u << 1,
+	FEATURE_NORMAL_MATRIX = 1u << 2,
+	FEATURE_INSTANCING = 1u << 3,
+	FEATURE_FOG = 1u << 4,
+	FEATURE_TILED_LIGHTS = 1u << 5,
+	FEATURE_SHADOWS = 1u << 6
+};
+
+const int SHADER_FEATURE_COUNT = 7;
+
+struct Material
+{
+	glm::vec3 color = glm::vec3(1.0f);
+	GLuint texture = 0; // 0: sem textura
+	float ambient = 0.2f;
+	float diffuse = 1.0f;
+	float specular = 1.0f; // 0: sem termo especular
+	float shininess = 32.0f;
+	bool nonUniformScale = false; // algum objeto com o material tem escala não uniforme
+	bool fog = false;
+
+	uint32_t features(bool instanced) const
+	{
+		uint32_t f = 0;
+		if (texture != 0)
+			f |= FEATURE_TEXTURE;
+		if (specular > 0.0f)
+			f |= FEATURE_SPECULAR;
+		if (nonUniformScale)
+			f |= FEATURE_NORMAL_MATRIX;
+		if (instanced)
+			f |= FEATURE_INSTANCING;
+		if (fog)
+			f |= FEATURE_FOG;
+		return f;
+	}
+
+	bool operator==(const Material &o) const
+	{
+		return color == o.color && texture == o.texture && ambient == o.ambient && diffuse == o.diffuse &&
+			   specular == o.specular && shininess == o.shininess && nonUniformScale == o.nonUniformScale && fog == o.fog;
+	}
+};
+
+inline std::vector<std::string> featureDefines(uint32_t features)
+{
+	static const char *names[SHADER_FEATURE_COUNT] = {"HAS_TEXTURE", "HAS_SPECULAR", "NORMAL_MATRIX", "INSTANCED", "HAS_FOG", "TILED_LIGHTS", "HAS_SHADOWS"};
+	std::vector<std::string> defines;
+	for (int i = 0; i < SHADER_FEATURE_COUNT; ++i)
+	{
+		if (features & (1u << i))
+			defines.push_back(names[i]);
+	}
+	return defines;
+}
+
+inline std::string featureNames(uint32_t features)
+{
+	std::string s;
+	for (const std::string &define : featureDefines(features))
+		s += (s.empty() ? "" : "+") + define;
+	return s.empty() ? "básico" : s;
+}
+
+class ShaderPermutations
+{
+public:
+	explicit ShaderPermutations(ShaderManager &shaders, const std::string &vertexFile = "uber.vert", const std::string &fragmentFile = "uber.frag")
+		: shaders(shaders), vertexFile(vertexFile), fragmentFile(fragmentFile) {}
+
+	// Compila de uma vez as variantes usadas pela cena
+	void prepare(const std::set<uint32_t> &featureSets)
+	{
+		for (uint32_t features : featureSets)
+			get(features);
+		std::cout << "Variantes do uber-shader: " << used.size() << " de " << (1 << SHADER_FEATURE_COUNT) << " possíveis (";
+		bool first = true;
+		for (uint32_t features : used)
+		{
+			std::cout << (first ? "" : ", ") << featureNames(features);
+			first = false;
+		}
+		std::cout << ")" << std::endl;
+	}
+
+	// Programa da variante; depois de uma recarga a quente devolve o programa novo.
+	// Chamada por desenho: o programa fica em cache por máscara e só passa de novo
+	// por shaders.load (defines, pré-processamento, hash) quando algum programa foi
+	// trocado pela recarga.
+	GLuint get(uint32_t features)
+	{
+		if (shaders.stats().reloads != cachedReloads)
+		{
+			programs.clear();
+			cachedReloads = shaders.stats().reloads;
+		}
+		auto it = programs.find(features);
+		if (it != programs.end())
+			return it->second;
+		used.insert(features);
+		GLuint program = shaders.load(vertexFile, fragmentFile, featureDefines(features));
+		if (program != 0)
+			programs[features] = program;
+		return program;
+	}
+
+	// Uniforms do material (o programa deve estar em uso); a textura vai na unidade 0
+	static void applyMaterial(GLuint program, const Material &material)
+	{
+		glUniform3fv(glGetUniformLocation(program, "objectColor"), 1, &material.color[0]);
+		glUniform1f(glGetUniformLocation(program, "ka"), material.ambient);
+		glUniform1f(glGetUniformLocation(program, "kd"), material.diffuse);
+		if (material.specular > 0.0f)
+		{
+			glUniform1f(glGetUniformLocation(program, "ks"), material.specular);
+			glUniform1f(glGetUniformLocation(program, "shininess"), material.shininess);
+		}
+		if (material.texture != 0)
+		{
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, material.texture);
+			glUniform1i(glGetUniformLocation(program, "texture1"), 0);
+		}
+	}
+
+	size_t variantCount() const { return used.size(); }
+
+private:
+	ShaderManager &shaders;
+	std::string vertexFile;
+	std::string fragmentFile;
+	std::set<uint32_t> used;
+	std::unordered_map<uint32_t, GLuint> programs; // cache de get() por máscara
+	int cachedReloads = 0;						   // shaders.stats().reloads quando o cache foi montado
+};
@@ -0,0 +1,118 @@
+/*
+ * Mesh.h - malhas indexadas na GPU
+ *
+ * uploadMesh envia um MeshData para um VAO com VBO intercalado e EBO.
+ * Layout dos atributos (o mesmo do TriangleTex):
+ *   location 0: posição (x, y, z)
+ *   location 1: coordenada de textura (s, t)
+ *   location 2: normal (x, y, z)
+ * Por padrão os atributos são compactados (VertexFormat::compact(), 16 bytes por
+ * vértice); o vertex shader decodifica com assets/shaders/vertex_decode.glsl.
+ *
+ * Desenho: glBindVertexArray(mesh.VAO);
+ *          setVertexDecodeUniforms(program, mesh);
+ *          glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0);
+ */
+
+#pragma once
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "MeshData.h"
+#include "VertexFormat.h"
+
+struct Mesh
+{
+	GLuint VAO = 0;
+	GLuint VBO = 0;
+	GLuint EBO = 0;
+	GLsizei indexCount = 0;
+	GLsizei vertexCount = 0;
+
+	VertexFormat format;
+	glm::vec3 positionScale = glm::vec3(1.0f);
+	glm::vec3 positionOffset = glm::vec3(0.0f);
+
+	// Memória ocupada na GPU (VBO + EBO)
+	size_t byteSize() const { return (size_t)vertexCount * format.stride() + (size_t)indexCount * sizeof(uint32_t); }
+};
+
+inline Mesh uploadMesh(const MeshData &data, const VertexFormat &format = VertexFormat::compact())
+{
+	PackedVertices packed = packVertices(data, format);
+
+	Mesh mesh;
+	mesh.indexCount = (GLsizei)data.indices.size();
+	mesh.vertexCount = (GLsizei)data.vertexCount();
+	mesh.format = format;
+	mesh.positionScale = packed.positionScale;
+	mesh.positionOffset = packed.positionOffset;
+
+	glGenVertexArrays(1, &mesh.VAO);
+	glGenBuffers(1, &mesh.VBO);
+	glGenBuffers(1, &mesh.EBO);
+
+	glBindVertexArray(mesh.VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+	glBufferData(GL_ARRAY_BUFFER, packed.bytes.size(), packed.bytes.data(), GL_STATIC_DRAW);
+
+	// O EBO fica associado ao VAO
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(uint32_t), data.indices.data(), GL_STATIC_DRAW);
+
+	setupVertexAttributes(format);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return mesh;
+}
+
+// Parâmetros de vertex_decode.glsl para a malha; o programa deve estar em uso
+inline void setVertexDecodeUniforms(GLuint program, const Mesh &mesh)
+{
+	glUniform3fv(glGetUniformLocation(program, "positionScale"), 1, &mesh.positionScale[0]);
+	glUniform3fv(glGetUniformLocation(program, "positionOffset"), 1, &mesh.positionOffset[0]);
+	glUniform1i(glGetUniformLocation(program, "normalEncoding"), mesh.format.normal == NORMAL_OCT16 ? 1 : 0);
+}
+
+// VAO que lê só a posição do VBO da malha (mesmo EBO), para passadas de profundidade:
+// os outros atributos não são buscados. O chamador apaga com glDeleteVertexArrays.
+inline GLuint createPositionOnlyVAO(const Mesh &mesh)
+{
+	GLuint vao;
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+	setupPositionAttribute(mesh.format);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return vao;
+}
+
+inline void deleteMesh(Mesh &mesh)
+{
+	glDeleteVertexArrays(1, &mesh.VAO);
+	glDeleteBuffers(1, &mesh.VBO);
+	glDeleteBuffers(1, &mesh.EBO);
+	mesh = Mesh();
+}
+
+// Esferas já enviadas à GPU, por (raio, segmentos de latitude, segmentos de longitude):
+// pedidos repetidos compartilham o mesmo VAO/VBO/EBO
+inline const Mesh &getSphereMesh(float radius, int latSegments, int lonSegments)
+{
+	static std::map<std::tuple<float, int, int>, Mesh> cache;
+
+	std::tuple<float, int, int> key(radius, latSegments, lonSegments);
+	auto it = cache.find(key);
+	if (it == cache.end())
+		it = cache.emplace(key, uploadMesh(buildSphere(radius, latSegments, lonSegments))).first;
+	return it->second;
+}
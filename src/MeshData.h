@@ -0,0 +1,114 @@
+/*
+ * MeshData.h - malha indexada em memória (CPU)
+ *
+ * Representação comum das malhas geradas ou carregadas pelos exercícios, antes do
+ * envio para a GPU (ver Mesh.h). Os atributos ficam em arrays separados, um
+ * elemento por vértice, e os triângulos são descritos por 'indices'.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+struct MeshData
+{
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec2> texCoords;
+	std::vector<uint32_t> indices; // 3 por triângulo
+
+	size_t vertexCount() const { return positions.size(); }
+	size_t triangleCount() const { return indices.size() / 3; }
+
+	// Raio da esfera envolvente centrada na origem do modelo
+	float boundingRadius() const
+	{
+		float radius = 0.0f;
+		for (const glm::vec3 &p : positions)
+			radius = std::max(radius, glm::length(p));
+		return radius;
+	}
+};
+
+// Normais suaves: média das normais das faces ponderada pela área
+inline void computeVertexNormals(MeshData &mesh)
+{
+	mesh.normals.assign(mesh.vertexCount(), glm::vec3(0.0f));
+	for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+	{
+		uint32_t a = mesh.indices[t], b = mesh.indices[t + 1], c = mesh.indices[t + 2];
+		glm::vec3 n = glm::cross(mesh.positions[b] - mesh.positions[a], mesh.positions[c] - mesh.positions[a]);
+		mesh.normals[a] += n;
+		mesh.normals[b] += n;
+		mesh.normals[c] += n;
+	}
+	for (glm::vec3 &n : mesh.normals)
+	{
+		float len = glm::length(n);
+		n = len > 0.0f ? n / len : glm::vec3(0.0f, 1.0f, 0.0f);
+	}
+}
+
+// Esfera UV indexada: cada vértice (lat, lon) é calculado uma única vez, com senos e
+// cossenos tabelados por linha/coluna. A coluna lon == lonSegments repete a primeira
+// com u = 1 para a costura da textura. Os triângulos degenerados dos polos são omitidos.
+inline MeshData buildSphere(float radius, int latSegments, int lonSegments)
+{
+	MeshData mesh;
+	const float pi = 3.14159265358979323846f;
+
+	std::vector<float> sinTheta(latSegments + 1), cosTheta(latSegments + 1);
+	for (int i = 0; i <= latSegments; ++i)
+	{
+		float theta = i * pi / latSegments;
+		sinTheta[i] = std::sin(theta);
+		cosTheta[i] = std::cos(theta);
+	}
+	std::vector<float> sinPhi(lonSegments + 1), cosPhi(lonSegments + 1);
+	for (int j = 0; j <= lonSegments; ++j)
+	{
+		float phi = j * 2.0f * pi / lonSegments;
+		sinPhi[j] = std::sin(phi);
+		cosPhi[j] = std::cos(phi);
+	}
+
+	size_t numVertices = (size_t)(latSegments + 1) * (lonSegments + 1);
+	mesh.positions.reserve(numVertices);
+	mesh.normals.reserve(numVertices);
+	mesh.texCoords.reserve(numVertices);
+	for (int i = 0; i <= latSegments; ++i)
+	{
+		for (int j = 0; j <= lonSegments; ++j)
+		{
+			// A normal de uma esfera centrada na origem é a posição / raio
+			glm::vec3 normal(cosPhi[j] * sinTheta[i], cosTheta[i], sinPhi[j] * sinTheta[i]);
+			mesh.positions.push_back(normal * radius);
+			mesh.normals.push_back(normal);
+			mesh.texCoords.push_back(glm::vec2((float)j / lonSegments, (float)i / latSegments));
+		}
+	}
+
+	mesh.indices.reserve((size_t)latSegments * lonSegments * 6);
+	uint32_t rowSize = (uint32_t)lonSegments + 1;
+	for (int i = 0; i < latSegments; ++i)
+	{
+		for (int j = 0; j < lonSegments; ++j)
+		{
+			uint32_t v0 = i * rowSize + j;	 // (i, j)
+			uint32_t v1 = v0 + rowSize;		 // (i + 1, j)
+			uint32_t v2 = v0 + 1;			 // (i, j + 1)
+			uint32_t v3 = v1 + 1;			 // (i + 1, j + 1)
+
+			if (i != 0) // no polo norte v0 e v2 coincidem
+				mesh.indices.insert(mesh.indices.end(), {v0, v1, v2});
+			if (i != latSegments - 1) // no polo sul v1 e v3 coincidem
+				mesh.indices.insert(mesh.indices.end(), {v1, v3, v2});
+		}
+	}
+	return mesh;
+}
@@ -0,0 +1,163 @@
+/*
+ * MeshIO.h - gravação e leitura de malhas indexadas (MeshData)
+ *
+ * Formatos:
+ *  - .obj: Wavefront texto (v/vt/vn/f), legível pelo Blender e pelo ObjLoader.h
+ *  - .mesh: binário do projeto, carregado sem parsing:
+ *      MeshFileHeader
+ *      vec3 positions[vertexCount]
+ *      vec3 normals[vertexCount]
+ *      vec2 texCoords[vertexCount]
+ *      uint32 indices[indexCount]
+ *    (little-endian, floats IEEE 754)
+ *
+ * loadMeshFile escolhe o formato pela extensão do arquivo.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "MeshData.h"
+#include "ObjLoader.h"
+
+struct MeshFileHeader
+{
+	char magic[4];		 // "CGMH"
+	uint32_t version;	 // MESH_FILE_VERSION
+	uint32_t vertexCount;
+	uint32_t indexCount;
+};
+
+const uint32_t MESH_FILE_VERSION = 1;
+
+inline bool writeMeshBinary(const std::string &path, const MeshData &mesh)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "Erro ao criar arquivo: " << path << std::endl;
+		return false;
+	}
+
+	MeshFileHeader header;
+	std::memcpy(header.magic, "CGMH", 4);
+	header.version = MESH_FILE_VERSION;
+	header.vertexCount = (uint32_t)mesh.vertexCount();
+	header.indexCount = (uint32_t)mesh.indices.size();
+
+	file.write((const char *)&header, sizeof(header));
+	file.write((const char *)mesh.positions.data(), mesh.positions.size() * sizeof(glm::vec3));
+	file.write((const char *)mesh.normals.data(), mesh.normals.size() * sizeof(glm::vec3));
+	file.write((const char *)mesh.texCoords.data(), mesh.texCoords.size() * sizeof(glm::vec2));
+	file.write((const char *)mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+	return file.good();
+}
+
+inline bool readMeshBinary(const std::string &path, MeshData &mesh)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "Erro ao abrir arquivo: " << path << std::endl;
+		return false;
+	}
+
+	MeshFileHeader header;
+	if (!file.read((char *)&header, sizeof(header)) || std::memcmp(header.magic, "CGMH", 4) != 0 || header.version != MESH_FILE_VERSION)
+	{
+		std::cout << "Arquivo de malha inválido: " << path << std::endl;
+		return false;
+	}
+
+	// Os tamanhos do cabeçalho precisam bater com o arquivo (em 64 bits, sem overflow):
+	// um cache truncado ou corrompido é recusado antes de alocar
+	uint64_t vertexBytes = (uint64_t)header.vertexCount * (2 * sizeof(glm::vec3) + sizeof(glm::vec2));
+	uint64_t indexBytes = (uint64_t)header.indexCount * sizeof(uint32_t);
+	std::streamoff dataStart = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streamoff fileSize = file.tellg();
+	file.seekg(dataStart);
+	if (dataStart < 0 || fileSize < 0 || (uint64_t)(fileSize - dataStart) != vertexBytes + indexBytes || header.indexCount % 3 != 0)
+	{
+		std::cout << "Arquivo de malha com tamanho inconsistente: " << path << std::endl;
+		return false;
+	}
+
+	mesh.positions.resize(header.vertexCount);
+	mesh.normals.resize(header.vertexCount);
+	mesh.texCoords.resize(header.vertexCount);
+	mesh.indices.resize(header.indexCount);
+	file.read((char *)mesh.positions.data(), mesh.positions.size() * sizeof(glm::vec3));
+	file.read((char *)mesh.normals.data(), mesh.normals.size() * sizeof(glm::vec3));
+	file.read((char *)mesh.texCoords.data(), mesh.texCoords.size() * sizeof(glm::vec2));
+	file.read((char *)mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+	if (!file)
+	{
+		std::cout << "Arquivo de malha truncado: " << path << std::endl;
+		return false;
+	}
+	for (uint32_t index : mesh.indices)
+	{
+		if (index >= header.vertexCount)
+		{
+			std::cout << "Arquivo de malha com índice fora do intervalo: " << path << std::endl;
+			mesh = MeshData();
+			return false;
+		}
+	}
+	return true;
+}
+
+inline bool writeOBJMesh(const std::string &path, const MeshData &mesh)
+{
+	std::ofstream file(path);
+	if (!file.is_open())
+	{
+		std::cout << "Erro ao criar arquivo: " << path << std::endl;
+		return false;
+	}
+
+	// Os três atributos compartilham o mesmo índice por vértice
+	file << "# " << mesh.vertexCount() << " vertices, " << mesh.triangleCount() << " triangles\n";
+	for (const glm::vec3 &p : mesh.positions)
+		file << "v " << p.x << " " << p.y << " " << p.z << "\n";
+	for (const glm::vec2 &t : mesh.texCoords)
+		file << "vt " << t.s << " " << t.t << "\n";
+	for (const glm::vec3 &n : mesh.normals)
+		file << "vn " << n.x << " " << n.y << " " << n.z << "\n";
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		file << "f";
+		for (int k = 0; k < 3; ++k)
+		{
+			uint32_t v = mesh.indices[i + k] + 1;
+			file << " " << v << "/" << v << "/" << v;
+		}
+		file << "\n";
+	}
+	return file.good();
+}
+
+inline bool hasExtension(const std::string &path, const std::string &ext)
+{
+	return path.size() >= ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+inline bool loadMeshFile(const std::string &path, MeshData &mesh)
+{
+	if (hasExtension(path, ".mesh"))
+		return readMeshBinary(path, mesh);
+	return loadOBJMesh(path, mesh);
+}
+
+inline bool saveMeshFile(const std::string &path, const MeshData &mesh)
+{
+	if (hasExtension(path, ".mesh"))
+		return writeMeshBinary(path, mesh);
+	return writeOBJMesh(path, mesh);
+}
@@ -0,0 +1,576 @@
+/*
+ * MeshSimplify.h - simplificação de malhas por métrica de erro quádrico (QEM)
+ *
+ * Implementação do colapso de arestas de Garland & Heckbert sobre um MeshData:
+ *  - cada posição acumula as quádricas (planos ponderados pela área) das faces
+ *    vizinhas; colapsar p -> q custa (Qp + Qq)(q);
+ *  - os colapsos candidatos ficam em um heap (priority_queue) com invalidação
+ *    preguiçosa por versão, resultando em O(n log n);
+ *  - colapsos são de meia-aresta (o vértice restante mantém posição, normal e UV
+ *    originais), então os atributos nunca são interpolados;
+ *  - costuras de UV/normal (mesma posição com vértices diferentes) só podem ser
+ *    colapsadas ao longo da própria costura, e bordas abertas só ao longo da borda.
+ *    Ambas recebem planos de restrição perpendiculares para manter o contorno;
+ *  - colapsos que invertem ou giram demais a normal de uma face, ou que quebram a
+ *    topologia (condição de link), são rejeitados.
+ *
+ * O erro devolvido é uma estimativa, em unidades do modelo, do desvio da superfície:
+ * a raiz do erro quádrico médio (ponderado pela área) do pior colapso realizado.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "MeshData.h"
+
+// Quádrica simétrica: Q(v) = vᵀAv + 2bᵀv + c
+struct Quadric
+{
+	double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+	double b0 = 0, b1 = 0, b2 = 0;
+	double c = 0;
+	double weight = 0; // soma dos pesos dos planos (para o erro médio)
+
+	// Plano n·x + d = 0 (n normalizado) com peso w
+	static Quadric fromPlane(const glm::dvec3 &n, double d, double w)
+	{
+		Quadric q;
+		q.a00 = w * n.x * n.x;
+		q.a01 = w * n.x * n.y;
+		q.a02 = w * n.x * n.z;
+		q.a11 = w * n.y * n.y;
+		q.a12 = w * n.y * n.z;
+		q.a22 = w * n.z * n.z;
+		q.b0 = w * d * n.x;
+		q.b1 = w * d * n.y;
+		q.b2 = w * d * n.z;
+		q.c = w * d * d;
+		q.weight = w;
+		return q;
+	}
+
+	Quadric &operator+=(const Quadric &o)
+	{
+		a00 += o.a00, a01 += o.a01, a02 += o.a02, a11 += o.a11, a12 += o.a12, a22 += o.a22;
+		b0 += o.b0, b1 += o.b1, b2 += o.b2;
+		c += o.c;
+		weight += o.weight;
+		return *this;
+	}
+
+	double evaluate(const glm::dvec3 &v) const
+	{
+		double r = a00 * v.x * v.x + 2 * a01 * v.x * v.y + 2 * a02 * v.x * v.z + a11 * v.y * v.y + 2 * a12 * v.y * v.z + a22 * v.z * v.z + 2 * (b0 * v.x + b1 * v.y + b2 * v.z) + c;
+		return r > 0 ? r : 0;
+	}
+};
+
+struct SimplifyOptions
+{
+	// Colapsos que giram a normal de alguma face mais do que isso (cosseno) são rejeitados
+	float minNormalDot = 0.2f;
+	// Peso dos planos de restrição das bordas e costuras, relativo à área das faces
+	float boundaryWeight = 10.0f;
+	// Para antes do alvo de triângulos se o próximo colapso passar deste erro (unidades do modelo)
+	float maxError = 1e30f;
+};
+
+class MeshSimplifier
+{
+public:
+	explicit MeshSimplifier(const MeshData &input, const SimplifyOptions &opts = SimplifyOptions())
+		: source(input), options(opts)
+	{
+		setup();
+	}
+
+	// Colapsa arestas até restarem no máximo 'targetTriangles' triângulos (ou até
+	// não haver mais colapsos válidos). Pode ser chamada de novo com alvos menores.
+	void simplifyTo(size_t targetTriangles)
+	{
+		while (liveTriangles > targetTriangles && !heap.empty())
+		{
+			Candidate cand = heap.top();
+			heap.pop();
+
+			if (dead[cand.from] || dead[cand.to] || cand.versionFrom != version[cand.from] || cand.versionTo != version[cand.to])
+				continue;
+
+			double rms = std::sqrt(cand.cost / std::max(quadrics[cand.from].weight + quadrics[cand.to].weight, 1e-12));
+			if (rms > options.maxError)
+				break;
+			if (!tryCollapse(cand.from, cand.to))
+				continue;
+
+			maxError = std::max(maxError, (float)rms);
+		}
+	}
+
+	size_t triangleCount() const { return liveTriangles; }
+	float error() const { return maxError; }
+
+	// Malha resultante, apenas com os vértices ainda referenciados
+	MeshData result() const
+	{
+		MeshData out;
+		std::vector<uint32_t> remap(source.vertexCount(), UINT32_MAX);
+		for (size_t t = 0; t < alive.size(); ++t)
+		{
+			if (!alive[t])
+				continue;
+			for (int k = 0; k < 3; ++k)
+			{
+				uint32_t w = corners[t * 3 + k];
+				if (remap[w] == UINT32_MAX)
+				{
+					remap[w] = (uint32_t)out.positions.size();
+					out.positions.push_back(source.positions[w]);
+					out.normals.push_back(source.normals[w]);
+					out.texCoords.push_back(source.texCoords[w]);
+				}
+				out.indices.push_back(remap[w]);
+			}
+		}
+		return out;
+	}
+
+private:
+	struct Candidate
+	{
+		double cost;
+		uint32_t from, to;
+		uint32_t versionFrom, versionTo;
+		bool operator<(const Candidate &o) const { return cost > o.cost; } // heap de mínimo
+	};
+
+	const MeshData &source;
+	SimplifyOptions options;
+
+	std::vector<uint32_t> corners;		  // índice do vértice (wedge) de cada canto, 3 por triângulo
+	std::vector<uint8_t> alive;			  // por triângulo
+	std::vector<uint32_t> positionOf;	  // wedge -> posição única
+	std::vector<glm::dvec3> points;		  // por posição única
+	std::vector<Quadric> quadrics;		  // por posição única
+	std::vector<std::vector<uint32_t>> triangles; // posição -> triângulos incidentes (com entradas mortas)
+	std::vector<uint8_t> dead;			  // por posição
+	std::vector<uint8_t> locked;		  // por posição (arestas não-manifold)
+	std::vector<uint32_t> version;		  // por posição
+	std::priority_queue<Candidate> heap;
+	size_t liveTriangles = 0;
+	float maxError = 0.0f;
+
+	// buffers temporários reaproveitados entre colapsos
+	std::vector<uint32_t> ringP, ringQ, edgeTris, otherTris;
+	std::vector<std::pair<uint32_t, uint32_t>> wedgeMap;
+
+	static uint64_t edgeKey(uint32_t a, uint32_t b)
+	{
+		return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+	}
+
+	uint32_t cornerPosition(uint32_t t, int k) const { return positionOf[corners[t * 3 + k]]; }
+
+	void setup()
+	{
+		corners = source.indices;
+		size_t numTris = corners.size() / 3;
+		alive.assign(numTris, 1);
+		liveTriangles = numTris;
+
+		// Vértices com a mesma posição (costuras de UV/normal) compartilham uma posição única
+		struct PosHash
+		{
+			size_t operator()(const glm::vec3 &p) const
+			{
+				uint32_t h[3];
+				std::memcpy(h, &p.x, sizeof(h));
+				return ((size_t)h[0] * 73856093u) ^ ((size_t)h[1] * 19349663u) ^ ((size_t)h[2] * 83492791u);
+			}
+		};
+		std::unordered_map<glm::vec3, uint32_t, PosHash> unique;
+		positionOf.resize(source.vertexCount());
+		for (size_t v = 0; v < source.vertexCount(); ++v)
+		{
+			auto it = unique.find(source.positions[v]);
+			if (it == unique.end())
+			{
+				it = unique.emplace(source.positions[v], (uint32_t)points.size()).first;
+				points.push_back(glm::dvec3(source.positions[v]));
+			}
+			positionOf[v] = it->second;
+		}
+
+		size_t numPoints = points.size();
+		quadrics.assign(numPoints, Quadric());
+		triangles.assign(numPoints, {});
+		dead.assign(numPoints, 0);
+		locked.assign(numPoints, 0);
+		version.assign(numPoints, 0);
+
+		// Arestas: quantos triângulos as usam e se os vértices (wedges) diferem dos dois lados
+		struct EdgeInfo
+		{
+			uint32_t count = 0;
+			uint32_t wedgeA = 0, wedgeB = 0; // wedges do primeiro triângulo (na ordem de edgeKey)
+			bool seam = false;
+		};
+		std::unordered_map<uint64_t, EdgeInfo> edges;
+		edges.reserve(numTris * 2);
+
+		for (uint32_t t = 0; t < numTris; ++t)
+		{
+			glm::dvec3 p0 = points[cornerPosition(t, 0)], p1 = points[cornerPosition(t, 1)], p2 = points[cornerPosition(t, 2)];
+			glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+			double len = glm::length(n);
+			if (len > 0)
+			{
+				n /= len;
+				Quadric q = Quadric::fromPlane(n, -glm::dot(n, p0), len * 0.5);
+				for (int k = 0; k < 3; ++k)
+					quadrics[cornerPosition(t, k)] += q;
+			}
+
+			for (int k = 0; k < 3; ++k)
+			{
+				triangles[cornerPosition(t, k)].push_back(t);
+
+				uint32_t wa = corners[t * 3 + k], wb = corners[t * 3 + (k + 1) % 3];
+				uint32_t pa = positionOf[wa], pb = positionOf[wb];
+				if (pa > pb)
+					std::swap(wa, wb);
+				EdgeInfo &e = edges[edgeKey(pa, pb)];
+				if (e.count == 0)
+				{
+					e.wedgeA = wa;
+					e.wedgeB = wb;
+				}
+				else if (e.wedgeA != wa || e.wedgeB != wb)
+					e.seam = true;
+				e.count++;
+			}
+		}
+
+		// Bordas abertas e costuras recebem planos perpendiculares às faces vizinhas
+		for (uint32_t t = 0; t < numTris; ++t)
+		{
+			glm::dvec3 p0 = points[cornerPosition(t, 0)], p1 = points[cornerPosition(t, 1)], p2 = points[cornerPosition(t, 2)];
+			glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+			if (glm::length(n) == 0)
+				continue;
+			n = glm::normalize(n);
+
+			for (int k = 0; k < 3; ++k)
+			{
+				uint32_t pa = cornerPosition(t, k), pb = cornerPosition(t, (k + 1) % 3);
+				const EdgeInfo &e = edges[edgeKey(pa, pb)];
+				if (e.count > 2)
+				{
+					locked[pa] = locked[pb] = 1;
+					continue;
+				}
+				if (e.count == 2 && !e.seam)
+					continue;
+
+				glm::dvec3 edge = points[pb] - points[pa];
+				double edgeLen2 = glm::dot(edge, edge);
+				if (edgeLen2 == 0)
+					continue;
+				glm::dvec3 m = glm::normalize(glm::cross(edge, n));
+				Quadric q = Quadric::fromPlane(m, -glm::dot(m, points[pa]), options.boundaryWeight * edgeLen2);
+				quadrics[pa] += q;
+				quadrics[pb] += q;
+			}
+		}
+
+		for (const auto &entry : edges)
+		{
+			uint32_t a = (uint32_t)(entry.first >> 32), b = (uint32_t)(entry.first & 0xffffffffu);
+			pushCandidate(a, b);
+			pushCandidate(b, a);
+		}
+	}
+
+	void pushCandidate(uint32_t from, uint32_t to)
+	{
+		if (locked[from])
+			return;
+		Quadric q = quadrics[from];
+		q += quadrics[to];
+		heap.push(Candidate{q.evaluate(points[to]), from, to, version[from], version[to]});
+	}
+
+	// Triângulos vivos de uma posição (remove as entradas mortas da lista)
+	std::vector<uint32_t> &liveTrianglesOf(uint32_t p)
+	{
+		std::vector<uint32_t> &list = triangles[p];
+		list.erase(std::remove_if(list.begin(), list.end(), [this](uint32_t t)
+								  { return !alive[t]; }),
+				   list.end());
+		return list;
+	}
+
+	void gatherRing(uint32_t p, std::vector<uint32_t> &ring)
+	{
+		ring.clear();
+		for (uint32_t t : liveTrianglesOf(p))
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				uint32_t r = cornerPosition(t, k);
+				if (r != p)
+					ring.push_back(r);
+			}
+		}
+		std::sort(ring.begin(), ring.end());
+	}
+
+	// true se algum vizinho r de p compartilha apenas um triângulo com p (borda aberta)
+	static bool hasBorder(const std::vector<uint32_t> &sortedRing)
+	{
+		for (size_t i = 0; i < sortedRing.size();)
+		{
+			size_t j = i;
+			while (j < sortedRing.size() && sortedRing[j] == sortedRing[i])
+				++j;
+			if (j - i == 1)
+				return true;
+			i = j;
+		}
+		return false;
+	}
+
+	bool tryCollapse(uint32_t p, uint32_t q)
+	{
+		edgeTris.clear();
+		otherTris.clear();
+		for (uint32_t t : liveTrianglesOf(p))
+		{
+			bool hasQ = cornerPosition(t, 0) == q || cornerPosition(t, 1) == q || cornerPosition(t, 2) == q;
+			(hasQ ? edgeTris : otherTris).push_back(t);
+		}
+		if (edgeTris.empty())
+			return false;
+
+		// Vértice de borda só desliza ao longo da própria borda
+		gatherRing(p, ringP);
+		if (hasBorder(ringP) && edgeTris.size() != 1)
+			return false;
+
+		// Condição de link: os vizinhos em comum devem ser só os vértices opostos à aresta
+		gatherRing(q, ringQ);
+		ringP.erase(std::unique(ringP.begin(), ringP.end()), ringP.end());
+		ringQ.erase(std::unique(ringQ.begin(), ringQ.end()), ringQ.end());
+		size_t common = 0;
+		for (size_t i = 0, j = 0; i < ringP.size() && j < ringQ.size();)
+		{
+			if (ringP[i] < ringQ[j])
+				++i;
+			else if (ringP[i] > ringQ[j])
+				++j;
+			else
+				++common, ++i, ++j;
+		}
+		if (common != edgeTris.size())
+			return false;
+
+		// Cada wedge de p precisa de um wedge correspondente em q, obtido nos triângulos
+		// da aresta: isso restringe as costuras a colapsar ao longo delas mesmas
+		wedgeMap.clear();
+		for (uint32_t t : edgeTris)
+		{
+			uint32_t wp = 0, wq = 0;
+			for (int k = 0; k < 3; ++k)
+			{
+				uint32_t w = corners[t * 3 + k];
+				if (positionOf[w] == p)
+					wp = w;
+				else if (positionOf[w] == q)
+					wq = w;
+			}
+			bool found = false;
+			for (const auto &m : wedgeMap)
+			{
+				if (m.first == wp)
+				{
+					if (m.second != wq)
+						return false;
+					found = true;
+				}
+			}
+			if (!found)
+				wedgeMap.push_back({wp, wq});
+		}
+
+		const glm::dvec3 &target = points[q];
+		for (uint32_t t : otherTris)
+		{
+			glm::dvec3 v[3], moved[3];
+			for (int k = 0; k < 3; ++k)
+			{
+				uint32_t w = corners[t * 3 + k];
+				v[k] = points[positionOf[w]];
+				moved[k] = positionOf[w] == p ? target : v[k];
+
+				if (positionOf[w] == p)
+				{
+					bool mapped = false;
+					for (const auto &m : wedgeMap)
+						mapped = mapped || m.first == w;
+					if (!mapped)
+						return false;
+				}
+			}
+
+			// Normal antes/depois: rejeita inversões e rotações grandes
+			glm::dvec3 n0 = glm::cross(v[1] - v[0], v[2] - v[0]);
+			glm::dvec3 n1 = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+			double l0 = glm::length(n0), l1 = glm::length(n1);
+			if (l1 <= 1e-12 * (l0 + 1e-30))
+				return false;
+			if (l0 > 0 && glm::dot(n0, n1) < options.minNormalDot * l0 * l1)
+				return false;
+		}
+
+		// Colapso p -> q
+		for (uint32_t t : edgeTris)
+		{
+			alive[t] = 0;
+			--liveTriangles;
+		}
+		for (uint32_t t : otherTris)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				uint32_t &w = corners[t * 3 + k];
+				if (positionOf[w] != p)
+					continue;
+				for (const auto &m : wedgeMap)
+				{
+					if (m.first == w)
+					{
+						w = m.second;
+						break;
+					}
+				}
+			}
+			triangles[q].push_back(t);
+		}
+		triangles[p].clear();
+		dead[p] = 1;
+		quadrics[q] += quadrics[p];
+		version[q]++;
+
+		gatherRing(q, ringQ);
+		ringQ.erase(std::unique(ringQ.begin(), ringQ.end()), ringQ.end());
+		for (uint32_t r : ringQ)
+		{
+			pushCandidate(q, r);
+			pushCandidate(r, q);
+		}
+		return true;
+	}
+};
+
+// Atalho: simplifica 'input' para até 'targetTriangles' triângulos.
+// Se 'error' não for nulo, recebe a estimativa do desvio (unidades do modelo).
+inline MeshData simplifyMesh(const MeshData &input, size_t targetTriangles, float *error = nullptr, const SimplifyOptions &options = SimplifyOptions())
+{
+	MeshSimplifier simplifier(input, options);
+	simplifier.simplifyTo(targetTriangles);
+	if (error)
+		*error = simplifier.error();
+	return simplifier.result();
+}
+
+// Ponto do triângulo abc mais próximo de p (Ericson, Real-Time Collision Detection, 5.1.5)
+inline glm::vec3 closestPointOnTriangle(const glm::vec3 &p, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c)
+{
+	glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+	float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+	if (d1 <= 0 && d2 <= 0)
+		return a;
+
+	glm::vec3 bp = p - b;
+	float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+	if (d3 >= 0 && d4 <= d3)
+		return b;
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0 && d1 >= 0 && d3 <= 0)
+		return a + ab * (d1 / (d1 - d3));
+
+	glm::vec3 cp = p - c;
+	float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+	if (d6 >= 0 && d5 <= d6)
+		return c;
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0 && d2 >= 0 && d6 <= 0)
+		return a + ac * (d2 / (d2 - d6));
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+		return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+	float denom = 1.0f / (va + vb + vc);
+	return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+// Maior distância de pontos amostrados em 'from' (vértices, pontos médios das arestas e
+// centróides) até a superfície 'to'. Força bruta com descarte pela caixa de cada triângulo.
+inline float oneSidedHausdorff(const MeshData &from, const MeshData &to)
+{
+	struct Tri
+	{
+		glm::vec3 a, b, c, lo, hi;
+	};
+	std::vector<Tri> tris(to.triangleCount());
+	for (size_t t = 0; t < tris.size(); ++t)
+	{
+		Tri &tri = tris[t];
+		tri.a = to.positions[to.indices[t * 3]];
+		tri.b = to.positions[to.indices[t * 3 + 1]];
+		tri.c = to.positions[to.indices[t * 3 + 2]];
+		tri.lo = glm::min(tri.a, glm::min(tri.b, tri.c));
+		tri.hi = glm::max(tri.a, glm::max(tri.b, tri.c));
+	}
+
+	std::vector<glm::vec3> samples(from.positions);
+	for (size_t t = 0; t < from.triangleCount(); ++t)
+	{
+		glm::vec3 a = from.positions[from.indices[t * 3]], b = from.positions[from.indices[t * 3 + 1]], c = from.positions[from.indices[t * 3 + 2]];
+		samples.push_back((a + b + c) / 3.0f);
+		samples.push_back((a + b) * 0.5f);
+		samples.push_back((b + c) * 0.5f);
+		samples.push_back((c + a) * 0.5f);
+	}
+
+	float worst = 0.0f;
+	for (const glm::vec3 &p : samples)
+	{
+		float best = 1e30f;
+		for (const Tri &tri : tris)
+		{
+			glm::vec3 d = glm::max(glm::max(tri.lo - p, p - tri.hi), glm::vec3(0.0f));
+			if (glm::dot(d, d) >= best)
+				continue;
+			glm::vec3 q = closestPointOnTriangle(p, tri.a, tri.b, tri.c);
+			best = std::min(best, glm::dot(p - q, p - q));
+		}
+		worst = std::max(worst, best);
+	}
+	return std::sqrt(worst);
+}
+
+// Distância de Hausdorff simétrica (aproximada pelas amostras) entre duas malhas
+inline float hausdorffDistance(const MeshData &a, const MeshData &b)
+{
+	return std::max(oneSidedHausdorff(a, b), oneSidedHausdorff(b, a));
+}
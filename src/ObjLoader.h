@@ -0,0 +1,126 @@
+/*
+ * ObjLoader.h - carregamento de Wavefront .OBJ para uma malha indexada (MeshData)
+ *
+ * Diferente do loadSimpleOBJ dos "Code snippets", cada combinação única de índices
+ * posição/textura/normal (v/vt/vn) vira um vértice, e as faces referenciam esses
+ * vértices por índice. Polígonos com mais de 3 vértices são triangulados em leque.
+ * Aceita os formatos v, v/vt, v//vn e v/vt/vn e índices negativos (relativos).
+ * Se o arquivo não tiver normais, elas são calculadas pela média das faces.
+ */
+
+#pragma once
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MeshData.h"
+
+inline bool loadOBJMesh(const std::string &objPath, MeshData &mesh)
+{
+	std::ifstream file(objPath);
+	if (!file.is_open())
+	{
+		std::cout << "Failed to open OBJ file: " << objPath << std::endl;
+		return false;
+	}
+
+	std::vector<glm::vec3> temp_positions;
+	std::vector<glm::vec2> temp_texCoords;
+	std::vector<glm::vec3> temp_normals;
+
+	// chave (v, vt, vn) -> índice do vértice em 'mesh'
+	struct Key
+	{
+		int v, t, n;
+		bool operator==(const Key &o) const { return v == o.v && t == o.t && n == o.n; }
+	};
+	struct KeyHash
+	{
+		size_t operator()(const Key &k) const { return ((size_t)k.v * 73856093u) ^ ((size_t)k.t * 19349663u) ^ ((size_t)k.n * 83492791u); }
+	};
+	std::unordered_map<Key, uint32_t, KeyHash> vertexMap;
+
+	mesh = MeshData();
+	bool missingNormals = false;
+
+	// Converte um índice do OBJ (base 1, ou negativo = relativo ao fim) para base 0
+	auto resolve = [](const std::string &s, size_t count) -> int
+	{
+		if (s.empty())
+			return -1;
+		int i = std::stoi(s);
+		return i < 0 ? (int)count + i : i - 1;
+	};
+
+	std::string line, word;
+	std::vector<uint32_t> face;
+	while (std::getline(file, line))
+	{
+		std::istringstream ssline(line);
+		if (!(ssline >> word))
+			continue;
+
+		if (word == "v")
+		{
+			glm::vec3 v;
+			ssline >> v.x >> v.y >> v.z;
+			temp_positions.push_back(v);
+		}
+		else if (word == "vt")
+		{
+			glm::vec2 vt;
+			ssline >> vt.s >> vt.t;
+			temp_texCoords.push_back(vt);
+		}
+		else if (word == "vn")
+		{
+			glm::vec3 vn;
+			ssline >> vn.x >> vn.y >> vn.z;
+			temp_normals.push_back(vn);
+		}
+		else if (word == "f")
+		{
+			face.clear();
+			while (ssline >> word)
+			{
+				std::string index[3];
+				std::istringstream ss(word);
+				std::getline(ss, index[0], '/');
+				std::getline(ss, index[1], '/');
+				std::getline(ss, index[2]);
+
+				Key key{resolve(index[0], temp_positions.size()), resolve(index[1], temp_texCoords.size()), resolve(index[2], temp_normals.size())};
+				if (key.v < 0 || key.v >= (int)temp_positions.size() || key.t >= (int)temp_texCoords.size() || key.n >= (int)temp_normals.size())
+				{
+					std::cout << "Índice inválido no OBJ: " << word << std::endl;
+					return false;
+				}
+
+				auto it = vertexMap.find(key);
+				if (it == vertexMap.end())
+				{
+					uint32_t index = (uint32_t)mesh.positions.size();
+					mesh.positions.push_back(temp_positions[key.v]);
+					mesh.texCoords.push_back(key.t >= 0 ? temp_texCoords[key.t] : glm::vec2(0.0f));
+					mesh.normals.push_back(key.n >= 0 ? temp_normals[key.n] : glm::vec3(0.0f));
+					missingNormals = missingNormals || key.n < 0;
+					it = vertexMap.emplace(key, index).first;
+				}
+				face.push_back(it->second);
+			}
+
+			for (size_t i = 2; i < face.size(); ++i)
+				mesh.indices.insert(mesh.indices.end(), {face[0], face[i - 1], face[i]});
+		}
+	}
+
+	if (missingNormals)
+		computeVertexNormals(mesh);
+
+	std::cout << "Loaded OBJ: " << objPath << " (" << mesh.vertexCount() << " vertices, " << mesh.triangleCount() << " triangles)" << std::endl;
+	return true;
+}
@@ -0,0 +1,222 @@
+/*
+ * ObjectIdBuffer.h - seleção pela GPU com um buffer de ids de objeto
+ *
+ * Alternativa à grade com hash (SpatialHash.h): no frame em que há um clique, a
+ * cena é desenhada de novo num framebuffer R32UI (object_id.vert + object_id.frag)
+ * em que cada pixel guarda o índice do objeto visível + 1 (0: fundo). O índice vem
+ * dos dados de instância (w da primeira coluna da matriz normal, ver DrawList.h),
+ * então a passada usa o mesmo buffer de instâncias do frame, sem percorrer a cena
+ * na CPU. O scissor fica restrito ao pixel do cursor: só os vértices são
+ * processados de novo, e um único fragmento por objeto que cobre o pixel.
+ *
+ * O pixel é copiado para um pixel pack buffer (glReadPixels assíncrono) seguido de
+ * uma fence; poll() confere a fence sem esperar e só mapeia o buffer quando a GPU
+ * terminou, normalmente um frame depois. Há READBACK_SLOTS leituras em voo; um
+ * clique com todas ocupadas é ignorado.
+ *
+ * Uso por frame:
+ *   ObjectIdBuffer::Pick pick;
+ *   if (ids.poll(pick)) ... pick.object (-1: fundo) ...
+ *   ... desenho da cena ...
+ *   if (ids.pickRequested()) ids.render(projection, view, draw); // draw(GLuint program)
+ * e ids.requestPick(x, y) no callback do mouse (pixel com origem embaixo à esquerda).
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+#include <glad/glad.h>
+
+#include "ShaderManager.h"
+
+class ObjectIdBuffer
+{
+public:
+	static const int READBACK_SLOTS = 3;
+
+	struct Pick
+	{
+		int object = -1;	   // índice do objeto (-1: nenhum sob o pixel)
+		uint64_t latency = 0; // frames entre o desenho e a leitura
+	};
+
+	ObjectIdBuffer() {}
+	~ObjectIdBuffer() { release(); }
+
+	ObjectIdBuffer(const ObjectIdBuffer &) = delete;
+	ObjectIdBuffer &operator=(const ObjectIdBuffer &) = delete;
+
+	bool create(ShaderManager &shaderManager, int w, int h)
+	{
+		release();
+		shaders = &shaderManager;
+		width = w;
+		height = h;
+
+		glGenRenderbuffers(1, &idRenderbuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, idRenderbuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_R32UI, width, height);
+		glGenRenderbuffers(1, &depthRenderbuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		glGenFramebuffers(1, &framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, idRenderbuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
+		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (status != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "Framebuffer incompleto (ids de objeto): 0x" << std::hex << status << std::dec << std::endl;
+			return false;
+		}
+
+		for (Readback &r : slots)
+		{
+			glGenBuffers(1, &r.buffer);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, r.buffer);
+			glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(GLuint), nullptr, GL_STREAM_READ);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		return shaders->load("object_id.vert", "object_id.frag") != 0;
+	}
+
+	void release()
+	{
+		if (framebuffer == 0)
+			return;
+		for (Readback &r : slots)
+		{
+			if (r.fence)
+				glDeleteSync(r.fence);
+			glDeleteBuffers(1, &r.buffer);
+			r = Readback();
+		}
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteRenderbuffers(1, &idRenderbuffer);
+		glDeleteRenderbuffers(1, &depthRenderbuffer);
+		framebuffer = idRenderbuffer = depthRenderbuffer = 0;
+		requested = false;
+	}
+
+	void requestPick(int x, int y)
+	{
+		requestX = x < 0 ? 0 : x >= width ? width - 1 : x;
+		requestY = y < 0 ? 0 : y >= height ? height - 1 : y;
+		requested = framebuffer != 0;
+	}
+
+	bool pickRequested() const { return requested; }
+
+	// Pedido ainda não desenhado ou leitura ainda não entregue por poll()
+	bool busy() const
+	{
+		for (const Readback &r : slots)
+		{
+			if (r.fence)
+				return true;
+		}
+		return requested;
+	}
+
+	// Desenha os ids no pixel pedido e agenda a leitura; draw(program) desenha a cena
+	// com o programa em uso. Restaura o framebuffer e o viewport atuais.
+	template <typename Draw>
+	void render(const float *projection, const float *view, Draw &&draw)
+	{
+		requested = false;
+		Readback &slot = slots[nextSlot];
+		if (slot.fence)
+		{
+			std::cout << "Seleção ignorada: " << READBACK_SLOTS << " leituras ainda em andamento" << std::endl;
+			return;
+		}
+		nextSlot = (nextSlot + 1) % READBACK_SLOTS;
+
+		GLint previousDraw = 0, previousRead = 0, viewport[4];
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDraw);
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead);
+		glGetIntegerv(GL_VIEWPORT, viewport);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glViewport(0, 0, width, height);
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(requestX, requestY, 1, 1);
+		const GLuint background[4] = {0, 0, 0, 0};
+		const GLfloat farDepth = 1.0f;
+		glClearBufferuiv(GL_COLOR, 0, background);
+		glClearBufferfv(GL_DEPTH, 0, &farDepth);
+
+		GLuint program = shaders->load("object_id.vert", "object_id.frag");
+		glUseProgram(program);
+		glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, projection);
+		glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, view);
+		draw(program);
+		glDisable(GL_SCISSOR_TEST);
+
+		// Cópia para o PBO: glReadPixels retorna sem esperar a GPU
+		glReadBuffer(GL_COLOR_ATTACHMENT0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		glReadPixels(requestX, requestY, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		slot.frame = frameIndex;
+
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)previousDraw);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)previousRead);
+		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	}
+
+	// Uma vez por frame: true com o resultado da leitura mais antiga que a GPU já
+	// terminou (sem bloquear; as outras ficam para os próximos frames)
+	bool poll(Pick &out)
+	{
+		frameIndex++;
+		Readback *oldest = nullptr;
+		for (Readback &r : slots)
+		{
+			if (r.fence && (oldest == nullptr || r.frame < oldest->frame))
+				oldest = &r;
+		}
+		if (oldest == nullptr)
+			return false;
+		GLenum result = glClientWaitSync(oldest->fence, 0, 0);
+		if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+			return false;
+		glDeleteSync(oldest->fence);
+		oldest->fence = 0;
+
+		GLuint id = 0;
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, oldest->buffer);
+		if (const GLuint *mapped = (const GLuint *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(GLuint), GL_MAP_READ_BIT))
+		{
+			id = *mapped;
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		out.object = (int)id - 1;
+		out.latency = frameIndex - oldest->frame;
+		return true;
+	}
+
+private:
+	struct Readback
+	{
+		GLuint buffer = 0;
+		GLsync fence = 0;
+		uint64_t frame = 0;
+	};
+
+	ShaderManager *shaders = nullptr;
+	int width = 0, height = 0;
+	GLuint framebuffer = 0, idRenderbuffer = 0, depthRenderbuffer = 0;
+	Readback slots[READBACK_SLOTS];
+	int nextSlot = 0;
+	uint64_t frameIndex = 0;
+	bool requested = false;
+	int requestX = 0, requestY = 0;
+};
@@ -0,0 +1,706 @@
+/*
+ * RayTracer.h - ray tracing na CPU para imagens de referência (SoftRender --raytrace)
+ *
+ * Usa as mesmas malhas, materiais e câmera do rasterizador em software
+ * (SoftRaster.h) e o mesmo Phong do uber.frag (shadePhong), com sombras exatas da
+ * luz lightPos em vez do shadow map.
+ *
+ * Estruturas:
+ *   - todos os triângulos da cena em espaço de mundo, numa única BVH construída
+ *     com SAH por bins (BVH_BINS baldes por eixo); folhas com até BVH_MAX_LEAF
+ *     triângulos quando dividir não compensa. A profundidade vai até BVH_MAX_DEPTH
+ *     (abaixo disso vira folha, mesmo grande) para caber na pilha fixa da travessia
+ *   - nós de 32 bytes com os filhos vizinhos no array (left, left + 1)
+ *
+ * Render: a imagem é dividida em tiles de TILE_SIZE x TILE_SIZE repartidos entre as
+ * lanes do JobSystem. Cada tile é percorrido em pacotes de 2x2 pixels: os 4 raios
+ * atravessam a BVH juntos (um nó é visitado se algum raio ativo o atinge) e a
+ * interseção raio-triângulo (Möller-Trumbore) é feita para os 4 de uma vez
+ * (SSE2, ou escalar nas outras arquiteturas). Os raios de sombra também seguem em
+ * pacote e param no primeiro bloqueio.
+ *
+ * Os raios primários vão do near ao far plane da câmera (t em [0, 1]), então a
+ * imagem recorta os objetos como o OpenGL. Sem antisserrilhado (um raio por pixel).
+ *
+ * Uso:
+ *   RayTracer tracer;
+ *   tracer.addMesh(mesh, model, &material); // material vivo até o render
+ *   tracer.build();
+ *   tracer.setCamera(projection, view, eye);
+ *   tracer.setLight(lightPos, lightColor);
+ *   tracer.render(jobs, width, height);
+ *   tracer.readPixels(rgba);
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+#include "MeshData.h"
+#include "SoftRaster.h"
+
+// 4 floats (um por raio do pacote) e a máscara de comparação correspondente
+#ifdef SOFT_RASTER_SSE2
+struct Mask4
+{
+	__m128 m;
+	int bits() const { return _mm_movemask_ps(m); }
+};
+
+struct Float4
+{
+	__m128 v;
+	Float4() {}
+	Float4(__m128 x) : v(x) {}
+	Float4(float s) : v(_mm_set1_ps(s)) {}
+	static Float4 load(const float *p) { return _mm_loadu_ps(p); }
+	void store(float *p) const { _mm_storeu_ps(p, v); }
+};
+
+inline Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+inline Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+inline Float4 operator/(Float4 a, Float4 b) { return _mm_div_ps(a.v, b.v); }
+inline Float4 min4(Float4 a, Float4 b) { return _mm_min_ps(a.v, b.v); }
+inline Float4 max4(Float4 a, Float4 b) { return _mm_max_ps(a.v, b.v); }
+inline Mask4 operator<(Float4 a, Float4 b) { return Mask4{_mm_cmplt_ps(a.v, b.v)}; }
+inline Mask4 operator>(Float4 a, Float4 b) { return Mask4{_mm_cmpgt_ps(a.v, b.v)}; }
+inline Mask4 operator>=(Float4 a, Float4 b) { return Mask4{_mm_cmpge_ps(a.v, b.v)}; }
+inline Mask4 operator<=(Float4 a, Float4 b) { return Mask4{_mm_cmple_ps(a.v, b.v)}; }
+inline Mask4 operator&(Mask4 a, Mask4 b) { return Mask4{_mm_and_ps(a.m, b.m)}; }
+inline Mask4 andNot(Mask4 a, Mask4 b) { return Mask4{_mm_andnot_ps(b.m, a.m)}; } // a e não b
+inline Float4 select(Mask4 m, Float4 a, Float4 b) { return _mm_or_ps(_mm_and_ps(m.m, a.v), _mm_andnot_ps(m.m, b.v)); }
+inline Float4 abs4(Float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+inline Mask4 maskFromBits(int bits)
+{
+	return Mask4{_mm_castsi128_ps(_mm_set_epi32(bits & 8 ? -1 : 0, bits & 4 ? -1 : 0, bits & 2 ? -1 : 0, bits & 1 ? -1 : 0))};
+}
+#else
+struct Mask4
+{
+	int b;
+	int bits() const { return b; }
+};
+
+struct Float4
+{
+	float v[4];
+	Float4() {}
+	Float4(float s) { v[0] = v[1] = v[2] = v[3] = s; }
+	static Float4 load(const float *p)
+	{
+		Float4 r;
+		for (int i = 0; i < 4; ++i)
+			r.v[i] = p[i];
+		return r;
+	}
+	void store(float *p) const
+	{
+		for (int i = 0; i < 4; ++i)
+			p[i] = v[i];
+	}
+};
+
+#define RAYTRACER_LANEWISE(expr)  \
+	Float4 r;                     \
+	for (int i = 0; i < 4; ++i)   \
+		r.v[i] = expr;            \
+	return r
+#define RAYTRACER_MASKWISE(expr)  \
+	int bits = 0;                 \
+	for (int i = 0; i < 4; ++i)   \
+		bits |= (expr) ? 1 << i : 0; \
+	return Mask4{bits}
+
+inline Float4 operator+(Float4 a, Float4 b) { RAYTRACER_LANEWISE(a.v[i] + b.v[i]); }
+inline Float4 operator-(Float4 a, Float4 b) { RAYTRACER_LANEWISE(a.v[i] - b.v[i]); }
+inline Float4 operator*(Float4 a, Float4 b) { RAYTRACER_LANEWISE(a.v[i] * b.v[i]); }
+inline Float4 operator/(Float4 a, Float4 b) { RAYTRACER_LANEWISE(a.v[i] / b.v[i]); }
+inline Float4 min4(Float4 a, Float4 b) { RAYTRACER_LANEWISE(std::min(a.v[i], b.v[i])); }
+inline Float4 max4(Float4 a, Float4 b) { RAYTRACER_LANEWISE(std::max(a.v[i], b.v[i])); }
+inline Float4 abs4(Float4 a) { RAYTRACER_LANEWISE(std::abs(a.v[i])); }
+inline Float4 select(Mask4 m, Float4 a, Float4 b) { RAYTRACER_LANEWISE(m.b & (1 << i) ? a.v[i] : b.v[i]); }
+inline Mask4 operator<(Float4 a, Float4 b) { RAYTRACER_MASKWISE(a.v[i] < b.v[i]); }
+inline Mask4 operator>(Float4 a, Float4 b) { RAYTRACER_MASKWISE(a.v[i] > b.v[i]); }
+inline Mask4 operator>=(Float4 a, Float4 b) { RAYTRACER_MASKWISE(a.v[i] >= b.v[i]); }
+inline Mask4 operator<=(Float4 a, Float4 b) { RAYTRACER_MASKWISE(a.v[i] <= b.v[i]); }
+inline Mask4 operator&(Mask4 a, Mask4 b) { return Mask4{a.b & b.b}; }
+inline Mask4 andNot(Mask4 a, Mask4 b) { return Mask4{a.b & ~b.b}; }
+inline Mask4 maskFromBits(int bits) { return Mask4{bits}; }
+
+#undef RAYTRACER_LANEWISE
+#undef RAYTRACER_MASKWISE
+#endif
+
+class RayTracer
+{
+public:
+	static const int TILE_SIZE = 16;
+	static const int BVH_BINS = 12;
+	static const int BVH_MAX_LEAF = 8;
+	static const int BVH_MAX_DEPTH = 48; // a travessia empilha no máximo BVH_MAX_DEPTH + 1 nós
+
+	struct Stats
+	{
+		size_t triangles = 0;
+		size_t nodes = 0;
+		double buildMs = 0.0;
+		size_t primaryRays = 0;
+		size_t shadowRays = 0;
+		double renderMs = 0.0;
+
+		double raysPerSecond() const { return renderMs > 0.0 ? (primaryRays + shadowRays) / (renderMs / 1000.0) : 0.0; }
+	};
+
+	RayTracer() {}
+
+	RayTracer(const RayTracer &) = delete;
+	RayTracer &operator=(const RayTracer &) = delete;
+
+	// Acrescenta os triângulos da malha transformados por 'model'
+	void addMesh(const MeshData &mesh, const glm::mat4 &model, const SoftMaterial *material)
+	{
+		glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+		std::vector<glm::vec3> world(mesh.vertexCount()), normals(mesh.vertexCount());
+		for (size_t i = 0; i < mesh.vertexCount(); ++i)
+		{
+			world[i] = glm::vec3(model * glm::vec4(mesh.positions[i], 1.0f));
+			normals[i] = i < mesh.normals.size() ? normalMatrix * mesh.normals[i] : glm::vec3(0.0f, 0.0f, 1.0f);
+		}
+
+		for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+		{
+			uint32_t a = mesh.indices[t], b = mesh.indices[t + 1], c = mesh.indices[t + 2];
+			Triangle tri;
+			tri.v0 = world[a];
+			tri.e1 = world[b] - world[a];
+			tri.e2 = world[c] - world[a];
+			triangles.push_back(tri);
+
+			Shading s;
+			s.normal[0] = normals[a];
+			s.normal[1] = normals[b];
+			s.normal[2] = normals[c];
+			for (int k = 0; k < 3; ++k)
+			{
+				uint32_t v = mesh.indices[t + k];
+				s.texCoord[k] = v < mesh.texCoords.size() ? mesh.texCoords[v] : glm::vec2(0.0f);
+			}
+			s.material = material;
+			shading.push_back(s);
+		}
+	}
+
+	// Constrói a BVH (reordena os triângulos); chamar depois do último addMesh
+	void build()
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		size_t count = triangles.size();
+		std::vector<glm::vec3> centroids(count), boxMin(count), boxMax(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const Triangle &t = triangles[i];
+			glm::vec3 v1 = t.v0 + t.e1, v2 = t.v0 + t.e2;
+			boxMin[i] = glm::min(t.v0, glm::min(v1, v2));
+			boxMax[i] = glm::max(t.v0, glm::max(v1, v2));
+			centroids[i] = (boxMin[i] + boxMax[i]) * 0.5f;
+		}
+
+		std::vector<uint32_t> order(count);
+		for (size_t i = 0; i < count; ++i)
+			order[i] = (uint32_t)i;
+
+		nodes.clear();
+		nodes.reserve(count * 2 + 1);
+		nodes.push_back(Node());
+		nodes[0].leftFirst = 0;
+		nodes[0].count = (uint32_t)count;
+
+		// Pilha explícita: cenas grandes passariam do limite de recursão
+		std::vector<std::pair<uint32_t, int>> stack = {{0, 0}}; // nó e profundidade
+		while (!stack.empty())
+		{
+			uint32_t n = stack.back().first;
+			int depth = stack.back().second;
+			stack.pop_back();
+			uint32_t first = nodes[n].leftFirst, num = nodes[n].count;
+
+			glm::vec3 bMin(1e30f), bMax(-1e30f), cMin(1e30f), cMax(-1e30f);
+			for (uint32_t i = first; i < first + num; ++i)
+			{
+				bMin = glm::min(bMin, boxMin[order[i]]);
+				bMax = glm::max(bMax, boxMax[order[i]]);
+				cMin = glm::min(cMin, centroids[order[i]]);
+				cMax = glm::max(cMax, centroids[order[i]]);
+			}
+			nodes[n].boundsMin = bMin;
+			nodes[n].boundsMax = bMax;
+			// Malha degenerada (SAH desequilibrado): a folha fica grande, mas a pilha da
+			// travessia não estoura
+			if (num <= 2 || depth >= BVH_MAX_DEPTH)
+				continue;
+
+			// SAH por bins: custo = área(esq) * n(esq) + área(dir) * n(dir), comparado com
+			// a folha (área * n); a travessia custa ~1 interseção
+			int bestAxis = -1, bestSplit = 0;
+			float bestCost = surfaceArea(bMin, bMax) * (num - 1.0f);
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				float extent = cMax[axis] - cMin[axis];
+				if (extent <= 0.0f)
+					continue;
+				Bin bins[BVH_BINS];
+				float scale = BVH_BINS / extent;
+				for (uint32_t i = first; i < first + num; ++i)
+				{
+					uint32_t t = order[i];
+					int b = std::min(BVH_BINS - 1, (int)((centroids[t][axis] - cMin[axis]) * scale));
+					bins[b].count++;
+					bins[b].boxMin = glm::min(bins[b].boxMin, boxMin[t]);
+					bins[b].boxMax = glm::max(bins[b].boxMax, boxMax[t]);
+				}
+
+				// Varredura da esquerda e da direita acumulando caixas e contagens
+				float leftArea[BVH_BINS - 1], rightArea[BVH_BINS - 1];
+				uint32_t leftCount[BVH_BINS - 1], rightCount[BVH_BINS - 1];
+				Bin left, right;
+				for (int i = 0; i < BVH_BINS - 1; ++i)
+				{
+					left.add(bins[i]);
+					leftCount[i] = left.count;
+					leftArea[i] = left.count ? surfaceArea(left.boxMin, left.boxMax) : 0.0f;
+					right.add(bins[BVH_BINS - 1 - i]);
+					rightCount[BVH_BINS - 2 - i] = right.count;
+					rightArea[BVH_BINS - 2 - i] = right.count ? surfaceArea(right.boxMin, right.boxMax) : 0.0f;
+				}
+				for (int i = 0; i < BVH_BINS - 1; ++i)
+				{
+					float cost = leftArea[i] * leftCount[i] + rightArea[i] * rightCount[i];
+					if (leftCount[i] > 0 && rightCount[i] > 0 && cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = i;
+					}
+				}
+			}
+
+			if (bestAxis < 0)
+			{
+				if (num <= (uint32_t)BVH_MAX_LEAF)
+					continue;
+				// Dividir não compensa mas a folha ficaria grande: metade pela mediana
+				int axis = 0;
+				glm::vec3 extent = cMax - cMin;
+				if (extent.y > extent[axis])
+					axis = 1;
+				if (extent.z > extent[axis])
+					axis = 2;
+				std::nth_element(order.begin() + first, order.begin() + first + num / 2, order.begin() + first + num,
+								 [&](uint32_t a, uint32_t b)
+								 { return centroids[a][axis] < centroids[b][axis]; });
+				splitNode(n, first, num / 2, num, depth, stack);
+				continue;
+			}
+
+			float scale = BVH_BINS / (cMax[bestAxis] - cMin[bestAxis]);
+			uint32_t *mid = std::partition(order.data() + first, order.data() + first + num, [&](uint32_t t)
+										   { return std::min(BVH_BINS - 1, (int)((centroids[t][bestAxis] - cMin[bestAxis]) * scale)) <= bestSplit; });
+			splitNode(n, first, (uint32_t)(mid - (order.data() + first)), num, depth, stack);
+		}
+
+		// Reordena os triângulos na ordem das folhas (acesso sequencial na travessia)
+		std::vector<Triangle> sortedTriangles(count);
+		std::vector<Shading> sortedShading(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			sortedTriangles[i] = triangles[order[i]];
+			sortedShading[i] = shading[order[i]];
+		}
+		triangles.swap(sortedTriangles);
+		shading.swap(sortedShading);
+
+		statistics.triangles = count;
+		statistics.nodes = nodes.size();
+		statistics.buildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void setCamera(const glm::mat4 &projection, const glm::mat4 &view, const glm::vec3 &eye)
+	{
+		invViewProjection = glm::inverse(projection * view);
+		viewPos = eye;
+	}
+
+	void setLight(const glm::vec3 &position, const glm::vec3 &color)
+	{
+		lightPos = position;
+		lightColor = color;
+	}
+
+	void setBackground(const glm::vec3 &color) { background = color; }
+	void setShadows(bool enabled) { shadows = enabled; }
+
+	void render(JobSystem &jobs, int w, int h)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		width = w;
+		height = h;
+		image.assign((size_t)w * h, background);
+		int tilesX = (w + TILE_SIZE - 1) / TILE_SIZE, tilesY = (h + TILE_SIZE - 1) / TILE_SIZE;
+
+		laneCounters.assign(jobs.laneCount(), Counters());
+		if (!nodes.empty())
+		{
+			jobs.parallelFor((size_t)tilesX * tilesY, 1, [&](size_t begin, size_t end, unsigned lane)
+							 {
+				for (size_t t = begin; t < end; ++t)
+					renderTile((int)(t % tilesX) * TILE_SIZE, (int)(t / tilesX) * TILE_SIZE, laneCounters[lane]); });
+		}
+
+		statistics.primaryRays = statistics.shadowRays = 0;
+		for (const Counters &c : laneCounters)
+		{
+			statistics.primaryRays += c.primaryRays;
+			statistics.shadowRays += c.shadowRays;
+		}
+		statistics.renderMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void readPixels(std::vector<uint8_t> &out) const { toRGBA8(image, width, height, width, out); }
+
+	const Stats &stats() const { return statistics; }
+
+private:
+	struct Triangle
+	{
+		glm::vec3 v0, e1, e2;
+	};
+
+	struct Shading
+	{
+		glm::vec3 normal[3];
+		glm::vec2 texCoord[3];
+		const SoftMaterial *material;
+	};
+
+	struct Node
+	{
+		glm::vec3 boundsMin;
+		uint32_t leftFirst = 0; // interno: primeiro filho; folha: primeiro triângulo
+		glm::vec3 boundsMax;
+		uint32_t count = 0; // 0: nó interno
+	};
+
+	struct Bin
+	{
+		glm::vec3 boxMin = glm::vec3(1e30f), boxMax = glm::vec3(-1e30f);
+		uint32_t count = 0;
+
+		void add(const Bin &o)
+		{
+			boxMin = glm::min(boxMin, o.boxMin);
+			boxMax = glm::max(boxMax, o.boxMax);
+			count += o.count;
+		}
+	};
+
+	// 4 raios: origem, direção (não normalizada), inverso da direção e o hit mais próximo
+	struct RayPacket
+	{
+		Float4 ox, oy, oz, dx, dy, dz, idx, idy, idz;
+		Float4 t, u, v;
+		int triangle[4];
+		Mask4 active;
+	};
+
+	struct Counters
+	{
+		size_t primaryRays = 0, shadowRays = 0;
+	};
+
+	std::vector<Triangle> triangles;
+	std::vector<Shading> shading;
+	std::vector<Node> nodes;
+
+	glm::mat4 invViewProjection = glm::mat4(1.0f);
+	glm::vec3 viewPos = glm::vec3(0.0f), lightPos = glm::vec3(0.0f), lightColor = glm::vec3(1.0f);
+	glm::vec3 background = glm::vec3(0.0f);
+	bool shadows = true;
+
+	int width = 0, height = 0;
+	std::vector<glm::vec3> image; // linha 0 embaixo, como no rasterizador
+	std::vector<Counters> laneCounters;
+	Stats statistics;
+
+	static float surfaceArea(const glm::vec3 &bMin, const glm::vec3 &bMax)
+	{
+		glm::vec3 e = bMax - bMin;
+		return e.x * e.y + e.y * e.z + e.z * e.x;
+	}
+
+	void splitNode(uint32_t n, uint32_t first, uint32_t leftCount, uint32_t num, int depth, std::vector<std::pair<uint32_t, int>> &stack)
+	{
+		uint32_t left = (uint32_t)nodes.size();
+		nodes.push_back(Node());
+		nodes.push_back(Node());
+		nodes[left].leftFirst = first;
+		nodes[left].count = leftCount;
+		nodes[left + 1].leftFirst = first + leftCount;
+		nodes[left + 1].count = num - leftCount;
+		nodes[n].leftFirst = left;
+		nodes[n].count = 0;
+		stack.push_back({left, depth + 1});
+		stack.push_back({left + 1, depth + 1});
+	}
+
+	void setDirection(RayPacket &p, Float4 dx, Float4 dy, Float4 dz) const
+	{
+		p.dx = dx;
+		p.dy = dy;
+		p.dz = dz;
+		// Inverso limitado a +-1e30: com direção 0, (limite - origem) = 0 daria 0 * inf = NaN
+		p.idx = min4(max4(Float4(1.0f) / dx, Float4(-1e30f)), Float4(1e30f));
+		p.idy = min4(max4(Float4(1.0f) / dy, Float4(-1e30f)), Float4(1e30f));
+		p.idz = min4(max4(Float4(1.0f) / dz, Float4(-1e30f)), Float4(1e30f));
+	}
+
+	// Distância de entrada na caixa para os raios que a atingem antes do hit atual
+	Mask4 intersectBox(const RayPacket &p, const Node &node, Float4 &tEnter) const
+	{
+		Float4 tx1 = (Float4(node.boundsMin.x) - p.ox) * p.idx, tx2 = (Float4(node.boundsMax.x) - p.ox) * p.idx;
+		Float4 ty1 = (Float4(node.boundsMin.y) - p.oy) * p.idy, ty2 = (Float4(node.boundsMax.y) - p.oy) * p.idy;
+		Float4 tz1 = (Float4(node.boundsMin.z) - p.oz) * p.idz, tz2 = (Float4(node.boundsMax.z) - p.oz) * p.idz;
+		Float4 tNear = max4(max4(min4(tx1, tx2), min4(ty1, ty2)), min4(tz1, tz2));
+		Float4 tFar = min4(min4(max4(tx1, tx2), max4(ty1, ty2)), max4(tz1, tz2));
+		tEnter = max4(tNear, Float4(0.0f));
+		return p.active & (tFar >= tEnter) & (tEnter < p.t);
+	}
+
+	// Möller-Trumbore para os 4 raios; devolve os raios com hit mais próximo que p.t
+	Mask4 intersectTriangle(const RayPacket &p, const Triangle &tri, Float4 &t, Float4 &u, Float4 &v) const
+	{
+		Float4 e1x(tri.e1.x), e1y(tri.e1.y), e1z(tri.e1.z);
+		Float4 e2x(tri.e2.x), e2y(tri.e2.y), e2z(tri.e2.z);
+		Float4 px = p.dy * e2z - p.dz * e2y, py = p.dz * e2x - p.dx * e2z, pz = p.dx * e2y - p.dy * e2x;
+		Float4 det = e1x * px + e1y * py + e1z * pz;
+		Float4 invDet = Float4(1.0f) / det;
+		Float4 sx = p.ox - Float4(tri.v0.x), sy = p.oy - Float4(tri.v0.y), sz = p.oz - Float4(tri.v0.z);
+		u = (sx * px + sy * py + sz * pz) * invDet;
+		Float4 qx = sy * e1z - sz * e1y, qy = sz * e1x - sx * e1z, qz = sx * e1y - sy * e1x;
+		v = (p.dx * qx + p.dy * qy + p.dz * qz) * invDet;
+		t = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+		return p.active & (abs4(det) > Float4(1e-12f)) & (u >= Float4(0.0f)) & (v >= Float4(0.0f)) &
+			   (u + v <= Float4(1.0f)) & (t > Float4(0.0f)) & (t < p.t);
+	}
+
+	// Hit mais próximo de cada raio ativo (t, u, v, triangle)
+	void traceClosest(RayPacket &p) const
+	{
+		uint32_t stack[BVH_MAX_DEPTH + 1];
+		int top = 0;
+		stack[top++] = 0;
+		Float4 tEnter;
+		if (intersectBox(p, nodes[0], tEnter).bits() == 0)
+			return;
+		while (top > 0)
+		{
+			const Node &node = nodes[stack[--top]];
+			if (intersectBox(p, node, tEnter).bits() == 0)
+				continue; // p.t diminuiu desde que o nó foi empilhado
+			if (node.count > 0)
+			{
+				for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+				{
+					Float4 t, u, v;
+					Mask4 hit = intersectTriangle(p, triangles[i], t, u, v);
+					int bits = hit.bits();
+					if (bits == 0)
+						continue;
+					p.t = select(hit, t, p.t);
+					p.u = select(hit, u, p.u);
+					p.v = select(hit, v, p.v);
+					for (int r = 0; r < 4; ++r)
+					{
+						if (bits & (1 << r))
+							p.triangle[r] = (int)i;
+					}
+				}
+				continue;
+			}
+
+			// Visita primeiro o filho mais próximo (menor entrada entre os raios que o atingem)
+			Float4 tLeft, tRight;
+			Mask4 hitLeft = intersectBox(p, nodes[node.leftFirst], tLeft);
+			Mask4 hitRight = intersectBox(p, nodes[node.leftFirst + 1], tRight);
+			bool left = hitLeft.bits() != 0, right = hitRight.bits() != 0;
+			if (left && right)
+			{
+				bool leftFirst = minActive(tLeft, hitLeft) <= minActive(tRight, hitRight);
+				stack[top++] = leftFirst ? node.leftFirst + 1 : node.leftFirst;
+				stack[top++] = leftFirst ? node.leftFirst : node.leftFirst + 1;
+			}
+			else if (left)
+				stack[top++] = node.leftFirst;
+			else if (right)
+				stack[top++] = node.leftFirst + 1;
+		}
+	}
+
+	// Raios ativos bloqueados antes de p.t (qualquer hit serve)
+	int traceOcclusion(RayPacket &p) const
+	{
+		uint32_t stack[BVH_MAX_DEPTH + 1];
+		int top = 0;
+		stack[top++] = 0;
+		int occluded = 0;
+		while (top > 0)
+		{
+			const Node &node = nodes[stack[--top]];
+			Float4 tEnter;
+			if (intersectBox(p, node, tEnter).bits() == 0)
+				continue;
+			if (node.count > 0)
+			{
+				for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+				{
+					Float4 t, u, v;
+					int bits = intersectTriangle(p, triangles[i], t, u, v).bits();
+					if (bits == 0)
+						continue;
+					occluded |= bits;
+					p.active = andNot(p.active, maskFromBits(bits));
+					if (p.active.bits() == 0)
+						return occluded;
+				}
+				continue;
+			}
+			stack[top++] = node.leftFirst + 1;
+			stack[top++] = node.leftFirst;
+		}
+		return occluded;
+	}
+
+	static int laneCount(int bits) { return (bits & 1) + ((bits >> 1) & 1) + ((bits >> 2) & 1) + ((bits >> 3) & 1); }
+
+	static float minActive(Float4 t, Mask4 m)
+	{
+		float values[4];
+		select(m, t, Float4(1e30f)).store(values);
+		return std::min(std::min(values[0], values[1]), std::min(values[2], values[3]));
+	}
+
+	void renderTile(int x0, int y0, Counters &counters)
+	{
+		for (int y = y0; y < std::min(y0 + TILE_SIZE, height); y += 2)
+		{
+			for (int x = x0; x < std::min(x0 + TILE_SIZE, width); x += 2)
+				renderPacket(x, y, counters);
+		}
+	}
+
+	// Pixels (x, y), (x + 1, y), (x, y + 1) e (x + 1, y + 1)
+	void renderPacket(int x, int y, Counters &counters)
+	{
+		float o[3][4], d[3][4];
+		int activeBits = 0;
+		for (int r = 0; r < 4; ++r)
+		{
+			int px = x + (r & 1), py = y + (r >> 1);
+			if (px < width && py < height)
+				activeBits |= 1 << r;
+			glm::vec2 ndc((px + 0.5f) / width * 2.0f - 1.0f, (py + 0.5f) / height * 2.0f - 1.0f);
+			glm::vec4 nearPoint = invViewProjection * glm::vec4(ndc.x, ndc.y, -1.0f, 1.0f);
+			glm::vec4 farPoint = invViewProjection * glm::vec4(ndc.x, ndc.y, 1.0f, 1.0f);
+			glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+			glm::vec3 dir = glm::vec3(farPoint) / farPoint.w - origin;
+			for (int k = 0; k < 3; ++k)
+			{
+				o[k][r] = origin[k];
+				d[k][r] = dir[k];
+			}
+		}
+
+		RayPacket p;
+		p.ox = Float4::load(o[0]);
+		p.oy = Float4::load(o[1]);
+		p.oz = Float4::load(o[2]);
+		setDirection(p, Float4::load(d[0]), Float4::load(d[1]), Float4::load(d[2]));
+		p.t = Float4(1.0f); // far plane
+		p.u = p.v = Float4(0.0f);
+		p.active = maskFromBits(activeBits);
+		for (int r = 0; r < 4; ++r)
+			p.triangle[r] = -1;
+		traceClosest(p);
+		counters.primaryRays += laneCount(activeBits);
+
+		float t[4], u[4], v[4];
+		p.t.store(t);
+		p.u.store(u);
+		p.v.store(v);
+
+		// Pontos atingidos, normais de shading e raios de sombra até a luz
+		glm::vec3 position[4], normal[4], base[4];
+		float so[3][4], sd[3][4];
+		int hitBits = 0;
+		for (int r = 0; r < 4; ++r)
+		{
+			if (p.triangle[r] < 0 || !(activeBits & (1 << r)))
+			{
+				for (int k = 0; k < 3; ++k)
+					so[k][r] = sd[k][r] = 0.0f;
+				continue;
+			}
+			hitBits |= 1 << r;
+			const Triangle &tri = triangles[p.triangle[r]];
+			const Shading &s = shading[p.triangle[r]];
+			float w = 1.0f - u[r] - v[r];
+			position[r] = tri.v0 + u[r] * tri.e1 + v[r] * tri.e2;
+			normal[r] = glm::normalize(w * s.normal[0] + u[r] * s.normal[1] + v[r] * s.normal[2]);
+			base[r] = s.material->color;
+			if (s.material->texture)
+				base[r] *= s.material->texture->sample(w * s.texCoord[0] + u[r] * s.texCoord[1] + v[r] * s.texCoord[2]);
+
+			// Origem afastada da superfície pelo lado da luz (evita a auto-interseção)
+			glm::vec3 geometric = glm::normalize(glm::cross(tri.e1, tri.e2));
+			glm::vec3 toLight = lightPos - position[r];
+			glm::vec3 origin = position[r] + geometric * (glm::dot(geometric, toLight) > 0.0f ? 1e-4f : -1e-4f) * (1.0f + glm::length(position[r]));
+			glm::vec3 dir = lightPos - origin;
+			for (int k = 0; k < 3; ++k)
+			{
+				so[k][r] = origin[k];
+				sd[k][r] = dir[k];
+			}
+		}
+
+		int shadowBits = 0;
+		if (shadows && hitBits)
+		{
+			RayPacket sp;
+			sp.ox = Float4::load(so[0]);
+			sp.oy = Float4::load(so[1]);
+			sp.oz = Float4::load(so[2]);
+			setDirection(sp, Float4::load(sd[0]), Float4::load(sd[1]), Float4::load(sd[2]));
+			sp.t = Float4(1.0f); // até a luz
+			sp.active = maskFromBits(hitBits);
+			shadowBits = traceOcclusion(sp);
+			counters.shadowRays += laneCount(hitBits);
+		}
+
+		for (int r = 0; r < 4; ++r)
+		{
+			if (!(hitBits & (1 << r)))
+				continue;
+			const SoftMaterial &m = *shading[p.triangle[r]].material;
+			float lit = shadowBits & (1 << r) ? 0.0f : 1.0f;
+			image[(size_t)(y + (r >> 1)) * width + x + (r & 1)] = shadePhong(m, base[r], normal[r], position[r], lightPos, lightColor, viewPos, lit);
+		}
+	}
+};
@@ -0,0 +1,153 @@
+/*
+ * RenderOnDemand.h - só desenha quando algo mudou (modo ocioso)
+ *
+ * Com a cena parada, redesenhar a cada frame gasta CPU e GPU para produzir a mesma
+ * imagem. Neste modo o loop chama waitEvents() no lugar de glfwPollEvents(): se nada
+ * pediu um frame, a thread dorme em glfwWaitEventsTimeout até chegar um evento ou
+ * passar IDLE_TIMEOUT (para os observadores de arquivos da recarga a quente
+ * continuarem sendo consultados). Depois de atualizar o estado, beginFrame() diz se
+ * o frame ficou sujo e precisa ser desenhado.
+ *
+ * O programa marca o frame com invalidate() (entrada, shader recarregado, cena
+ * alterada) e mantém setAnimating(true) enquanto algo se move. A janela pede um
+ * frame sozinha quando precisa ser redesenhada (callback de refresh do GLFW).
+ *
+ * A cada REPORT_INTERVAL segundos imprime os frames desenhados, a fração do tempo
+ * dormindo e o uso de CPU do processo (todas as threads) no intervalo, e quantos
+ * frames foram poupados em relação a desenhar a cada atualização do monitor.
+ *
+ * Uso:
+ *   RenderOnDemand onDemand(window, enabled);
+ *   while (!glfwWindowShouldClose(window)) {
+ *       onDemand.waitEvents();
+ *       ... entrada, recargas: onDemand.invalidate() / setAnimating(...) ...
+ *       if (!onDemand.beginFrame()) continue;
+ *       ... desenha ...
+ *       glfwSwapBuffers(window);
+ *   }
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+#include <GLFW/glfw3.h>
+
+class RenderOnDemand
+{
+public:
+	static constexpr double IDLE_TIMEOUT = 0.1;	// segundos
+	static constexpr double REPORT_INTERVAL = 10.0; // segundos
+
+	RenderOnDemand(GLFWwindow *win, bool enable) : window(win), enabled(enable)
+	{
+		if (!enabled)
+			return;
+		active = this;
+		glfwSetWindowRefreshCallback(window, [](GLFWwindow *)
+									 {
+			if (active)
+				active->invalidate(); });
+		const GLFWvidmode *mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+		refreshRate = mode && mode->refreshRate > 0 ? mode->refreshRate : 60;
+		reportStart = glfwGetTime();
+		reportCpu = processCpuSeconds();
+		std::cout << "Render sob demanda: só desenha quando algo muda" << std::endl;
+	}
+
+	~RenderOnDemand()
+	{
+		if (active == this)
+			active = nullptr;
+	}
+
+	RenderOnDemand(const RenderOnDemand &) = delete;
+	RenderOnDemand &operator=(const RenderOnDemand &) = delete;
+
+	bool isEnabled() const { return enabled; }
+	void invalidate() { dirty = true; }
+	void setAnimating(bool value) { animating = value; }
+
+	// Processa os eventos; sem frame pendente, espera por eles (até IDLE_TIMEOUT)
+	void waitEvents()
+	{
+		if (!enabled || dirty || animating)
+		{
+			glfwPollEvents();
+			return;
+		}
+		double start = glfwGetTime();
+		glfwWaitEventsTimeout(IDLE_TIMEOUT);
+		idleSeconds += glfwGetTime() - start;
+	}
+
+	// true se o frame deve ser desenhado (sempre, sem o modo ativo)
+	bool beginFrame()
+	{
+		if (!enabled)
+			return true;
+		report();
+		if (!dirty && !animating)
+			return false;
+		dirty = false;
+		framesRendered++;
+		return true;
+	}
+
+	// Tempo de CPU do processo (todas as threads), em segundos
+	static double processCpuSeconds()
+	{
+#ifdef _WIN32
+		FILETIME creation, exit, kernel, user;
+		if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+			return 0.0;
+		auto toSeconds = [](const FILETIME &t)
+		{ return (double)(((uint64_t)t.dwHighDateTime << 32) | t.dwLowDateTime) * 1e-7; };
+		return toSeconds(kernel) + toSeconds(user);
+#else
+		return (double)std::clock() / CLOCKS_PER_SEC;
+#endif
+	}
+
+private:
+	static inline RenderOnDemand *active = nullptr;
+
+	GLFWwindow *window;
+	bool enabled;
+	bool dirty = true; // o primeiro frame sempre é desenhado
+	bool animating = false;
+	int refreshRate = 60;
+
+	double reportStart = 0.0, reportCpu = 0.0, idleSeconds = 0.0;
+	uint64_t framesRendered = 0;
+
+	void report()
+	{
+		double now = glfwGetTime();
+		double elapsed = now - reportStart;
+		if (elapsed < REPORT_INTERVAL)
+			return;
+		double cpu = processCpuSeconds();
+		double continuous = elapsed * refreshRate;
+		std::cout << "Render sob demanda: " << framesRendered << " frames em " << (int)elapsed << " s ("
+				  << (int)(100.0 * std::max(1.0 - framesRendered / continuous, 0.0)) << "% poupados a " << refreshRate << " Hz), "
+				  << (int)(100.0 * idleSeconds / elapsed) << "% do tempo dormindo, CPU " << 100.0 * (cpu - reportCpu) / elapsed << "%" << std::endl;
+		reportStart = now;
+		reportCpu = cpu;
+		idleSeconds = 0.0;
+		framesRendered = 0;
+	}
+};
@@ -0,0 +1,82 @@
+/*
+ * SceneConvert - converte cenas entre JSON e o binário .scene (SceneSnapshot.h)
+ *
+ * Uso: SceneConvert <entrada.json|.scene> <saída.scene|.json> [opções]
+ *
+ * Opções:
+ *   --replicate N    replica os cubos em grade até N objetos (cenas grandes de teste)
+ *
+ * O formato é escolhido pela extensão; o .scene é lido pelo TriangleTex e pelo
+ * SoftRender sem parsing (o arquivo é mapeado na memória).
+ *
+ * Exemplo:
+ *   SceneConvert ../assets/cube.json cubos1M.scene --replicate 1000000
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <filesystem>
+
+#include "SceneSnapshot.h"
+
+using namespace std;
+
+typedef chrono::high_resolution_clock Clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+	return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 3)
+	{
+		cout << "Uso: SceneConvert <entrada.json|.scene> <saída.scene|.json> [--replicate N]\n";
+		return 1;
+	}
+
+	string inputPath = argv[1];
+	string outputPath = argv[2];
+	size_t replicate = 0;
+	for (int i = 3; i < argc; ++i)
+	{
+		string arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			cout << "Falta o valor de " << arg << endl;
+			return 1;
+		}
+		else if (arg == "--replicate")
+			replicate = stoul(argv[++i]);
+		else
+		{
+			cout << "Opção desconhecida: " << arg << endl;
+			return 1;
+		}
+	}
+
+	SceneDescription scene;
+	Clock::time_point start = Clock::now();
+	if (!loadSceneFile(inputPath, scene))
+		return 1;
+	double loadMs = elapsedMs(start);
+	replicateScene(scene, replicate);
+
+	start = Clock::now();
+	if (!saveSceneFile(outputPath, scene))
+	{
+		cout << "Erro ao gravar " << outputPath << endl;
+		return 1;
+	}
+	double saveMs = elapsedMs(start);
+
+	cout << fixed << setprecision(1)
+		 << "Entrada: " << inputPath << " (" << filesystem::file_size(inputPath) / 1024.0 << " KB, lida em " << loadMs << " ms)\n"
+		 << "Saída:   " << outputPath << " (" << filesystem::file_size(outputPath) / 1024.0 << " KB, gravada em " << saveMs << " ms)\n"
+		 << "Cena: " << scene.size() << " cubos, " << scene.texturePaths.size() << " texturas, " << scene.trajectoryCount()
+		 << " trajetórias, " << scene.lights.size() << " luzes" << endl;
+	return 0;
+}
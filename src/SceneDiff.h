@@ -0,0 +1,183 @@
+/*
+ * SceneDiff.h - diferença entre duas versões de uma cena, cubo a cubo pelo "id"
+ *
+ * Usada na recarga a quente do TriangleTex: quando o arquivo da cena muda, ele é
+ * lido de novo e comparado com a versão anterior; só os cubos acrescentados,
+ * removidos ou alterados (posição, escala, textura, material ou trajetória) são
+ * aplicados à cena viva. O custo é linear no número de cubos, sem tocar em GPU; os
+ * ids são indexados por um array quando cabem num intervalo compacto (o caso comum,
+ * 1..n) e por um unordered_map nos outros casos.
+ *
+ * Os ids precisam ser únicos; se não forem, não há como casar os cubos e a diferença
+ * troca todos (removed = a cena antiga inteira, added = a nova), com 'reliable' false.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "SceneLoader.h"
+
+struct SceneDiff
+{
+	std::vector<size_t> added;						 // índices na cena nova
+	std::vector<size_t> removed;					 // índices na cena antiga
+	std::vector<std::pair<size_t, size_t>> changed; // (antiga, nova)
+	size_t unchanged = 0;
+	bool lightsChanged = false; // "lights" ou "ambient"
+	bool reliable = true;		// false: ids repetidos
+
+	bool empty() const { return added.empty() && removed.empty() && changed.empty() && !lightsChanged; }
+};
+
+// id -> índice na cena
+class SceneIdIndex
+{
+public:
+	static constexpr size_t NONE = (size_t)-1;
+
+	// false se houver ids repetidos
+	bool build(const std::vector<int> &ids)
+	{
+		dense.clear();
+		sparse.clear();
+		if (ids.empty())
+			return true;
+		int minId = ids[0], maxId = ids[0];
+		for (int id : ids)
+		{
+			minId = std::min(minId, id);
+			maxId = std::max(maxId, id);
+		}
+
+		bool unique = true;
+		if ((int64_t)maxId - minId < (int64_t)ids.size() * 4 + 1024)
+		{
+			base = minId;
+			dense.assign((size_t)((int64_t)maxId - minId + 1), NONE);
+			for (size_t i = 0; i < ids.size(); ++i)
+			{
+				size_t &slot = dense[(size_t)(ids[i] - base)];
+				unique = unique && slot == NONE;
+				slot = i;
+			}
+			return unique;
+		}
+
+		sparse.reserve(ids.size());
+		for (size_t i = 0; i < ids.size(); ++i)
+			unique = sparse.emplace(ids[i], i).second && unique;
+		return unique;
+	}
+
+	size_t find(int id) const
+	{
+		if (!dense.empty())
+		{
+			int64_t offset = (int64_t)id - base;
+			return offset >= 0 && offset < (int64_t)dense.size() ? dense[(size_t)offset] : NONE;
+		}
+		auto it = sparse.find(id);
+		return it == sparse.end() ? NONE : it->second;
+	}
+
+private:
+	int base = 0;
+	std::vector<size_t> dense;
+	std::unordered_map<int, size_t> sparse;
+};
+
+inline bool sameMaterial(const SceneMaterial &a, const SceneMaterial &b)
+{
+	return a.fields == b.fields && a.color == b.color && a.specular == b.specular && a.shininess == b.shininess;
+}
+
+inline bool sameTrajectory(const SceneDescription &a, size_t i, const SceneDescription &b, size_t j)
+{
+	int32_t ta = a.trajectories[i], tb = b.trajectories[j];
+	if (ta < 0 || tb < 0)
+		return ta == tb;
+	uint32_t firstA = a.trajectoryStart[ta], countA = a.trajectoryStart[ta + 1] - firstA;
+	uint32_t firstB = b.trajectoryStart[tb], countB = b.trajectoryStart[tb + 1] - firstB;
+	if (countA != countB)
+		return false;
+	for (uint32_t w = 0; w < countA; ++w)
+	{
+		if (a.waypoints[firstA + w] != b.waypoints[firstB + w])
+			return false;
+	}
+	return true;
+}
+
+inline SceneDiff diffScenes(const SceneDescription &oldScene, const SceneDescription &newScene)
+{
+	SceneDiff diff;
+
+	// Os índices de textura são de cada arquivo: compara pelos caminhos
+	std::unordered_map<std::string, int32_t> newTextureIndex;
+	for (size_t t = 0; t < newScene.texturePaths.size(); ++t)
+		newTextureIndex[newScene.texturePaths[t]] = (int32_t)t;
+	std::vector<int32_t> textureRemap(oldScene.texturePaths.size(), -2); // -2: sumiu da cena nova
+	for (size_t t = 0; t < oldScene.texturePaths.size(); ++t)
+	{
+		auto it = newTextureIndex.find(oldScene.texturePaths[t]);
+		if (it != newTextureIndex.end())
+			textureRemap[t] = it->second;
+	}
+
+	SceneIdIndex oldIndex, newIndex;
+	bool oldUnique = oldIndex.build(oldScene.ids);
+	bool newUnique = newIndex.build(newScene.ids); // só para conferir a cena nova
+	diff.reliable = oldUnique && newUnique;
+
+	std::vector<bool> matched(oldScene.size(), false);
+	for (size_t j = 0; j < newScene.size(); ++j)
+	{
+		size_t i = oldIndex.find(newScene.ids[j]);
+		if (i == SceneIdIndex::NONE || matched[i])
+		{
+			diff.added.push_back(j);
+			continue;
+		}
+		matched[i] = true;
+
+		int32_t oldTexture = oldScene.textures[i] < 0 ? -1 : textureRemap[oldScene.textures[i]];
+		bool same = oldScene.positions[i] == newScene.positions[j] && oldScene.scales[i] == newScene.scales[j] &&
+					oldTexture == newScene.textures[j] && sameMaterial(oldScene.materials[i], newScene.materials[j]) &&
+					sameTrajectory(oldScene, i, newScene, j);
+		if (same)
+			diff.unchanged++;
+		else
+			diff.changed.push_back(std::make_pair(i, j));
+	}
+	for (size_t i = 0; i < oldScene.size(); ++i)
+	{
+		if (!matched[i])
+			diff.removed.push_back(i);
+	}
+
+	if (!diff.reliable)
+	{
+		diff.added.resize(newScene.size());
+		for (size_t j = 0; j < newScene.size(); ++j)
+			diff.added[j] = j;
+		diff.removed.resize(oldScene.size());
+		for (size_t i = 0; i < oldScene.size(); ++i)
+			diff.removed[i] = i;
+		diff.changed.clear();
+		diff.unchanged = 0;
+	}
+
+	diff.lightsChanged = oldScene.hasAmbient != newScene.hasAmbient || oldScene.ambient != newScene.ambient ||
+						 oldScene.lights.size() != newScene.lights.size();
+	for (size_t l = 0; !diff.lightsChanged && l < newScene.lights.size(); ++l)
+	{
+		const PointLight &a = oldScene.lights[l], &b = newScene.lights[l];
+		diff.lightsChanged = a.position != b.position || a.color != b.color || a.radius != b.radius;
+	}
+	return diff;
+}
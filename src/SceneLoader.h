@@ -0,0 +1,590 @@
+/*
+ * SceneLoader.h - leitura das cenas JSON do TriangleTex sem montar a árvore do JSON
+ *
+ * Formatos aceitos (os mesmos de sempre):
+ *   [ {cubo}, ... ]
+ *   {"cubes": [ {cubo}, ... ], "lights": [ {luz}, ... ], "ambient": [r, g, b]}
+ * com
+ *   cubo: {"id": n, "texture": "caminho", "initial_position": [x, y, z],
+ *          "scale": [x, y, z], "trajectory": [[x, y, z], ...],
+ *          "material": {"color": [r, g, b], "specular": ks, "shininess": q}}
+ *   luz:  ver Lights.h
+ * Só "initial_position" é obrigatório; chaves desconhecidas são ignoradas.
+ *
+ * loadSceneJSON usa a interface SAX do json.hpp: cada número é escrito direto nos
+ * arrays de componentes de SceneDescription, sem o DOM (que custa algumas centenas de
+ * bytes por cubo em nós, mapas e strings das chaves). loadSceneJSONDOM faz o mesmo
+ * com file >> json, como o TriangleTex fazia; fica como referência para o benchmark
+ * (Benchmarks scene) e para conferir os resultados. saveSceneJSON grava no mesmo
+ * formato (com o objeto raiz).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "json.hpp"
+#include "Lights.h"
+
+// Parâmetros de material presentes no JSON (os ausentes ficam com o padrão de quem usa)
+struct SceneMaterial
+{
+	enum Field : uint32_t
+	{
+		HAS_COLOR = 1,
+		HAS_SPECULAR = 2,
+		HAS_SHININESS = 4
+	};
+
+	glm::vec3 color = glm::vec3(1.0f);
+	float specular = 0.0f;
+	float shininess = 0.0f;
+	uint32_t fields = 0; // 32 bits: sem bytes de preenchimento (gravado direto no .scene)
+};
+
+// Cena em arrays paralelos, um elemento por cubo
+struct SceneDescription
+{
+	std::vector<int> ids;
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> scales;
+	std::vector<int32_t> textures; // índice em texturePaths, -1: sem textura
+	std::vector<SceneMaterial> materials;
+	std::vector<int32_t> trajectories; // índice em trajectoryStart, -1: parado
+
+	std::vector<std::string> texturePaths;	// sem repetição
+	std::vector<uint32_t> trajectoryStart; // trajetória t: waypoints[start[t], start[t + 1])
+	std::vector<glm::vec3> waypoints;
+
+	std::vector<PointLight> lights;
+	glm::vec3 ambient = glm::vec3(1.0f);
+	bool hasAmbient = false;
+
+	size_t size() const { return positions.size(); }
+	size_t trajectoryCount() const { return trajectoryStart.empty() ? 0 : trajectoryStart.size() - 1; }
+
+	void clear() { *this = SceneDescription(); }
+};
+
+namespace scene_detail
+{
+	// Acumula um cubo e o acrescenta aos arrays quando ele termina
+	struct SceneBuilder
+	{
+		SceneDescription &scene;
+		std::unordered_map<std::string, int32_t> textureIndex;
+
+		int id = 0;
+		glm::vec3 position = glm::vec3(0.0f), scale = glm::vec3(1.0f);
+		bool hasPosition = false;
+		int32_t texture = -1;
+		SceneMaterial material;
+		int32_t trajectory = -1;
+
+		explicit SceneBuilder(SceneDescription &s) : scene(s) { scene.clear(); }
+
+		void beginCube()
+		{
+			id = 0;
+			position = glm::vec3(0.0f);
+			scale = glm::vec3(1.0f);
+			hasPosition = false;
+			texture = -1;
+			material = SceneMaterial();
+			trajectory = -1;
+		}
+
+		void setTexture(const std::string &path)
+		{
+			if (path.empty())
+				return;
+			auto it = textureIndex.find(path);
+			if (it == textureIndex.end())
+			{
+				it = textureIndex.emplace(path, (int32_t)scene.texturePaths.size()).first;
+				scene.texturePaths.push_back(path);
+			}
+			texture = it->second;
+		}
+
+		// A trajetória começa na posição inicial, que pode vir depois no JSON: o
+		// primeiro waypoint é reservado e preenchido em endCube
+		void beginTrajectory()
+		{
+			if (scene.trajectoryStart.empty())
+				scene.trajectoryStart.push_back(0);
+			scene.waypoints.push_back(glm::vec3(0.0f));
+		}
+
+		void endTrajectory()
+		{
+			// Trajetória vazia: cubo parado
+			if (scene.waypoints.size() - scene.trajectoryStart.back() == 1)
+			{
+				scene.waypoints.pop_back();
+				return;
+			}
+			trajectory = (int32_t)scene.trajectoryCount();
+			scene.trajectoryStart.push_back((uint32_t)scene.waypoints.size());
+		}
+
+		bool endCube(std::string &error)
+		{
+			if (!hasPosition)
+			{
+				error = "cubo " + std::to_string(id) + " sem \"initial_position\"";
+				return false;
+			}
+			if (trajectory >= 0)
+				scene.waypoints[scene.trajectoryStart[trajectory]] = position;
+			scene.ids.push_back(id);
+			scene.positions.push_back(position);
+			scene.scales.push_back(scale);
+			scene.textures.push_back(texture);
+			scene.materials.push_back(material);
+			scene.trajectories.push_back(trajectory);
+			return true;
+		}
+	};
+
+	// Eventos SAX -> SceneBuilder. Cada objeto ou array aberto empilha o que ele
+	// representa; números e strings são interpretados pelo topo da pilha e pela chave.
+	class SceneSax : public nlohmann::json_sax<nlohmann::json>
+	{
+	public:
+		std::string error;
+
+		explicit SceneSax(SceneDescription &scene) : builder(scene) {}
+
+		bool null() override { return value(); }
+		bool boolean(bool) override { return value(); }
+		bool number_integer(number_integer_t v) override { return number((double)v); }
+		bool number_unsigned(number_unsigned_t v) override { return number((double)v); }
+		bool number_float(number_float_t v, const string_t &) override { return number(v); }
+		bool binary(binary_t &) override { return value(); }
+
+		bool string(string_t &v) override
+		{
+			if (top() == CUBE && currentKey == "texture")
+				builder.setTexture(v);
+			return value();
+		}
+
+		bool key(string_t &k) override
+		{
+			currentKey = k;
+			return true;
+		}
+
+		bool start_object(std::size_t) override
+		{
+			Context parent = top(), context = SKIP;
+			if (stack.empty())
+				context = ROOT;
+			else if (parent == CUBE_LIST)
+			{
+				context = CUBE;
+				builder.beginCube();
+			}
+			else if (parent == LIGHT_LIST)
+			{
+				context = LIGHT;
+				light = PointLight();
+				intensity = 1.0f;
+			}
+			else if (parent == CUBE && currentKey == "material")
+				context = MATERIAL;
+			push(context);
+			return true;
+		}
+
+		bool end_object() override
+		{
+			Context context = top();
+			stack.pop_back();
+			value();
+			if (context == CUBE)
+				return builder.endCube(error);
+			if (context == LIGHT)
+			{
+				light.color *= intensity;
+				builder.scene.lights.push_back(light);
+			}
+			return true;
+		}
+
+		bool start_array(std::size_t) override
+		{
+			Context parent = top(), context = SKIP;
+			float *target = nullptr;
+			if (stack.empty())
+				context = CUBE_LIST; // formato original: só a lista de cubos
+			else if (parent == ROOT)
+			{
+				if (currentKey == "cubes")
+					context = CUBE_LIST;
+				else if (currentKey == "lights")
+					context = LIGHT_LIST;
+				else if (currentKey == "ambient")
+				{
+					target = &builder.scene.ambient.x;
+					builder.scene.hasAmbient = true;
+				}
+			}
+			else if (parent == CUBE)
+			{
+				if (currentKey == "initial_position")
+				{
+					target = &builder.position.x;
+					builder.hasPosition = true;
+				}
+				else if (currentKey == "scale")
+					target = &builder.scale.x;
+				else if (currentKey == "trajectory")
+				{
+					context = TRAJECTORY;
+					builder.beginTrajectory();
+				}
+			}
+			else if (parent == TRAJECTORY)
+			{
+				builder.scene.waypoints.push_back(glm::vec3(0.0f));
+				target = &builder.scene.waypoints.back().x;
+			}
+			else if (parent == MATERIAL && currentKey == "color")
+			{
+				target = &builder.material.color.x;
+				builder.material.fields |= SceneMaterial::HAS_COLOR;
+			}
+			else if (parent == LIGHT && currentKey == "position")
+				target = &light.position.x;
+			else if (parent == LIGHT && currentKey == "color")
+				target = &light.color.x;
+
+			push(target ? VECTOR : context, target);
+			return true;
+		}
+
+		bool end_array() override
+		{
+			Context context = top();
+			stack.pop_back();
+			value();
+			if (context == TRAJECTORY)
+				builder.endTrajectory();
+			return true;
+		}
+
+		bool parse_error(std::size_t position, const std::string &, const nlohmann::detail::exception &e) override
+		{
+			error = "posição " + std::to_string(position) + ": " + e.what();
+			return false;
+		}
+
+	private:
+		enum Context
+		{
+			ROOT,
+			CUBE_LIST,
+			CUBE,
+			MATERIAL,
+			TRAJECTORY,
+			LIGHT_LIST,
+			LIGHT,
+			VECTOR, // [x, y, z] escrito em 'target'
+			SKIP	// chave desconhecida (e tudo dentro dela)
+		};
+
+		struct Frame
+		{
+			Context context;
+			float *target;
+			int index;
+		};
+
+		SceneBuilder builder;
+		std::vector<Frame> stack;
+		std::string currentKey;
+		PointLight light;
+		float intensity = 1.0f;
+
+		Context top() const { return stack.empty() ? ROOT : stack.back().context; }
+
+		void push(Context context, float *target = nullptr)
+		{
+			// Dentro de uma chave ignorada tudo é ignorado
+			if (!stack.empty() && stack.back().context == SKIP)
+				context = SKIP;
+			stack.push_back(Frame{context, target, 0});
+		}
+
+		// Um valor consumido: a chave não vale para o próximo
+		bool value()
+		{
+			currentKey.clear();
+			return true;
+		}
+
+		bool number(double v)
+		{
+			Context context = top();
+			if (context == VECTOR)
+			{
+				Frame &f = stack.back();
+				if (f.index < 3)
+					f.target[f.index++] = (float)v;
+			}
+			else if (context == CUBE && currentKey == "id")
+				builder.id = (int)v;
+			else if (context == MATERIAL && currentKey == "specular")
+			{
+				builder.material.specular = (float)v;
+				builder.material.fields |= SceneMaterial::HAS_SPECULAR;
+			}
+			else if (context == MATERIAL && currentKey == "shininess")
+			{
+				builder.material.shininess = (float)v;
+				builder.material.fields |= SceneMaterial::HAS_SHININESS;
+			}
+			else if (context == LIGHT && currentKey == "intensity")
+				intensity = (float)v;
+			else if (context == LIGHT && currentKey == "radius")
+				light.radius = (float)v;
+			return value();
+		}
+	};
+}
+
+inline bool loadSceneJSON(const std::string &path, SceneDescription &scene)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "Erro ao abrir arquivo JSON: " << path << std::endl;
+		return false;
+	}
+
+	scene_detail::SceneSax sax(scene);
+	if (!nlohmann::json::sax_parse(file, &sax) || !sax.error.empty())
+	{
+		std::cout << "Erro em " << path << ": " << sax.error << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Mesma leitura com o DOM do json.hpp (file >> j), para comparação
+inline bool loadSceneJSONDOM(const std::string &path, SceneDescription &scene)
+{
+	using json = nlohmann::json;
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "Erro ao abrir arquivo JSON: " << path << std::endl;
+		return false;
+	}
+
+	json j;
+	try
+	{
+		file >> j;
+	}
+	catch (const json::exception &e)
+	{
+		std::cout << "Erro em " << path << ": " << e.what() << std::endl;
+		return false;
+	}
+
+	auto toVec3 = [](const json &a)
+	{ return glm::vec3(a[0].get<float>(), a[1].get<float>(), a[2].get<float>()); };
+
+	scene_detail::SceneBuilder builder(scene);
+	const json &cubeList = j.is_object() ? j["cubes"] : j;
+	if (j.is_object())
+	{
+		if (j.contains("ambient"))
+		{
+			scene.ambient = toVec3(j["ambient"]);
+			scene.hasAmbient = true;
+		}
+		for (const auto &l : j.value("lights", json::array()))
+		{
+			PointLight light;
+			light.position = toVec3(l["position"]);
+			if (l.contains("color"))
+				light.color = toVec3(l["color"]);
+			light.color *= l.value("intensity", 1.0f);
+			light.radius = l.value("radius", light.radius);
+			scene.lights.push_back(light);
+		}
+	}
+
+	std::string error;
+	for (const auto &c : cubeList)
+	{
+		builder.beginCube();
+		builder.id = c.value("id", 0);
+		builder.setTexture(c.value("texture", ""));
+		if (c.contains("initial_position"))
+		{
+			builder.position = toVec3(c["initial_position"]);
+			builder.hasPosition = true;
+		}
+		if (c.contains("scale"))
+			builder.scale = toVec3(c["scale"]);
+		if (c.contains("trajectory"))
+		{
+			builder.beginTrajectory();
+			for (const auto &p : c["trajectory"])
+				scene.waypoints.push_back(toVec3(p));
+			builder.endTrajectory();
+		}
+		if (c.contains("material"))
+		{
+			const json &m = c["material"];
+			SceneMaterial &material = builder.material;
+			if (m.contains("color"))
+			{
+				material.color = toVec3(m["color"]);
+				material.fields |= SceneMaterial::HAS_COLOR;
+			}
+			if (m.contains("specular"))
+			{
+				material.specular = m["specular"];
+				material.fields |= SceneMaterial::HAS_SPECULAR;
+			}
+			if (m.contains("shininess"))
+			{
+				material.shininess = m["shininess"];
+				material.fields |= SceneMaterial::HAS_SHININESS;
+			}
+		}
+		if (!builder.endCube(error))
+		{
+			std::cout << "Erro em " << path << ": " << error << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+inline bool saveSceneJSON(const std::string &path, const SceneDescription &scene)
+{
+	std::ofstream out(path);
+	if (!out.is_open())
+	{
+		std::cout << "Erro ao criar arquivo: " << path << std::endl;
+		return false;
+	}
+
+	out << std::setprecision(9); // floats voltam idênticos na leitura
+	auto writeVec3 = [&out](const glm::vec3 &v)
+	{ out << "[" << v.x << ", " << v.y << ", " << v.z << "]"; };
+	auto writeString = [&out](const std::string &s)
+	{ out << nlohmann::json(s).dump(); }; // com escapes
+
+	out << "{\n";
+	if (scene.hasAmbient)
+	{
+		out << "  \"ambient\": ";
+		writeVec3(scene.ambient);
+		out << ",\n";
+	}
+	out << "  \"lights\": [";
+	for (size_t i = 0; i < scene.lights.size(); ++i)
+	{
+		// A cor já inclui a intensidade
+		out << (i ? ",\n    " : "\n    ") << "{\"position\": ";
+		writeVec3(scene.lights[i].position);
+		out << ", \"color\": ";
+		writeVec3(scene.lights[i].color);
+		out << ", \"radius\": " << scene.lights[i].radius << "}";
+	}
+	out << "],\n  \"cubes\": [";
+	for (size_t i = 0; i < scene.size(); ++i)
+	{
+		out << (i ? ",\n    " : "\n    ") << "{\"id\": " << scene.ids[i];
+		if (scene.textures[i] >= 0)
+		{
+			out << ", \"texture\": ";
+			writeString(scene.texturePaths[scene.textures[i]]);
+		}
+		out << ", \"initial_position\": ";
+		writeVec3(scene.positions[i]);
+		if (scene.scales[i] != glm::vec3(1.0f))
+		{
+			out << ", \"scale\": ";
+			writeVec3(scene.scales[i]);
+		}
+
+		const SceneMaterial &m = scene.materials[i];
+		if (m.fields)
+		{
+			const char *separator = "";
+			out << ", \"material\": {";
+			if (m.fields & SceneMaterial::HAS_COLOR)
+			{
+				out << "\"color\": ";
+				writeVec3(m.color);
+				separator = ", ";
+			}
+			if (m.fields & SceneMaterial::HAS_SPECULAR)
+			{
+				out << separator << "\"specular\": " << m.specular;
+				separator = ", ";
+			}
+			if (m.fields & SceneMaterial::HAS_SHININESS)
+				out << separator << "\"shininess\": " << m.shininess;
+			out << "}";
+		}
+
+		// O primeiro waypoint é a posição inicial
+		out << ", \"trajectory\": [";
+		if (scene.trajectories[i] >= 0)
+		{
+			uint32_t first = scene.trajectoryStart[scene.trajectories[i]], end = scene.trajectoryStart[scene.trajectories[i] + 1];
+			for (uint32_t w = first + 1; w < end; ++w)
+			{
+				out << (w > first + 1 ? ", " : "");
+				writeVec3(scene.waypoints[w]);
+			}
+		}
+		out << "]}";
+	}
+	out << "\n  ]\n}\n";
+	return out.good();
+}
+
+// Replica os cubos em grade até 'count' (como o --stress dos exercícios); as cópias
+// mantêm textura, escala e material do original, com ids novos e sem trajetória
+inline void replicateScene(SceneDescription &scene, size_t count)
+{
+	size_t original = scene.size();
+	if (original == 0 || count <= original)
+		return;
+	int nextId = 0;
+	for (int id : scene.ids)
+		nextId = std::max(nextId, id + 1);
+
+	size_t side = (size_t)std::ceil(std::cbrt((double)count));
+	for (size_t i = original; i < count; ++i)
+	{
+		size_t source = i % original;
+		scene.ids.push_back(nextId++);
+		scene.positions.push_back(glm::vec3((float)(i % side), (float)((i / side) % side), -(float)(i / (side * side))) * 2.0f - glm::vec3((float)side, (float)side, 5.0f));
+		scene.scales.push_back(scene.scales[source]);
+		scene.textures.push_back(scene.textures[source]);
+		scene.materials.push_back(scene.materials[source]);
+		scene.trajectories.push_back(-1);
+	}
+}
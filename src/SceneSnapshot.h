@@ -0,0 +1,417 @@
+/*
+ * SceneSnapshot.h - cena em formato binário (.scene), mapeada na memória sem parsing
+ *
+ * O arquivo é uma cópia dos arrays de SceneDescription (SceneLoader.h):
+ *   SceneFileHeader                    contagens, luz ambiente e o offset de cada seção
+ *   int32  ids[objectCount]
+ *   vec3   positions[objectCount]
+ *   vec3   scales[objectCount]
+ *   int32  textures[objectCount]       índice na tabela de strings, -1: sem textura
+ *   SceneMaterial materials[objectCount]
+ *   int32  trajectories[objectCount]   -1: parado
+ *   uint32 trajectoryStart[trajectoryCount + 1]
+ *   vec3   waypoints[waypointCount]
+ *   PointLight lights[lightCount]
+ *   uint32 stringOffsets[textureCount + 1]   tabela de strings: caminhos das texturas
+ *   char   strings[stringBytes]               (sem '\0', delimitados pelos offsets)
+ * Cada seção começa num múltiplo de 16 bytes; little-endian, floats IEEE 754.
+ *
+ * SceneSnapshot::open mapeia o arquivo (mmap / MapViewOfFile) e aponta cada array
+ * direto para as páginas do arquivo: abrir custa só a validação dos índices, e as
+ * páginas são lidas do disco (ou do cache do sistema) quando usadas.
+ * toDescription copia para os vectors de SceneDescription, para quem precisa editar.
+ *
+ * loadSceneFile / saveSceneFile escolhem o formato pela extensão (.scene ou JSON),
+ * como loadMeshFile faz com as malhas.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <glm/glm.hpp>
+
+#include "Lights.h"
+#include "MeshIO.h"
+#include "SceneLoader.h"
+
+// Os arrays são gravados como estão na memória
+static_assert(sizeof(glm::vec3) == 12, "vec3 com preenchimento");
+static_assert(sizeof(SceneMaterial) == 24, "SceneMaterial com preenchimento");
+static_assert(sizeof(PointLight) == 28, "PointLight com preenchimento");
+
+enum SceneSection
+{
+	SECTION_IDS,
+	SECTION_POSITIONS,
+	SECTION_SCALES,
+	SECTION_TEXTURES,
+	SECTION_MATERIALS,
+	SECTION_TRAJECTORIES,
+	SECTION_TRAJECTORY_START,
+	SECTION_WAYPOINTS,
+	SECTION_LIGHTS,
+	SECTION_STRING_OFFSETS,
+	SECTION_STRINGS,
+	SECTION_COUNT
+};
+
+struct SceneFileHeader
+{
+	char magic[4];	  // "CGSC"
+	uint32_t version; // SCENE_FILE_VERSION
+	uint32_t objectCount;
+	uint32_t trajectoryCount;
+	uint32_t waypointCount;
+	uint32_t lightCount;
+	uint32_t textureCount;
+	uint32_t stringBytes;
+	float ambient[3];
+	uint32_t hasAmbient;
+	uint64_t sectionOffset[SECTION_COUNT];
+};
+
+const uint32_t SCENE_FILE_VERSION = 1;
+
+// Tamanho em bytes de cada seção a partir das contagens do cabeçalho
+inline uint64_t sceneSectionSize(const SceneFileHeader &h, int section)
+{
+	switch (section)
+	{
+	case SECTION_IDS:
+	case SECTION_TEXTURES:
+	case SECTION_TRAJECTORIES:
+		return (uint64_t)h.objectCount * sizeof(int32_t);
+	case SECTION_POSITIONS:
+	case SECTION_SCALES:
+		return (uint64_t)h.objectCount * sizeof(glm::vec3);
+	case SECTION_MATERIALS:
+		return (uint64_t)h.objectCount * sizeof(SceneMaterial);
+	case SECTION_TRAJECTORY_START:
+		return ((uint64_t)h.trajectoryCount + 1) * sizeof(uint32_t);
+	case SECTION_WAYPOINTS:
+		return (uint64_t)h.waypointCount * sizeof(glm::vec3);
+	case SECTION_LIGHTS:
+		return (uint64_t)h.lightCount * sizeof(PointLight);
+	case SECTION_STRING_OFFSETS:
+		return ((uint64_t)h.textureCount + 1) * sizeof(uint32_t);
+	default:
+		return h.stringBytes;
+	}
+}
+
+inline bool writeSceneBinary(const std::string &path, const SceneDescription &scene)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "Erro ao criar arquivo: " << path << std::endl;
+		return false;
+	}
+
+	std::vector<uint32_t> trajectoryStart = scene.trajectoryStart;
+	if (trajectoryStart.empty())
+		trajectoryStart.push_back(0);
+	std::vector<uint32_t> stringOffsets = {0};
+	std::string strings;
+	for (const std::string &s : scene.texturePaths)
+	{
+		strings += s;
+		stringOffsets.push_back((uint32_t)strings.size());
+	}
+
+	SceneFileHeader header = {};
+	std::memcpy(header.magic, "CGSC", 4);
+	header.version = SCENE_FILE_VERSION;
+	header.objectCount = (uint32_t)scene.size();
+	header.trajectoryCount = (uint32_t)trajectoryStart.size() - 1;
+	header.waypointCount = (uint32_t)scene.waypoints.size();
+	header.lightCount = (uint32_t)scene.lights.size();
+	header.textureCount = (uint32_t)scene.texturePaths.size();
+	header.stringBytes = (uint32_t)strings.size();
+	header.ambient[0] = scene.ambient.x;
+	header.ambient[1] = scene.ambient.y;
+	header.ambient[2] = scene.ambient.z;
+	header.hasAmbient = scene.hasAmbient ? 1 : 0;
+
+	const void *data[SECTION_COUNT] = {scene.ids.data(), scene.positions.data(), scene.scales.data(), scene.textures.data(),
+									   scene.materials.data(), scene.trajectories.data(), trajectoryStart.data(), scene.waypoints.data(),
+									   scene.lights.data(), stringOffsets.data(), strings.data()};
+	uint64_t offset = sizeof(SceneFileHeader);
+	for (int s = 0; s < SECTION_COUNT; ++s)
+	{
+		offset = (offset + 15) & ~(uint64_t)15;
+		header.sectionOffset[s] = offset;
+		offset += sceneSectionSize(header, s);
+	}
+
+	file.write((const char *)&header, sizeof(header));
+	uint64_t position = sizeof(SceneFileHeader);
+	const char padding[16] = {};
+	for (int s = 0; s < SECTION_COUNT; ++s)
+	{
+		file.write(padding, header.sectionOffset[s] - position);
+		file.write((const char *)data[s], sceneSectionSize(header, s));
+		position = header.sectionOffset[s] + sceneSectionSize(header, s);
+	}
+	return file.good();
+}
+
+// Arquivo inteiro mapeado só para leitura
+class MappedFile
+{
+public:
+	MappedFile() {}
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	bool open(const std::string &path)
+	{
+		close();
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			close();
+			return false;
+		}
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping)
+			bytes = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		length = (size_t)fileSize.QuadPart;
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat info;
+		if (fstat(fd, &info) == 0 && info.st_size > 0)
+		{
+			void *address = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (address != MAP_FAILED)
+			{
+				bytes = (const uint8_t *)address;
+				length = (size_t)info.st_size;
+			}
+		}
+		::close(fd); // o mapeamento continua válido sem o descritor
+#endif
+		if (!bytes)
+		{
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void close()
+	{
+#ifdef _WIN32
+		if (bytes)
+			UnmapViewOfFile(bytes);
+		if (mapping)
+			CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (bytes)
+			munmap((void *)bytes, length);
+#endif
+		bytes = nullptr;
+		length = 0;
+	}
+
+	const uint8_t *data() const { return bytes; }
+	size_t size() const { return length; }
+
+private:
+	const uint8_t *bytes = nullptr;
+	size_t length = 0;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#endif
+};
+
+// Cena .scene aberta: os ponteiros apontam para o arquivo mapeado e valem até close()
+class SceneSnapshot
+{
+public:
+	const SceneFileHeader *header = nullptr;
+	const int32_t *ids = nullptr;
+	const glm::vec3 *positions = nullptr;
+	const glm::vec3 *scales = nullptr;
+	const int32_t *textures = nullptr;
+	const SceneMaterial *materials = nullptr;
+	const int32_t *trajectories = nullptr;
+	const uint32_t *trajectoryStart = nullptr;
+	const glm::vec3 *waypoints = nullptr;
+	const PointLight *lights = nullptr;
+
+	SceneSnapshot() {}
+
+	SceneSnapshot(const SceneSnapshot &) = delete;
+	SceneSnapshot &operator=(const SceneSnapshot &) = delete;
+
+	bool open(const std::string &path)
+	{
+		close();
+		if (!file.open(path))
+		{
+			std::cout << "Erro ao abrir arquivo: " << path << std::endl;
+			return false;
+		}
+		if (!validate())
+		{
+			std::cout << "Arquivo de cena inválido: " << path << std::endl;
+			close();
+			return false;
+		}
+
+		const uint8_t *base = file.data();
+		ids = (const int32_t *)(base + header->sectionOffset[SECTION_IDS]);
+		positions = (const glm::vec3 *)(base + header->sectionOffset[SECTION_POSITIONS]);
+		scales = (const glm::vec3 *)(base + header->sectionOffset[SECTION_SCALES]);
+		textures = (const int32_t *)(base + header->sectionOffset[SECTION_TEXTURES]);
+		materials = (const SceneMaterial *)(base + header->sectionOffset[SECTION_MATERIALS]);
+		trajectories = (const int32_t *)(base + header->sectionOffset[SECTION_TRAJECTORIES]);
+		trajectoryStart = (const uint32_t *)(base + header->sectionOffset[SECTION_TRAJECTORY_START]);
+		waypoints = (const glm::vec3 *)(base + header->sectionOffset[SECTION_WAYPOINTS]);
+		lights = (const PointLight *)(base + header->sectionOffset[SECTION_LIGHTS]);
+		return true;
+	}
+
+	void close()
+	{
+		file.close();
+		header = nullptr;
+	}
+
+	size_t size() const { return header ? header->objectCount : 0; }
+	size_t textureCount() const { return header ? header->textureCount : 0; }
+
+	std::string texturePath(size_t i) const
+	{
+		const uint32_t *offsets = (const uint32_t *)(file.data() + header->sectionOffset[SECTION_STRING_OFFSETS]);
+		const char *strings = (const char *)(file.data() + header->sectionOffset[SECTION_STRINGS]);
+		return std::string(strings + offsets[i], offsets[i + 1] - offsets[i]);
+	}
+
+	// Cópia para vectors (um memcpy por array)
+	void toDescription(SceneDescription &scene) const
+	{
+		scene.clear();
+		size_t n = size();
+		scene.ids.assign(ids, ids + n);
+		scene.positions.assign(positions, positions + n);
+		scene.scales.assign(scales, scales + n);
+		scene.textures.assign(textures, textures + n);
+		scene.materials.assign(materials, materials + n);
+		scene.trajectories.assign(trajectories, trajectories + n);
+		if (header->trajectoryCount > 0)
+			scene.trajectoryStart.assign(trajectoryStart, trajectoryStart + header->trajectoryCount + 1);
+		scene.waypoints.assign(waypoints, waypoints + header->waypointCount);
+		scene.lights.assign(lights, lights + header->lightCount);
+		for (size_t t = 0; t < textureCount(); ++t)
+			scene.texturePaths.push_back(texturePath(t));
+		scene.ambient = glm::vec3(header->ambient[0], header->ambient[1], header->ambient[2]);
+		scene.hasAmbient = header->hasAmbient != 0;
+	}
+
+private:
+	MappedFile file;
+
+	// Seções dentro do arquivo e índices dentro dos arrays: um arquivo corrompido não
+	// pode fazer quem usa a cena ler fora do mapeamento
+	bool validate()
+	{
+		if (file.size() < sizeof(SceneFileHeader))
+			return false;
+		header = (const SceneFileHeader *)file.data();
+		if (std::memcmp(header->magic, "CGSC", 4) != 0 || header->version != SCENE_FILE_VERSION)
+			return false;
+		for (int s = 0; s < SECTION_COUNT; ++s)
+		{
+			uint64_t offset = header->sectionOffset[s];
+			if (offset % 16 != 0 || offset < sizeof(SceneFileHeader) || offset > file.size() || sceneSectionSize(*header, s) > file.size() - offset)
+				return false;
+		}
+
+		const uint8_t *base = file.data();
+		const uint32_t *start = (const uint32_t *)(base + header->sectionOffset[SECTION_TRAJECTORY_START]);
+		for (uint32_t t = 0; t < header->trajectoryCount; ++t)
+		{
+			if (start[t] >= start[t + 1])
+				return false;
+		}
+		if (start[0] != 0 || start[header->trajectoryCount] != header->waypointCount)
+			return false;
+
+		const uint32_t *offsets = (const uint32_t *)(base + header->sectionOffset[SECTION_STRING_OFFSETS]);
+		for (uint32_t t = 0; t < header->textureCount; ++t)
+		{
+			if (offsets[t] > offsets[t + 1])
+				return false;
+		}
+		if (offsets[0] != 0 || offsets[header->textureCount] != header->stringBytes)
+			return false;
+
+		const int32_t *tex = (const int32_t *)(base + header->sectionOffset[SECTION_TEXTURES]);
+		const int32_t *traj = (const int32_t *)(base + header->sectionOffset[SECTION_TRAJECTORIES]);
+		for (uint32_t i = 0; i < header->objectCount; ++i)
+		{
+			if (tex[i] < -1 || tex[i] >= (int32_t)header->textureCount || traj[i] < -1 || traj[i] >= (int32_t)header->trajectoryCount)
+				return false;
+		}
+		return true;
+	}
+};
+
+inline bool readSceneBinary(const std::string &path, SceneDescription &scene)
+{
+	SceneSnapshot snapshot;
+	if (!snapshot.open(path))
+		return false;
+	snapshot.toDescription(scene);
+	return true;
+}
+
+inline bool loadSceneFile(const std::string &path, SceneDescription &scene)
+{
+	if (hasExtension(path, ".scene"))
+		return readSceneBinary(path, scene);
+	return loadSceneJSON(path, scene);
+}
+
+inline bool saveSceneFile(const std::string &path, const SceneDescription &scene)
+{
+	if (hasExtension(path, ".scene"))
+		return writeSceneBinary(path, scene);
+	return saveSceneJSON(path, scene);
+}
@@ -0,0 +1,618 @@
+/*
+ * ShaderManager.h - carregamento de shaders de arquivos com cache de programas
+ *
+ * Os shaders ficam em assets/shaders/ (um arquivo por estágio). Antes de compilar,
+ * o código passa por um pré-processamento mínimo:
+ *  - '#include "arquivo"' é substituído pelo conteúdo do arquivo (relativo à pasta)
+ *  - as defines pedidas são inseridas logo após a linha #version
+ * Os arquivos ficam em ASCII (comentários sem acentos): alguns drivers recusam
+ * outros caracteres mesmo dentro de comentários.
+ * loadCompute() faz o mesmo para programas de um único compute shader.
+ *
+ * Cada programa é identificado por um hash (FNV-1a de 64 bits) das fontes já
+ * pré-processadas e do driver (GL_RENDERER + GL_VERSION). Pedidos repetidos devolvem
+ * o mesmo programa, e, se o driver tem ARB_get_program_binary, o binário linkado é
+ * gravado em disco (pasta de cache) e reaproveitado na próxima execução com
+ * glProgramBinary, sem compilar. Se o driver recusar o binário (atualização, outra
+ * GPU), o programa é compilado de novo e o cache é regravado.
+ *
+ * Recarga a quente: depois de enableHotReload(), update() (uma vez por frame) observa
+ * a pasta de shaders (FileWatcher.h) e recompila os programas cujos arquivos, ou
+ * includes, mudaram. Com KHR_parallel_shader_compile a compilação e o link são
+ * disparados de uma vez e o driver os executa em threads próprias; update() apenas
+ * consulta GL_COMPLETION_STATUS_KHR. Sem a extensão, cada etapa (vertex, fragment,
+ * link) roda em um frame diferente, para diluir o custo. O programa novo só
+ * substitui o antigo se compilar e linkar; senão o erro é mostrado e o antigo fica.
+ *
+ * Uso (depois de glext::load()):
+ *   ShaderManager shaders;
+ *   GLuint program = shaders.load("hello3d.vert", "hello3d.frag");
+ *   shaders.enableHotReload();
+ *   ...
+ *   if (shaders.update()) // algum programa foi trocado: buscar o id novo
+ *       program = shaders.load("hello3d.vert", "hello3d.frag");
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "GLExtensions.h"
+#include "FileWatcher.h"
+
+class ShaderManager
+{
+public:
+	struct Stats
+	{
+		int compiled = 0;		 // programas compilados a partir das fontes
+		int cacheHits = 0;		 // programas carregados do binário em disco
+		int cacheRejected = 0; // binários recusados pelo driver
+		int reloads = 0;		 // programas trocados pela recarga a quente
+		double compileMs = 0.0;
+		double cacheMs = 0.0;
+	};
+
+	explicit ShaderManager(const std::string &shaderDir = "../assets/shaders/", const std::string &cacheDir = "shader_cache/")
+		: shaderDir(shaderDir), cacheDir(cacheDir) {}
+
+	ShaderManager(const ShaderManager &) = delete;
+	ShaderManager &operator=(const ShaderManager &) = delete;
+
+	// Desliga a leitura e a gravação dos binários (o cache em memória continua)
+	void setBinaryCache(bool enabled) { binaryCache = enabled; }
+
+	// Carrega, pré-processa e linka o par de shaders; retorna 0 em caso de erro.
+	// Pedidos repetidos devolvem o programa atual (o mais recente, após recargas).
+	GLuint load(const std::string &vertexFile, const std::string &fragmentFile, const std::vector<std::string> &defines = {})
+	{
+		std::string name = vertexFile + " + " + fragmentFile;
+		for (const std::string &define : defines)
+			name += " [" + define + "]";
+		auto it = entries.find(name);
+		if (it != entries.end())
+			return it->second.program;
+
+		Entry entry;
+		entry.vertexFile = vertexFile;
+		entry.fragmentFile = fragmentFile;
+		entry.defines = defines;
+		std::string vertexSource, fragmentSource;
+		if (!preprocess(vertexFile, defines, vertexSource, 0, &entry.files) || !preprocess(fragmentFile, defines, fragmentSource, 0, &entry.files))
+			return 0;
+		entry.program = build(name, vertexSource, fragmentSource);
+		if (entry.program)
+			entries[name] = entry;
+		return entry.program;
+	}
+
+	// Programa de compute shader (requer glext::hasComputeShader); mesmo cache e
+	// recarga a quente de load()
+	GLuint loadCompute(const std::string &computeFile, const std::vector<std::string> &defines = {})
+	{
+		std::string name = computeFile;
+		for (const std::string &define : defines)
+			name += " [" + define + "]";
+		auto it = entries.find(name);
+		if (it != entries.end())
+			return it->second.program;
+
+		Entry entry;
+		entry.vertexFile = computeFile;
+		entry.defines = defines;
+		std::string computeSource;
+		if (!preprocess(computeFile, defines, computeSource, 0, &entry.files))
+			return 0;
+		entry.program = build(name, computeSource, "");
+		if (entry.program)
+			entries[name] = entry;
+		return entry.program;
+	}
+
+	// Passa a observar a pasta de shaders; as trocas acontecem em update()
+	bool enableHotReload()
+	{
+		if (!watcher.watch(shaderDir))
+		{
+			std::cout << "Recarga de shaders indisponível: não foi possível observar " << shaderDir << std::endl;
+			return false;
+		}
+		if (glext::hasParallelShaderCompile)
+			glext::glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu); // o driver escolhe o número de threads
+		std::cout << "Recarga de shaders ativa em " << shaderDir << (glext::hasParallelShaderCompile ? " (compilação paralela do driver)" : " (uma etapa por frame)") << std::endl;
+		return true;
+	}
+
+	// Chamada uma vez por frame; retorna true se algum programa foi substituído
+	bool update()
+	{
+		for (const std::string &file : watcher.poll())
+		{
+			for (auto &entry : entries)
+			{
+				if (entry.second.files.count(file))
+					startReload(entry.first, entry.second);
+			}
+		}
+
+		bool swapped = false;
+		for (auto &entry : entries)
+		{
+			if (entry.second.pending.program && advanceReload(entry.first, entry.second))
+				swapped = true;
+		}
+		return swapped;
+	}
+
+	// Alguma recarga em andamento: ela só avança nas chamadas a update(), então o
+	// loop não deve dormir esperando eventos (ver RenderOnDemand.h)
+	bool reloadPending() const
+	{
+		for (const auto &entry : entries)
+		{
+			if (entry.second.pending.program)
+				return true;
+		}
+		return false;
+	}
+
+	// Linka fontes já prontas (sem pré-processamento), com o mesmo cache de load().
+	// Sem fragment shader, 'vertexSource' é a fonte de um compute shader.
+	GLuint build(const std::string &name, const std::string &vertexSource, const std::string &fragmentSource)
+	{
+		uint64_t key = programKey(vertexSource, fragmentSource);
+		auto it = programs.find(key);
+		if (it != programs.end())
+			return it->second;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		GLuint program = binaryCache && glext::hasProgramBinary ? loadBinary(key) : 0;
+		if (program)
+		{
+			double ms = elapsedMs(start);
+			statistics.cacheHits++;
+			statistics.cacheMs += ms;
+			std::cout << "Shader " << name << ": cache (" << ms << " ms)" << std::endl;
+		}
+		else
+		{
+			program = compile(name, vertexSource, fragmentSource);
+			if (!program)
+				return 0;
+			double ms = elapsedMs(start);
+			statistics.compiled++;
+			statistics.compileMs += ms;
+			std::cout << "Shader " << name << ": compilado (" << ms << " ms)" << std::endl;
+			if (binaryCache && glext::hasProgramBinary)
+				saveBinary(key, program);
+		}
+		programs[key] = program;
+		return program;
+	}
+
+	// Libera todos os programas criados (requer o contexto ainda ativo)
+	void release()
+	{
+		for (auto &entry : entries)
+			cancelReload(entry.second);
+		for (auto &entry : programs)
+			glDeleteProgram(entry.second);
+		programs.clear();
+		entries.clear();
+	}
+
+	const Stats &stats() const { return statistics; }
+
+	void printStats() const
+	{
+		std::cout << "Shaders: " << statistics.compiled << " compilados (" << statistics.compileMs << " ms), "
+				  << statistics.cacheHits << " do cache (" << statistics.cacheMs << " ms)";
+		if (statistics.cacheRejected > 0)
+			std::cout << ", " << statistics.cacheRejected << " binários recusados";
+		if (statistics.reloads > 0)
+			std::cout << ", " << statistics.reloads << " recargas";
+		if (!glext::hasProgramBinary)
+			std::cout << " [driver sem ARB_get_program_binary]";
+		std::cout << std::endl;
+	}
+
+	static uint64_t hash(const std::string &data, uint64_t h = 14695981039346656037ull)
+	{
+		for (unsigned char c : data)
+		{
+			h ^= c;
+			h *= 1099511628211ull;
+		}
+		return h;
+	}
+
+	// Lê 'file' da pasta de shaders, expande #include e insere as defines após #version.
+	// 'files' recebe o arquivo e todos os seus includes (usados pela recarga a quente).
+	bool preprocess(const std::string &file, const std::vector<std::string> &defines, std::string &out, int depth, std::set<std::string> *files = nullptr) const
+	{
+		if (files)
+			files->insert(file);
+		std::ifstream in(shaderDir + file);
+		if (!in.is_open())
+		{
+			std::cout << "Erro ao abrir shader: " << shaderDir + file << std::endl;
+			return false;
+		}
+		if (depth > 8)
+		{
+			std::cout << "Includes aninhados demais em " << file << std::endl;
+			return false;
+		}
+
+		std::string line;
+		int lineNumber = 0;
+		while (std::getline(in, line))
+		{
+			++lineNumber;
+			size_t first = line.find_first_not_of(" \t");
+			if (first != std::string::npos && line.compare(first, 8, "#include") == 0)
+			{
+				size_t open = line.find('"', first);
+				size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+				if (close == std::string::npos)
+				{
+					std::cout << file << ":" << lineNumber << ": #include mal formado" << std::endl;
+					return false;
+				}
+				if (!preprocess(line.substr(open + 1, close - open - 1), {}, out, depth + 1, files))
+					return false;
+				out += "#line " + std::to_string(lineNumber + 1) + "\n";
+				continue;
+			}
+
+			out += line;
+			out += '\n';
+			if (depth == 0 && !defines.empty() && first != std::string::npos && line.compare(first, 8, "#version") == 0)
+			{
+				for (const std::string &define : defines)
+					out += "#define " + define + "\n";
+				out += "#line " + std::to_string(lineNumber + 1) + "\n";
+			}
+		}
+		return true;
+	}
+
+private:
+	struct BinaryHeader
+	{
+		char magic[4]; // "CGPB"
+		uint32_t format;
+		uint64_t key;
+		uint32_t length;
+	};
+
+	// Recompilação em andamento de um programa
+	struct PendingReload
+	{
+		GLuint vertexShader = 0;
+		GLuint fragmentShader = 0;
+		GLuint program = 0;
+		int step = 0; // sem compilação paralela: 0 vertex, 1 fragment, 2 link, 3 resultado
+		uint64_t key = 0;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	// Programa pedido por load() ou loadCompute(), com os arquivos de que depende
+	struct Entry
+	{
+		std::string vertexFile;	  // ou o compute shader
+		std::string fragmentFile; // vazio nos programas de compute
+		std::vector<std::string> defines;
+		std::set<std::string> files;
+		GLuint program = 0;
+		PendingReload pending;
+	};
+
+	std::string shaderDir;
+	std::string cacheDir;
+	bool binaryCache = true;
+	std::map<uint64_t, GLuint> programs; // por hash das fontes
+	std::map<std::string, Entry> entries; // por arquivos + defines
+	FileWatcher watcher;
+	Stats statistics;
+
+	void cancelReload(Entry &entry)
+	{
+		PendingReload &p = entry.pending;
+		glDeleteShader(p.vertexShader);
+		glDeleteShader(p.fragmentShader);
+		glDeleteProgram(p.program);
+		p = PendingReload();
+	}
+
+	// Lê as fontes novas e dispara a compilação (toda de uma vez, se o driver compila em paralelo)
+	void startReload(const std::string &name, Entry &entry)
+	{
+		cancelReload(entry);
+
+		bool compute = entry.fragmentFile.empty();
+		std::string vertexSource, fragmentSource;
+		std::set<std::string> files;
+		if (!preprocess(entry.vertexFile, entry.defines, vertexSource, 0, &files) ||
+			(!compute && !preprocess(entry.fragmentFile, entry.defines, fragmentSource, 0, &files)))
+			return;
+		entry.files.insert(files.begin(), files.end());
+
+		PendingReload &p = entry.pending;
+		p.key = programKey(vertexSource, fragmentSource);
+		p.start = std::chrono::steady_clock::now();
+		if (programs.count(p.key))
+			return; // o arquivo foi salvo sem mudanças
+
+		const GLchar *vertexText = vertexSource.c_str();
+		const GLchar *fragmentText = fragmentSource.c_str();
+		p.vertexShader = glCreateShader(compute ? GL_COMPUTE_SHADER : GL_VERTEX_SHADER);
+		glShaderSource(p.vertexShader, 1, &vertexText, nullptr);
+		p.program = glCreateProgram();
+		if (glext::hasProgramBinary)
+			glext::glProgramParameteri(p.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glAttachShader(p.program, p.vertexShader);
+		if (!compute)
+		{
+			p.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+			glShaderSource(p.fragmentShader, 1, &fragmentText, nullptr);
+			glAttachShader(p.program, p.fragmentShader);
+		}
+
+		if (glext::hasParallelShaderCompile)
+		{
+			glCompileShader(p.vertexShader);
+			if (p.fragmentShader)
+				glCompileShader(p.fragmentShader);
+			glLinkProgram(p.program);
+			p.step = 3;
+		}
+		std::cout << "Shader " << name << ": recompilando..." << std::endl;
+	}
+
+	// Avança a recompilação sem bloquear; retorna true se o programa foi trocado
+	bool advanceReload(const std::string &name, Entry &entry)
+	{
+		PendingReload &p = entry.pending;
+		switch (p.step)
+		{
+		case 0:
+			glCompileShader(p.vertexShader);
+			p.step = p.fragmentShader ? 1 : 2; // compute: não há etapa 1
+			return false;
+		case 1:
+			glCompileShader(p.fragmentShader);
+			p.step++;
+			return false;
+		case 2:
+			glLinkProgram(p.program);
+			p.step++;
+			return false;
+		default:
+			break;
+		}
+
+		if (glext::hasParallelShaderCompile)
+		{
+			GLint done = GL_FALSE;
+			glGetProgramiv(p.program, GL_COMPLETION_STATUS_KHR, &done);
+			if (!done)
+				return false;
+		}
+
+		bool compute = entry.fragmentFile.empty();
+		bool ok = checkShader(name, compute ? GL_COMPUTE_SHADER : GL_VERTEX_SHADER, p.vertexShader) &&
+				  (compute || checkShader(name, GL_FRAGMENT_SHADER, p.fragmentShader)) && checkProgram(name, p.program);
+		if (!ok)
+		{
+			std::cout << "Shader " << name << ": mantendo o programa anterior" << std::endl;
+			cancelReload(entry);
+			return false;
+		}
+
+		// Outra entrada com as mesmas fontes terminou antes: usa o programa dela
+		GLuint previous = entry.program;
+		auto existing = programs.find(p.key);
+		if (existing != programs.end())
+		{
+			glDeleteProgram(p.program);
+			entry.program = existing->second;
+		}
+		else
+		{
+			entry.program = p.program;
+			programs[p.key] = p.program;
+			if (binaryCache && glext::hasProgramBinary)
+				saveBinary(p.key, p.program);
+		}
+		releaseUnused(previous);
+
+		statistics.reloads++;
+		std::cout << "Shader " << name << ": recarregado (" << elapsedMs(p.start) << " ms)" << std::endl;
+		p.program = 0;
+		cancelReload(entry); // libera só os shaders; o programa agora é o atual
+		return true;
+	}
+
+	// Apaga um programa substituído, a não ser que outra entrada ainda o use (entradas
+	// com as mesmas fontes compartilham o programa, ver build)
+	void releaseUnused(GLuint program)
+	{
+		for (const auto &entry : entries)
+		{
+			if (entry.second.program == program)
+				return;
+		}
+		for (auto it = programs.begin(); it != programs.end(); ++it)
+		{
+			if (it->second == program)
+			{
+				programs.erase(it);
+				break;
+			}
+		}
+		glDeleteProgram(program);
+	}
+
+	static double elapsedMs(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// O binário só vale para o mesmo driver: ele entra na chave
+	static uint64_t programKey(const std::string &vertexSource, const std::string &fragmentSource)
+	{
+		const char *renderer = (const char *)glGetString(GL_RENDERER);
+		const char *version = (const char *)glGetString(GL_VERSION);
+		uint64_t h = hash(vertexSource);
+		h = hash(std::string(1, '\0') + fragmentSource, h);
+		h = hash(std::string(1, '\0') + (renderer ? renderer : "") + (version ? version : ""), h);
+		return h;
+	}
+
+	std::string cachePath(uint64_t key) const
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+		return cacheDir + name;
+	}
+
+	static bool checkShader(const std::string &name, GLenum type, GLuint shader)
+	{
+		GLint success;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			GLchar infoLog[1024];
+			glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+			std::cout << "Error compiling " << (type == GL_VERTEX_SHADER ? "vertex" : type == GL_FRAGMENT_SHADER ? "fragment" : "compute") << " shader (" << name << "):\n"
+					  << infoLog << std::endl;
+		}
+		return success;
+	}
+
+	static bool checkProgram(const std::string &name, GLuint program)
+	{
+		GLint success;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			GLchar infoLog[1024];
+			glGetProgramInfoLog(program, sizeof(infoLog), NULL, infoLog);
+			std::cout << "Error linking shader program (" << name << "):\n"
+					  << infoLog << std::endl;
+		}
+		return success;
+	}
+
+	static GLuint compileStage(const std::string &name, GLenum type, const std::string &source)
+	{
+		GLuint shader = glCreateShader(type);
+		const GLchar *text = source.c_str();
+		glShaderSource(shader, 1, &text, nullptr);
+		glCompileShader(shader);
+		if (!checkShader(name, type, shader))
+		{
+			glDeleteShader(shader);
+			return 0;
+		}
+		return shader;
+	}
+
+	// Sem fragment shader: programa de compute, com a fonte em 'vertexSource'
+	static GLuint compile(const std::string &name, const std::string &vertexSource, const std::string &fragmentSource)
+	{
+		bool compute = fragmentSource.empty();
+		GLuint vertexShader = compileStage(name, compute ? GL_COMPUTE_SHADER : GL_VERTEX_SHADER, vertexSource);
+		GLuint fragmentShader = compute ? 0 : compileStage(name, GL_FRAGMENT_SHADER, fragmentSource);
+		if (!vertexShader || (!compute && !fragmentShader))
+		{
+			glDeleteShader(vertexShader);
+			glDeleteShader(fragmentShader);
+			return 0;
+		}
+
+		GLuint program = glCreateProgram();
+		if (glext::hasProgramBinary)
+			glext::glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glAttachShader(program, vertexShader);
+		if (fragmentShader)
+			glAttachShader(program, fragmentShader);
+		glLinkProgram(program);
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+
+		if (!checkProgram(name, program))
+		{
+			glDeleteProgram(program);
+			return 0;
+		}
+		return program;
+	}
+
+	GLuint loadBinary(uint64_t key)
+	{
+		std::ifstream in(cachePath(key), std::ios::binary);
+		if (!in.is_open())
+			return 0;
+
+		BinaryHeader header;
+		if (!in.read((char *)&header, sizeof(header)) || std::string(header.magic, 4) != "CGPB" || header.key != key)
+			return 0;
+		std::vector<char> binary(header.length);
+		if (!in.read(binary.data(), binary.size()))
+			return 0;
+
+		GLuint program = glCreateProgram();
+		glext::glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+		GLint success;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			statistics.cacheRejected++;
+			glDeleteProgram(program);
+			return 0;
+		}
+		return program;
+	}
+
+	void saveBinary(uint64_t key, GLuint program) const
+	{
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+			return;
+
+		BinaryHeader header;
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		glext::glGetProgramBinary(program, length, nullptr, &format, binary.data());
+		header.magic[0] = 'C';
+		header.magic[1] = 'G';
+		header.magic[2] = 'P';
+		header.magic[3] = 'B';
+		header.format = format;
+		header.key = key;
+		header.length = (uint32_t)length;
+
+		std::error_code error;
+		std::filesystem::create_directories(cacheDir, error);
+		std::ofstream out(cachePath(key), std::ios::binary);
+		if (!out.is_open())
+		{
+			std::cout << "Não foi possível gravar o cache de shader em " << cacheDir << std::endl;
+			return;
+		}
+		out.write((const char *)&header, sizeof(header));
+		out.write(binary.data(), binary.size());
+	}
+};
@@ -0,0 +1,222 @@
+/*
+ * ShadowMap.h - shadow map de uma luz spot com cache da parte estática
+ *
+ * A luz fica em 'lightPos' e aponta para o centro da cena, com uma projeção
+ * perspectiva que cobre a esfera envolvente dos objetos. Refazer o mapa inteiro
+ * a cada frame custa uma passada de profundidade de toda a cena; aqui ele é
+ * dividido em duas camadas:
+ *   - estática: objetos que não se movem sozinhos, desenhados só quando o cache é
+ *     invalidado (invalidate(): um deles foi movido, ou a luz mudou);
+ *   - dinâmica: a cada frame a camada estática é copiada (glBlitFramebuffer) e só
+ *     os objetos em movimento são desenhados por cima.
+ * Sem objetos dinâmicos o mapa estático é usado direto, sem cópia.
+ * Com setCaching(false) tudo é redesenhado todo frame (referência para comparação).
+ *
+ * A textura usa comparação de profundidade (sampler2DShadow): cada amostra já é
+ * filtrada bilinearmente, e o uber-shader (HAS_SHADOWS) faz PCF com 3x3 amostras.
+ * A acne é evitada com glPolygonOffset na passada de profundidade e um pequeno
+ * bias na comparação.
+ *
+ * Uso por frame:
+ *   shadows.update(drawStatic, drawDynamic, hasDynamic); // fn(GLuint program)
+ *   ... programas com HAS_SHADOWS: shadows.setUniforms(program) ...
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "ShaderManager.h"
+
+class ShadowMap
+{
+public:
+	// Unidade de textura do shadow map (a 0 é a textura do material)
+	static const GLint TEXTURE_UNIT = 1;
+
+	struct Stats
+	{
+		int frames = 0;
+		int staticRenders = 0; // quantas vezes a camada estática foi desenhada
+	};
+
+	ShadowMap() {}
+	~ShadowMap() { release(); }
+
+	ShadowMap(const ShadowMap &) = delete;
+	ShadowMap &operator=(const ShadowMap &) = delete;
+
+	// 'instanced': a passada de profundidade lê a matriz de modelo dos atributos 3-6
+	bool create(ShaderManager &shaderManager, int mapSize = 2048, bool instanced = true)
+	{
+		release();
+		shaders = &shaderManager;
+		size = mapSize;
+		depthDefines = instanced ? std::vector<std::string>{"INSTANCED"} : std::vector<std::string>{};
+		if (!shaders->load("shadow_depth.vert", "depth_only.frag", depthDefines))
+			return false;
+
+		staticTexture = createDepthTexture();
+		finalTexture = createDepthTexture();
+		staticFBO = createFramebuffer(staticTexture);
+		finalFBO = createFramebuffer(finalTexture);
+		bool complete = staticFBO && finalFBO;
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		staticValid = false;
+		std::cout << "Shadow map: " << size << "x" << size << (caching ? ", camada estática em cache" : ", redesenhado todo frame") << std::endl;
+		return complete;
+	}
+
+	void release()
+	{
+		if (staticTexture == 0)
+			return;
+		GLuint textures[] = {staticTexture, finalTexture};
+		glDeleteTextures(2, textures);
+		glDeleteFramebuffers(1, &staticFBO);
+		glDeleteFramebuffers(1, &finalFBO);
+		staticTexture = finalTexture = staticFBO = finalFBO = 0;
+	}
+
+	void setCaching(bool enabled) { caching = enabled; }
+	bool cachingEnabled() const { return caching; }
+
+	// A camada estática precisa ser redesenhada (um objeto estático se moveu)
+	void invalidate() { staticValid = false; }
+
+	// Luz spot em 'position' apontada para a esfera (center, radius) que envolve os
+	// objetos; invalida o cache se o frustum mudou
+	void setLight(const glm::vec3 &position, const glm::vec3 &center, float radius)
+	{
+		glm::vec3 toCenter = center - position;
+		float distance = std::max(glm::length(toCenter), 1e-3f);
+		glm::vec3 up = std::abs(toCenter.y) > 0.99f * distance ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		glm::mat4 view = glm::lookAt(position, center, up);
+
+		// Dentro da esfera não há cone que a cubra: abre o ângulo ao máximo razoável
+		float halfAngle = distance > radius ? std::asin(radius / distance) : glm::radians(80.0f);
+		float nearPlane = std::max(distance - radius, 0.05f);
+		float farPlane = distance + radius;
+		glm::mat4 projection = glm::perspective(2.0f * halfAngle, 1.0f, nearPlane, farPlane);
+
+		glm::mat4 matrix = projection * view;
+		if (matrix != lightSpaceMatrix)
+		{
+			lightSpaceMatrix = matrix;
+			staticValid = false;
+		}
+	}
+
+	// Atualiza o mapa; drawStatic/drawDynamic(program) desenham os objetos com o
+	// programa de profundidade já em uso (lightSpace enviado)
+	template <typename DrawStatic, typename DrawDynamic>
+	void update(DrawStatic &&drawStatic, DrawDynamic &&drawDynamic, bool hasDynamic)
+	{
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		glViewport(0, 0, size, size);
+		glEnable(GL_DEPTH_TEST);
+		glEnable(GL_POLYGON_OFFSET_FILL);
+		glPolygonOffset(2.0f, 4.0f);
+
+		GLuint program = shaders->load("shadow_depth.vert", "depth_only.frag", depthDefines);
+		glUseProgram(program);
+		glUniformMatrix4fv(glGetUniformLocation(program, "lightSpace"), 1, GL_FALSE, glm::value_ptr(lightSpaceMatrix));
+
+		if (!staticValid || !caching)
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, staticFBO);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			drawStatic(program);
+			staticValid = true;
+			statistics.staticRenders++;
+		}
+
+		usingFinal = hasDynamic;
+		if (hasDynamic)
+		{
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, staticFBO);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, finalFBO);
+			glBlitFramebuffer(0, 0, size, size, 0, 0, size, size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+			glBindFramebuffer(GL_FRAMEBUFFER, finalFBO);
+			drawDynamic(program);
+		}
+
+		glDisable(GL_POLYGON_OFFSET_FILL);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+		statistics.frames++;
+	}
+
+	// Liga o mapa na TEXTURE_UNIT e envia os uniforms de HAS_SHADOWS; o programa deve estar em uso
+	void setUniforms(GLuint program) const
+	{
+		glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+		glBindTexture(GL_TEXTURE_2D, usingFinal ? finalTexture : staticTexture);
+		glActiveTexture(GL_TEXTURE0);
+		glUniform1i(glGetUniformLocation(program, "shadowMap"), TEXTURE_UNIT);
+		glUniformMatrix4fv(glGetUniformLocation(program, "lightSpace"), 1, GL_FALSE, glm::value_ptr(lightSpaceMatrix));
+		glUniform1f(glGetUniformLocation(program, "shadowBias"), 0.0005f);
+	}
+
+	const glm::mat4 &lightSpace() const { return lightSpaceMatrix; }
+	const Stats &stats() const { return statistics; }
+
+private:
+	ShaderManager *shaders = nullptr;
+	std::vector<std::string> depthDefines;
+	int size = 0;
+	bool caching = true;
+	bool staticValid = false;
+	bool usingFinal = false;
+	glm::mat4 lightSpaceMatrix = glm::mat4(1.0f);
+	Stats statistics;
+
+	GLuint staticTexture = 0, finalTexture = 0;
+	GLuint staticFBO = 0, finalFBO = 0;
+
+	GLuint createDepthTexture() const
+	{
+		GLuint texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		// Fora do mapa: profundidade máxima, ou seja, iluminado
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+		const GLfloat border[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+		glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return texture;
+	}
+
+	static GLuint createFramebuffer(GLuint depthTexture)
+	{
+		GLuint fbo;
+		glGenFramebuffers(1, &fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "Framebuffer incompleto (shadow map)" << std::endl;
+			glDeleteFramebuffers(1, &fbo);
+			return 0;
+		}
+		return fbo;
+	}
+};
@@ -0,0 +1,92 @@
+/*
+ * SimplifyMesh - reduz malhas de alta resolução para um número alvo de triângulos
+ *
+ * Uso: SimplifyMesh <entrada.obj|.mesh> <saída.obj|.mesh> [opções]
+ *
+ * Opções:
+ *   --ratio R        fração de triângulos a manter (padrão 0.25)
+ *   --triangles N    número alvo de triângulos (tem prioridade sobre --ratio)
+ *   --max-error E    para antes do alvo se o erro estimado passar de E (unidades do modelo)
+ *   --normal-dot D   rejeita colapsos que giram normais de faces além de acos(D) (padrão 0.2)
+ *   --hausdorff      mede a distância de Hausdorff entre a entrada e o resultado
+ *
+ * O formato de saída é escolhido pela extensão: .obj (texto) ou .mesh (binário, ver MeshIO.h).
+ * Costuras de UV/normal e bordas abertas são preservadas (ver MeshSimplify.h).
+ *
+ * Exemplo:
+ *   SimplifyMesh ../assets/Modelos3D/SuzanneSubdiv1.obj SuzanneLow.mesh --triangles 1000
+ */
+
+#include <iostream>
+#include <string>
+#include <chrono>
+
+#include "MeshIO.h"
+#include "MeshSimplify.h"
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+	if (argc < 3)
+	{
+		cout << "Uso: SimplifyMesh <entrada.obj|.mesh> <saída.obj|.mesh> [--ratio R] [--triangles N] [--max-error E] [--normal-dot D] [--hausdorff]\n";
+		return 1;
+	}
+
+	string inputPath = argv[1];
+	string outputPath = argv[2];
+	float ratio = 0.25f;
+	size_t targetTriangles = 0;
+	bool measureHausdorff = false;
+	SimplifyOptions options;
+
+	for (int i = 3; i < argc; ++i)
+	{
+		string arg = argv[i];
+		if (arg == "--hausdorff")
+			measureHausdorff = true;
+		else if (i + 1 >= argc)
+		{
+			cout << "Falta o valor de " << arg << endl;
+			return 1;
+		}
+		else if (arg == "--ratio")
+			ratio = stof(argv[++i]);
+		else if (arg == "--triangles")
+			targetTriangles = stoul(argv[++i]);
+		else if (arg == "--max-error")
+			options.maxError = stof(argv[++i]);
+		else if (arg == "--normal-dot")
+			options.minNormalDot = stof(argv[++i]);
+		else
+		{
+			cout << "Opção desconhecida: " << arg << endl;
+			return 1;
+		}
+	}
+
+	MeshData input;
+	if (!loadMeshFile(inputPath, input))
+		return 1;
+	if (targetTriangles == 0)
+		targetTriangles = (size_t)(input.triangleCount() * ratio);
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	MeshSimplifier simplifier(input, options);
+	simplifier.simplifyTo(targetTriangles);
+	MeshData output = simplifier.result();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	cout << "Triângulos: " << input.triangleCount() << " -> " << output.triangleCount()
+		 << " (alvo " << targetTriangles << "), vértices: " << input.vertexCount() << " -> " << output.vertexCount() << endl;
+	cout << "Tempo: " << seconds * 1000.0 << " ms (" << input.triangleCount() / seconds / 1e6 << " M triângulos/s)" << endl;
+	cout << "Erro estimado (QEM): " << simplifier.error() << endl;
+	if (measureHausdorff)
+		cout << "Distância de Hausdorff: " << hausdorffDistance(input, output) << endl;
+
+	if (!saveMeshFile(outputPath, output))
+		return 1;
+	cout << "Gravado: " << outputPath << endl;
+	return 0;
+}
@@ -0,0 +1,545 @@
+/*
+ * SoftRaster.h - rasterizador em software (CPU), sem OpenGL
+ *
+ * Desenha MeshData (MeshData.h) com o mesmo modelo de Phong do uber-shader
+ * (assets/shaders/uber.frag, luz única em lightPos), para renderizar e medir as
+ * cenas em máquinas sem GPU e gerar imagens de referência para comparar com a
+ * saída do OpenGL. Segue as convenções do GL: NDC em [-1, 1], linha 0 embaixo,
+ * centro do pixel em +0.5, teste de profundidade GL_LESS, regra top-left nas
+ * arestas, recorte no near plane e triângulos CCW de frente.
+ *
+ * Pipeline por flush(), cada etapa dividida entre as lanes do JobSystem:
+ *   1. vértices: posição de recorte, posição de mundo, normal e textura
+ *   2. montagem: recorte no near plane, culling opcional de faces de trás, equações
+ *      das arestas e distribuição do retângulo envolvente por tiles de TILE_SIZE
+ *      (listas por lane, sem travas)
+ *   3. tiles: cada tile junta os triângulos das lanes na ordem de submissão e os
+ *      rasteriza sozinho (nenhum pixel é disputado entre threads). As funções de
+ *      aresta e o teste de profundidade avaliam 4 pixels por vez (SSE2, com uma
+ *      versão escalar nas outras arquiteturas); os fragmentos aprovados são
+ *      sombreados com interpolação corrigida pela perspectiva.
+ *
+ * A textura usa filtragem bilinear com repetição (GL_LINEAR + GL_REPEAT), sem mipmaps.
+ *
+ * Uso:
+ *   SoftRasterizer raster(jobs);
+ *   raster.resize(800, 600);
+ *   raster.setCamera(projection, view, eye);
+ *   raster.setLight(lightPos, lightColor);
+ *   raster.clear(clearColor);
+ *   raster.draw(mesh, model, material); // mesh e material vivos até o flush
+ *   raster.flush();
+ *   raster.readPixels(rgba);            // RGBA8, linha 0 em cima
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+#include "MeshData.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFT_RASTER_SSE2 1
+#endif
+
+// Textura RGB em ponto flutuante, linha 0 embaixo (como no glTexImage2D)
+struct SoftTexture
+{
+	int width = 0, height = 0;
+	std::vector<glm::vec3> texels;
+
+	// Bilinear com repetição, centros dos texels em (i + 0.5) / largura
+	glm::vec3 sample(const glm::vec2 &uv) const
+	{
+		float x = uv.x * width - 0.5f, y = uv.y * height - 0.5f;
+		float fx = std::floor(x), fy = std::floor(y);
+		float tx = x - fx, ty = y - fy;
+		int x0 = wrap((int)fx, width), y0 = wrap((int)fy, height);
+		int x1 = wrap(x0 + 1, width), y1 = wrap(y0 + 1, height);
+		const glm::vec3 &a = texels[(size_t)y0 * width + x0], &b = texels[(size_t)y0 * width + x1];
+		const glm::vec3 &c = texels[(size_t)y1 * width + x0], &d = texels[(size_t)y1 * width + x1];
+		return glm::mix(glm::mix(a, b, tx), glm::mix(c, d, tx), ty);
+	}
+
+private:
+	static int wrap(int i, int n)
+	{
+		i %= n;
+		return i < 0 ? i + n : i;
+	}
+};
+
+// Os mesmos parâmetros de Material (Material.h), com a textura na memória
+struct SoftMaterial
+{
+	glm::vec3 color = glm::vec3(1.0f);
+	const SoftTexture *texture = nullptr;
+	float ambient = 0.2f;
+	float diffuse = 1.0f;
+	float specular = 1.0f; // 0: sem termo especular
+	float shininess = 32.0f;
+};
+
+// O fragment shader de uber.frag (luz única): 'shadow' é a fração iluminada, que como
+// no HAS_SHADOWS multiplica só o difuso e o especular
+inline glm::vec3 shadePhong(const SoftMaterial &m, const glm::vec3 &base, const glm::vec3 &N, const glm::vec3 &fragPos,
+							const glm::vec3 &lightPos, const glm::vec3 &lightColor, const glm::vec3 &viewPos, float shadow = 1.0f)
+{
+	glm::vec3 L = glm::normalize(lightPos - fragPos);
+	glm::vec3 lit = m.diffuse * std::max(glm::dot(N, L), 0.0f) * lightColor * base;
+	if (m.specular > 0.0f)
+	{
+		glm::vec3 V = glm::normalize(viewPos - fragPos);
+		glm::vec3 R = glm::reflect(-L, N);
+		lit += m.specular * std::pow(std::max(glm::dot(V, R), 0.0f), m.shininess) * lightColor;
+	}
+	return m.ambient * lightColor * base + shadow * lit;
+}
+
+// Imagem em ponto flutuante (linha 0 embaixo, 'stride' pixels por linha) para RGBA8
+// com a linha 0 em cima (ordem dos arquivos de imagem), cores limitadas a [0, 1]
+inline void toRGBA8(const std::vector<glm::vec3> &image, int width, int height, int stride, std::vector<uint8_t> &out)
+{
+	out.resize((size_t)width * height * 4);
+	for (int y = 0; y < height; ++y)
+	{
+		const glm::vec3 *src = &image[(size_t)(height - 1 - y) * stride];
+		uint8_t *dst = &out[(size_t)y * width * 4];
+		for (int x = 0; x < width; ++x)
+		{
+			glm::vec3 c = glm::clamp(src[x], 0.0f, 1.0f) * 255.0f + 0.5f;
+			dst[x * 4 + 0] = (uint8_t)c.r;
+			dst[x * 4 + 1] = (uint8_t)c.g;
+			dst[x * 4 + 2] = (uint8_t)c.b;
+			dst[x * 4 + 3] = 255;
+		}
+	}
+}
+
+class SoftRasterizer
+{
+public:
+	static const int TILE_SIZE = 32;
+
+	struct Stats
+	{
+		size_t triangles = 0;  // submetidos
+		size_t rasterized = 0; // depois do recorte e do culling
+		size_t fragments = 0;  // sombreados (aprovados no teste de profundidade)
+	};
+
+	explicit SoftRasterizer(JobSystem &jobSystem) : jobs(jobSystem) {}
+
+	SoftRasterizer(const SoftRasterizer &) = delete;
+	SoftRasterizer &operator=(const SoftRasterizer &) = delete;
+
+	// Os buffers têm largura e altura arredondadas para múltiplos de TILE_SIZE, para
+	// que os grupos de 4 pixels nunca saiam da memória
+	void resize(int w, int h)
+	{
+		width = w;
+		height = h;
+		tilesX = (w + TILE_SIZE - 1) / TILE_SIZE;
+		tilesY = (h + TILE_SIZE - 1) / TILE_SIZE;
+		stride = tilesX * TILE_SIZE;
+		color.assign((size_t)stride * tilesY * TILE_SIZE, glm::vec3(0.0f));
+		depth.assign(color.size(), 1.0f);
+	}
+
+	void setCamera(const glm::mat4 &projection, const glm::mat4 &view, const glm::vec3 &eye)
+	{
+		viewProjection = projection * view;
+		viewPos = eye;
+	}
+
+	void setLight(const glm::vec3 &position, const glm::vec3 &lightColor)
+	{
+		lightPos = position;
+		this->lightColor = lightColor;
+	}
+
+	// Como glEnable(GL_CULL_FACE) com glCullFace(GL_BACK); desligado por padrão, como no GL
+	void setCullBackFaces(bool enabled) { cullBackFaces = enabled; }
+
+	void clear(const glm::vec3 &clearColor)
+	{
+		std::fill(color.begin(), color.end(), clearColor);
+		std::fill(depth.begin(), depth.end(), 1.0f);
+	}
+
+	void draw(const MeshData &mesh, const glm::mat4 &model, const SoftMaterial &material)
+	{
+		DrawCall call;
+		call.mesh = &mesh;
+		call.material = &material;
+		call.model = model;
+		call.normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+		draws.push_back(call);
+	}
+
+	// Executa as três etapas para os desenhos pendentes
+	void flush()
+	{
+		statistics = Stats();
+		if (draws.empty())
+			return;
+		unsigned lanes = jobs.laneCount();
+
+		// Deslocamentos de cada desenho nos arrays de vértices e triângulos
+		size_t vertexCount = 0, triangleCount = 0;
+		for (DrawCall &call : draws)
+		{
+			call.firstVertex = vertexCount;
+			call.firstTriangle = triangleCount;
+			vertexCount += call.mesh->vertexCount();
+			triangleCount += call.mesh->triangleCount();
+		}
+		statistics.triangles = triangleCount;
+
+		vertices.resize(vertexCount);
+		jobs.parallelFor(vertexCount, 4096, [&](size_t begin, size_t end, unsigned)
+						 { transformVertices(begin, end); });
+
+		laneData.resize(lanes);
+		for (LaneData &lane : laneData)
+		{
+			lane.triangles.clear();
+			lane.bins.resize((size_t)tilesX * tilesY);
+			for (std::vector<BinEntry> &bin : lane.bins)
+				bin.clear();
+			lane.fragments = 0;
+		}
+		jobs.parallelFor(triangleCount, 1024, [&](size_t begin, size_t end, unsigned lane)
+						 { setupTriangles(begin, end, laneData[lane]); });
+
+		jobs.parallelFor((size_t)tilesX * tilesY, 1, [&](size_t begin, size_t end, unsigned lane)
+						 {
+			for (size_t t = begin; t < end; ++t)
+				rasterizeTile((int)t, laneData[lane]); });
+
+		for (const LaneData &lane : laneData)
+		{
+			statistics.rasterized += lane.triangles.size();
+			statistics.fragments += lane.fragments;
+		}
+		draws.clear();
+	}
+
+	// RGBA8 com a linha 0 em cima (ver toRGBA8)
+	void readPixels(std::vector<uint8_t> &out) const { toRGBA8(color, width, height, stride, out); }
+
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	const Stats &stats() const { return statistics; }
+
+private:
+	struct DrawCall
+	{
+		const MeshData *mesh = nullptr;
+		const SoftMaterial *material = nullptr;
+		glm::mat4 model;
+		glm::mat3 normalMatrix;
+		size_t firstVertex = 0, firstTriangle = 0;
+	};
+
+	// Saída do "vertex shader"
+	struct Vertex
+	{
+		glm::vec4 clip;
+		glm::vec3 world;
+		glm::vec3 normal;
+		glm::vec2 texCoord;
+	};
+
+	// Triângulo em coordenadas de tela, pronto para a rasterização
+	struct Triangle
+	{
+		float edgeA[3], edgeB[3], edgeC[3]; // E_i(x, y) = A x + B y + C, >= 0 dentro
+		bool topLeft[3];					// aresta i aceita E == 0
+		float invArea;
+		float depth[3]; // z de NDC
+		float invW[3];
+		glm::vec3 worldOverW[3], normalOverW[3];
+		glm::vec2 texCoordOverW[3];
+		int minX, minY, maxX, maxY; // retângulo em pixels, já limitado à tela
+		const SoftMaterial *material;
+	};
+
+	struct BinEntry
+	{
+		uint64_t order; // ordem de submissão (triângulo * 2 + pedaço do recorte)
+		uint32_t index; // em LaneData::triangles da mesma lane
+	};
+
+	struct LaneData
+	{
+		std::vector<Triangle> triangles;
+		std::vector<std::vector<BinEntry>> bins; // por tile
+		std::vector<std::pair<uint64_t, const Triangle *>> tileList;
+		size_t fragments = 0;
+	};
+
+	JobSystem &jobs;
+	int width = 0, height = 0;
+	int tilesX = 0, tilesY = 0, stride = 0;
+	std::vector<glm::vec3> color;
+	std::vector<float> depth; // z de NDC; limpo com 1 (far)
+
+	glm::mat4 viewProjection = glm::mat4(1.0f);
+	glm::vec3 viewPos = glm::vec3(0.0f);
+	glm::vec3 lightPos = glm::vec3(0.0f);
+	glm::vec3 lightColor = glm::vec3(1.0f);
+	bool cullBackFaces = false;
+
+	std::vector<DrawCall> draws;
+	std::vector<Vertex> vertices;
+	std::vector<LaneData> laneData;
+	Stats statistics;
+
+	// Desenho que contém o elemento 'i' (busca binária nos deslocamentos)
+	template <typename Member>
+	size_t findDraw(size_t i, Member first) const
+	{
+		auto it = std::upper_bound(draws.begin(), draws.end(), i, [first](size_t value, const DrawCall &call)
+								   { return value < call.*first; });
+		return (size_t)(it - draws.begin()) - 1;
+	}
+
+	void transformVertices(size_t begin, size_t end)
+	{
+		size_t d = findDraw(begin, &DrawCall::firstVertex);
+		for (size_t v = begin; v < end; ++v)
+		{
+			while (d + 1 < draws.size() && draws[d + 1].firstVertex <= v)
+				++d;
+			const DrawCall &call = draws[d];
+			const MeshData &mesh = *call.mesh;
+			size_t i = v - call.firstVertex;
+
+			Vertex &out = vertices[v];
+			glm::vec4 world = call.model * glm::vec4(mesh.positions[i], 1.0f);
+			out.clip = viewProjection * world;
+			out.world = glm::vec3(world);
+			out.normal = i < mesh.normals.size() ? call.normalMatrix * mesh.normals[i] : glm::vec3(0.0f, 0.0f, 1.0f);
+			out.texCoord = i < mesh.texCoords.size() ? mesh.texCoords[i] : glm::vec2(0.0f);
+		}
+	}
+
+	static Vertex lerpVertex(const Vertex &a, const Vertex &b, float t)
+	{
+		Vertex v;
+		v.clip = glm::mix(a.clip, b.clip, t);
+		v.world = glm::mix(a.world, b.world, t);
+		v.normal = glm::mix(a.normal, b.normal, t);
+		v.texCoord = glm::mix(a.texCoord, b.texCoord, t);
+		return v;
+	}
+
+	void setupTriangles(size_t begin, size_t end, LaneData &lane)
+	{
+		size_t d = findDraw(begin, &DrawCall::firstTriangle);
+		for (size_t t = begin; t < end; ++t)
+		{
+			while (d + 1 < draws.size() && draws[d + 1].firstTriangle <= t)
+				++d;
+			const DrawCall &call = draws[d];
+			const uint32_t *idx = &call.mesh->indices[(t - call.firstTriangle) * 3];
+			const Vertex *v[3] = {&vertices[call.firstVertex + idx[0]], &vertices[call.firstVertex + idx[1]], &vertices[call.firstVertex + idx[2]]};
+
+			// Recorte no near plane (z >= -w): o triângulo vira um polígono de até 4 vértices
+			Vertex polygon[4];
+			int count = 0;
+			for (int i = 0; i < 3; ++i)
+			{
+				const Vertex &a = *v[i], &b = *v[(i + 1) % 3];
+				float da = a.clip.z + a.clip.w, db = b.clip.z + b.clip.w;
+				if (da >= 0.0f)
+					polygon[count++] = a;
+				if ((da >= 0.0f) != (db >= 0.0f))
+					polygon[count++] = lerpVertex(a, b, da / (da - db));
+			}
+			for (int k = 0; k + 2 < count; ++k)
+				setupTriangle(polygon[0], polygon[k + 1], polygon[k + 2], call.material, (uint64_t)t * 2 + k, lane);
+		}
+	}
+
+	void setupTriangle(const Vertex &v0, const Vertex &v1, const Vertex &v2, const SoftMaterial *material, uint64_t order, LaneData &lane)
+	{
+		const Vertex *v[3] = {&v0, &v1, &v2};
+		float x[3], y[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			float invW = 1.0f / v[i]->clip.w;
+			x[i] = (v[i]->clip.x * invW * 0.5f + 0.5f) * width;
+			y[i] = (v[i]->clip.y * invW * 0.5f + 0.5f) * height;
+		}
+
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (area == 0.0f || (area < 0.0f && cullBackFaces))
+			return;
+		if (area < 0.0f)
+		{
+			// Face de trás sem culling: inverte a ordem para as arestas ficarem positivas dentro
+			std::swap(v[1], v[2]);
+			std::swap(x[1], x[2]);
+			std::swap(y[1], y[2]);
+			area = -area;
+		}
+
+		Triangle tri;
+		tri.minX = std::max(0, (int)std::floor(std::min(x[0], std::min(x[1], x[2]))));
+		tri.minY = std::max(0, (int)std::floor(std::min(y[0], std::min(y[1], y[2]))));
+		tri.maxX = std::min(width - 1, (int)std::ceil(std::max(x[0], std::max(x[1], x[2]))));
+		tri.maxY = std::min(height - 1, (int)std::ceil(std::max(y[0], std::max(y[1], y[2]))));
+		if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+			return;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			// Aresta oposta ao vértice i, de j para k
+			int j = (i + 1) % 3, k = (i + 2) % 3;
+			tri.edgeA[i] = y[j] - y[k];
+			tri.edgeB[i] = x[k] - x[j];
+			tri.edgeC[i] = x[j] * y[k] - x[k] * y[j];
+			tri.topLeft[i] = tri.edgeA[i] > 0.0f || (tri.edgeA[i] == 0.0f && tri.edgeB[i] < 0.0f);
+
+			float invW = 1.0f / v[i]->clip.w;
+			tri.depth[i] = v[i]->clip.z * invW;
+			tri.invW[i] = invW;
+			tri.worldOverW[i] = v[i]->world * invW;
+			tri.normalOverW[i] = v[i]->normal * invW;
+			tri.texCoordOverW[i] = v[i]->texCoord * invW;
+		}
+		tri.invArea = 1.0f / area;
+		tri.material = material;
+
+		uint32_t index = (uint32_t)lane.triangles.size();
+		lane.triangles.push_back(tri);
+		for (int ty = tri.minY / TILE_SIZE; ty <= tri.maxY / TILE_SIZE; ++ty)
+		{
+			for (int tx = tri.minX / TILE_SIZE; tx <= tri.maxX / TILE_SIZE; ++tx)
+				lane.bins[(size_t)ty * tilesX + tx].push_back(BinEntry{order, index});
+		}
+	}
+
+	void rasterizeTile(int tile, LaneData &lane)
+	{
+		// Triângulos do tile vindos de todas as lanes, na ordem de submissão (a mesma
+		// imagem com qualquer número de threads)
+		std::vector<std::pair<uint64_t, const Triangle *>> &list = lane.tileList;
+		list.clear();
+		for (const LaneData &other : laneData)
+		{
+			for (const BinEntry &e : other.bins[tile])
+				list.push_back(std::make_pair(e.order, &other.triangles[e.index]));
+		}
+		if (list.empty())
+			return;
+		std::sort(list.begin(), list.end(), [](const std::pair<uint64_t, const Triangle *> &a, const std::pair<uint64_t, const Triangle *> &b)
+				  { return a.first < b.first; });
+
+		int tileX0 = (tile % tilesX) * TILE_SIZE, tileY0 = (tile / tilesX) * TILE_SIZE;
+		for (const auto &entry : list)
+			rasterizeTriangle(*entry.second, tileX0, tileY0, lane);
+	}
+
+	void rasterizeTriangle(const Triangle &tri, int tileX0, int tileY0, LaneData &lane)
+	{
+		// Retângulo do triângulo dentro do tile; x alinhado a 4 pixels
+		int x0 = std::max(tri.minX, tileX0) & ~3;
+		int x1 = std::min(tri.maxX, tileX0 + TILE_SIZE - 1);
+		int y0 = std::max(tri.minY, tileY0);
+		int y1 = std::min(tri.maxY, tileY0 + TILE_SIZE - 1);
+		int xStart = std::max(tri.minX, tileX0);
+
+		for (int y = y0; y <= y1; ++y)
+		{
+			float py = y + 0.5f;
+			for (int x = x0; x <= x1; x += 4)
+			{
+				float e[3][4], z[4];
+				int mask = coverage4(tri, x, py, xStart, x1, &depth[(size_t)y * stride + x], e, z);
+				for (int l = 0; l < 4; ++l)
+				{
+					if (mask & (1 << l))
+						shadeFragment(tri, e[0][l], e[1][l], e[2][l], z[l], (size_t)y * stride + x + l, lane);
+				}
+			}
+		}
+	}
+
+	// Avalia as arestas e a profundidade nos pixels x..x+3 da linha; retorna a máscara
+	// dos pixels cobertos e mais próximos que o depth buffer
+#ifdef SOFT_RASTER_SSE2
+	static int coverage4(const Triangle &tri, int x, float py, int xMin, int xMax, const float *depthRow, float e[3][4], float z[4])
+	{
+		__m128 px = _mm_add_ps(_mm_set1_ps((float)x + 0.5f), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+		__m128i ix = _mm_add_epi32(_mm_set1_epi32(x), _mm_set_epi32(3, 2, 1, 0));
+		__m128 inside = _mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(ix, _mm_set1_epi32(xMin - 1)), _mm_cmplt_epi32(ix, _mm_set1_epi32(xMax + 1))));
+		__m128 zero = _mm_setzero_ps();
+		__m128 zSum = zero;
+		for (int i = 0; i < 3; ++i)
+		{
+			__m128 ei = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.edgeA[i]), px), _mm_set1_ps(tri.edgeB[i] * py + tri.edgeC[i]));
+			__m128 pass = _mm_cmpgt_ps(ei, zero);
+			if (tri.topLeft[i])
+				pass = _mm_or_ps(pass, _mm_cmpeq_ps(ei, zero));
+			inside = _mm_and_ps(inside, pass);
+			_mm_storeu_ps(e[i], ei);
+			zSum = _mm_add_ps(zSum, _mm_mul_ps(ei, _mm_set1_ps(tri.depth[i])));
+		}
+		if (_mm_movemask_ps(inside) == 0)
+			return 0;
+		__m128 zv = _mm_mul_ps(zSum, _mm_set1_ps(tri.invArea));
+		inside = _mm_and_ps(inside, _mm_cmplt_ps(zv, _mm_loadu_ps(depthRow)));
+		_mm_storeu_ps(z, zv);
+		return _mm_movemask_ps(inside);
+	}
+#else
+	static int coverage4(const Triangle &tri, int x, float py, int xMin, int xMax, const float *depthRow, float e[3][4], float z[4])
+	{
+		int mask = 0;
+		for (int l = 0; l < 4; ++l)
+		{
+			float px = x + l + 0.5f;
+			bool inside = x + l >= xMin && x + l <= xMax;
+			float zSum = 0.0f;
+			for (int i = 0; i < 3; ++i)
+			{
+				e[i][l] = tri.edgeA[i] * px + (tri.edgeB[i] * py + tri.edgeC[i]);
+				inside = inside && (e[i][l] > 0.0f || (e[i][l] == 0.0f && tri.topLeft[i]));
+				zSum += e[i][l] * tri.depth[i];
+			}
+			z[l] = zSum * tri.invArea;
+			if (inside && z[l] < depthRow[l])
+				mask |= 1 << l;
+		}
+		return mask;
+	}
+#endif
+
+	// O fragment shader: uber.frag com HAS_TEXTURE/HAS_SPECULAR conforme o material
+	void shadeFragment(const Triangle &tri, float e0, float e1, float e2, float z, size_t pixel, LaneData &lane)
+	{
+		float l0 = e0 * tri.invArea, l1 = e1 * tri.invArea, l2 = e2 * tri.invArea;
+		float w = 1.0f / (l0 * tri.invW[0] + l1 * tri.invW[1] + l2 * tri.invW[2]);
+		glm::vec3 fragPos = (l0 * tri.worldOverW[0] + l1 * tri.worldOverW[1] + l2 * tri.worldOverW[2]) * w;
+		glm::vec3 normal = (l0 * tri.normalOverW[0] + l1 * tri.normalOverW[1] + l2 * tri.normalOverW[2]) * w;
+
+		const SoftMaterial &m = *tri.material;
+		glm::vec3 base = m.color;
+		if (m.texture)
+			base *= m.texture->sample((l0 * tri.texCoordOverW[0] + l1 * tri.texCoordOverW[1] + l2 * tri.texCoordOverW[2]) * w);
+
+		color[pixel] = shadePhong(m, base, glm::normalize(normal), fragPos, lightPos, lightColor, viewPos);
+		depth[pixel] = z;
+		lane.fragments++;
+	}
+};
@@ -0,0 +1,390 @@
+/*
+ * SoftRender - renderiza as cenas dos exercícios na CPU (SoftRaster.h), sem GPU,
+ * ou com ray tracing (RayTracer.h) para uma referência com sombras exatas
+ *
+ * Uso: SoftRender <cena> [opções]
+ *
+ * Cenas:
+ *   sphere           a esfera do SpherePhong (mesma câmera ortográfica, luz e material)
+ *   <arquivo.json>   cubos no formato do TriangleTex, com a câmera inicial dele
+ *   <arquivo.scene>  a mesma cena no binário do SceneConvert
+ *
+ * Opções:
+ *   --out F.png      imagem de saída (padrão softrender.png); serve de referência
+ *                    para comparar com um print da janela OpenGL
+ *   --size LxA       resolução (padrão: a da janela do exercício)
+ *   --obj P          malha dos cubos, .obj ou .mesh (padrão ../assets/Modelos3D/Cube.obj)
+ *   --stress N       replica os cubos em grade até N objetos (como no TriangleTex)
+ *   --texture        esfera com a textura pixelWall (tecla T do SpherePhong)
+ *   --threads N      threads de rasterização (padrão: todos os núcleos)
+ *   --bench F        mede F frames com 1, 2, 4, ... threads até --threads
+ *   --raytrace       ray tracing com BVH em vez da rasterização (Phong igual)
+ *   --no-shadows     ray tracing sem os raios de sombra
+ *
+ * Texturas que não abrem no caminho do JSON são procuradas em ../assets/tex/ pelo
+ * nome do arquivo (os JSONs do repositório têm caminhos absolutos do Windows).
+ *
+ * Exemplos:
+ *   SoftRender sphere --out esfera.png
+ *   SoftRender ../assets/cube.json --stress 10000 --bench 20
+ *   SoftRender ../assets/cube.json --raytrace --bench 5
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <filesystem>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "JobSystem.h"
+#include "DrawList.h"
+#include "MeshIO.h"
+#include "SoftRaster.h"
+#include "RayTracer.h"
+#include "SceneSnapshot.h"
+
+using namespace std;
+using namespace glm;
+
+typedef chrono::high_resolution_clock Clock;
+
+// Uma cena pronta para o rasterizador: câmera, luz e os objetos
+struct SoftScene
+{
+	int width = 800, height = 800;
+	mat4 projection = mat4(1.0f), view = mat4(1.0f);
+	vec3 eye = vec3(0.0f);
+	vec3 lightPos = vec3(0.0f), lightColor = vec3(1.0f);
+	vec3 clearColor = vec3(0.0f);
+
+	struct Object
+	{
+		const MeshData *mesh;
+		mat4 model;
+		size_t material;
+	};
+	MeshData mesh;
+	vector<SoftMaterial> materials;
+	vector<Object> objects;
+	map<string, SoftTexture> textures;
+
+	void render(SoftRasterizer &raster) const
+	{
+		raster.setCamera(projection, view, eye);
+		raster.setLight(lightPos, lightColor);
+		raster.clear(clearColor);
+		for (const Object &o : objects)
+			raster.draw(*o.mesh, o.model, materials[o.material]);
+		raster.flush();
+	}
+
+	// Os materiais precisam continuar vivos enquanto o tracer for usado
+	void buildTracer(RayTracer &tracer) const
+	{
+		for (const Object &o : objects)
+			tracer.addMesh(*o.mesh, o.model, &materials[o.material]);
+		tracer.build();
+		tracer.setCamera(projection, view, eye);
+		tracer.setLight(lightPos, lightColor);
+		tracer.setBackground(clearColor);
+	}
+};
+
+// Carrega como o TriangleTex (origem embaixo, como o glTexImage2D espera), em [0, 1]
+static bool loadSoftTexture(const string &path, bool flip, SoftTexture &texture)
+{
+	int channels;
+	stbi_set_flip_vertically_on_load(flip);
+	unsigned char *data = stbi_load(path.c_str(), &texture.width, &texture.height, &channels, 3);
+	if (!data)
+		return false;
+	texture.texels.resize((size_t)texture.width * texture.height);
+	for (size_t i = 0; i < texture.texels.size(); ++i)
+		texture.texels[i] = vec3(data[i * 3], data[i * 3 + 1], data[i * 3 + 2]) / 255.0f;
+	stbi_image_free(data);
+	return true;
+}
+
+// SpherePhong: esfera de raio 0.5 (LOD 0, 64 segmentos) em ortho(-1, 1, -1, 1, -3, 3)
+static void buildSphereScene(SoftScene &scene, bool textured)
+{
+	scene.width = scene.height = 800;
+	scene.projection = ortho(-1.0f, 1.0f, -1.0f, 1.0f, -3.0f, 3.0f);
+	scene.eye = vec3(0.0f, 0.0f, -3.0f);
+	scene.lightPos = vec3(0.6f, 1.2f, -0.5f);
+	scene.mesh = buildSphere(0.5f, 64, 64);
+
+	SoftMaterial material;
+	material.color = vec3(1.0f, 0.0f, 0.0f);
+	material.ambient = 0.1f;
+	material.diffuse = 0.5f;
+	material.specular = 0.5f;
+	material.shininess = 10.0f;
+	if (textured)
+	{
+		// O SpherePhong não inverte a imagem ao carregar
+		if (loadSoftTexture("../assets/tex/pixelWall.png", false, scene.textures["pixelWall"]))
+			material.texture = &scene.textures["pixelWall"];
+		else
+			cout << "Falha ao carregar ../assets/tex/pixelWall.png, esfera sem textura" << endl;
+	}
+	scene.materials.push_back(material);
+	scene.objects.push_back(SoftScene::Object{&scene.mesh, mat4(1.0f), 0});
+}
+
+// TriangleTex: câmera em (0, 0, 3) olhando para -z, perspectiva de 45 graus
+static bool buildCubeScene(SoftScene &scene, const string &jsonPath, const string &objPath, size_t stressCount)
+{
+	scene.width = 800;
+	scene.height = 600;
+	scene.projection = perspective(radians(45.0f), 800.0f / 600.0f, 0.1f, 1000.0f);
+	scene.eye = vec3(0.0f, 0.0f, 3.0f);
+	scene.view = lookAt(scene.eye, scene.eye + vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f));
+	scene.lightPos = vec3(3.0f, 3.0f, 3.0f);
+	scene.clearColor = vec3(0.1f, 0.1f, 0.1f);
+
+	if (!loadMeshFile(objPath, scene.mesh))
+	{
+		cout << "Erro ao carregar a malha: " << objPath << endl;
+		return false;
+	}
+
+	SceneDescription description;
+	if (!loadSceneFile(jsonPath, description))
+		return false;
+	if (description.size() == 0)
+	{
+		cout << "Nenhum cubo em " << jsonPath << endl;
+		return false;
+	}
+	if (!description.lights.empty())
+	{
+		// O caminho forward do TriangleTex usa só a primeira luz
+		scene.lightPos = description.lights[0].position;
+		scene.lightColor = description.lights[0].color;
+	}
+
+	// Um material por cubo do JSON; eles apontam para as texturas do map (endereços estáveis)
+	for (size_t i = 0; i < description.size(); ++i)
+	{
+		SoftMaterial material;
+		const SceneMaterial &m = description.materials[i];
+		if (m.fields & SceneMaterial::HAS_COLOR)
+			material.color = m.color;
+		if (m.fields & SceneMaterial::HAS_SPECULAR)
+			material.specular = m.specular;
+		if (m.fields & SceneMaterial::HAS_SHININESS)
+			material.shininess = m.shininess;
+
+		if (description.textures[i] >= 0)
+		{
+			const string &texPath = description.texturePaths[description.textures[i]];
+			auto it = scene.textures.find(texPath);
+			if (it == scene.textures.end())
+			{
+				SoftTexture texture;
+				string fallback = "../assets/tex/" + filesystem::path(texPath).filename().string();
+				if (!loadSoftTexture(texPath, true, texture) && !loadSoftTexture(fallback, true, texture))
+					cout << "Falha ao carregar textura: " << texPath << " (cubo sem textura)" << endl;
+				it = scene.textures.emplace(texPath, std::move(texture)).first;
+			}
+			if (!it->second.texels.empty())
+				material.texture = &it->second;
+		}
+		scene.materials.push_back(material);
+	}
+
+	size_t original = description.size();
+	size_t count = max(stressCount, original);
+	size_t side = (size_t)ceil(cbrt((double)count));
+	for (size_t i = 0; i < count; ++i)
+	{
+		vec3 position = description.positions[i % original], rotation(0.0f);
+		if (i >= original)
+		{
+			position = vec3((float)(i % side), (float)((i / side) % side), -(float)(i / (side * side))) * 2.0f - vec3((float)side, (float)side, 5.0f);
+			rotation = vec3((float)(i % 360), (float)((i * 7) % 360), 0.0f);
+		}
+		mat4 model = composeModel(position, rotation, description.scales[i % original]);
+		scene.objects.push_back(SoftScene::Object{&scene.mesh, model, i % original});
+	}
+	return true;
+}
+
+static bool writeImage(const string &outPath, const SoftScene &scene, const vector<uint8_t> &pixels)
+{
+	if (!stbi_write_png(outPath.c_str(), scene.width, scene.height, 4, pixels.data(), scene.width * 4))
+	{
+		cout << "Erro ao gravar " << outPath << endl;
+		return false;
+	}
+	cout << "Imagem: " << outPath << endl;
+	return true;
+}
+
+// --raytrace: a BVH é construída uma vez e reaproveitada no benchmark
+static int runRayTracer(const SoftScene &scene, JobSystem &jobs, bool shadows, const string &outPath, int benchFrames)
+{
+	RayTracer tracer;
+	scene.buildTracer(tracer);
+	tracer.setShadows(shadows);
+	const RayTracer::Stats &stats = tracer.stats();
+	cout << "BVH: " << stats.nodes << " nós para " << stats.triangles << " triângulos em " << fixed << setprecision(2) << stats.buildMs << " ms" << defaultfloat << endl;
+
+	tracer.render(jobs, scene.width, scene.height);
+	cout << "Frame: " << fixed << setprecision(2) << stats.renderMs << " ms com " << jobs.laneCount() << " threads, "
+		 << stats.primaryRays << " raios primários, " << stats.shadowRays << " de sombra, "
+		 << stats.raysPerSecond() / 1e6 << " Mraios/s" << defaultfloat << endl;
+
+	vector<uint8_t> pixels;
+	tracer.readPixels(pixels);
+	if (!writeImage(outPath, scene, pixels))
+		return 1;
+
+	if (benchFrames > 0)
+	{
+		unsigned maxThreads = jobs.laneCount();
+		cout << "Benchmark: " << benchFrames << " frames" << endl;
+		for (unsigned threads = 1;; threads = min(threads * 2, maxThreads))
+		{
+			JobSystem benchJobs(threads);
+			double totalMs = 0.0;
+			size_t rays = 0;
+			for (int f = 0; f < benchFrames; ++f)
+			{
+				tracer.render(benchJobs, scene.width, scene.height);
+				totalMs += stats.renderMs;
+				rays += stats.primaryRays + stats.shadowRays;
+			}
+			cout << "  " << setw(3) << threads << " threads: " << fixed << setprecision(2) << setw(8) << totalMs / benchFrames << " ms/frame, "
+				 << setw(7) << rays / totalMs / 1000.0 << " Mraios/s" << defaultfloat << endl;
+			if (threads == maxThreads)
+				break;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		cout << "Uso: SoftRender <sphere|cena.json|cena.scene> [--out F.png] [--size LxA] [--obj P] [--stress N] [--texture] [--threads N] [--bench F] [--raytrace] [--no-shadows]\n";
+		return 1;
+	}
+
+	string sceneName = argv[1];
+	string outPath = "softrender.png";
+	string objPath = "../assets/Modelos3D/Cube.obj";
+	int width = 0, height = 0;
+	size_t stressCount = 0;
+	bool textured = false;
+	unsigned numThreads = 0;
+	int benchFrames = 0;
+	bool raytrace = false, shadows = true;
+	for (int i = 2; i < argc; ++i)
+	{
+		string arg = argv[i];
+		if (arg == "--texture")
+			textured = true;
+		else if (arg == "--raytrace")
+			raytrace = true;
+		else if (arg == "--no-shadows")
+			shadows = false;
+		else if (i + 1 >= argc)
+			cout << "Opção sem valor: " << arg << endl;
+		else if (arg == "--out")
+			outPath = argv[++i];
+		else if (arg == "--size")
+		{
+			string size = argv[++i];
+			size_t x = size.find('x');
+			if (x != string::npos)
+			{
+				width = stoi(size.substr(0, x));
+				height = stoi(size.substr(x + 1));
+			}
+		}
+		else if (arg == "--obj")
+			objPath = argv[++i];
+		else if (arg == "--stress")
+			stressCount = stoul(argv[++i]);
+		else if (arg == "--threads")
+			numThreads = (unsigned)stoul(argv[++i]);
+		else if (arg == "--bench")
+			benchFrames = stoi(argv[++i]);
+		else
+			cout << "Opção desconhecida: " << arg << endl;
+	}
+
+	SoftScene scene;
+	if (sceneName == "sphere")
+		buildSphereScene(scene, textured);
+	else if (!buildCubeScene(scene, sceneName, objPath, stressCount))
+		return 1;
+	if (width > 0 && height > 0)
+	{
+		// Mantém a proporção da câmera da cena
+		if (sceneName != "sphere")
+			scene.projection = perspective(radians(45.0f), (float)width / height, 0.1f, 1000.0f);
+		scene.width = width;
+		scene.height = height;
+	}
+
+	size_t triangles = 0;
+	for (const SoftScene::Object &o : scene.objects)
+		triangles += o.mesh->triangleCount();
+	cout << "Cena: " << scene.objects.size() << " objetos, " << triangles << " triângulos, " << scene.width << "x" << scene.height << endl;
+
+	JobSystem jobs(numThreads);
+	if (raytrace)
+		return runRayTracer(scene, jobs, shadows, outPath, benchFrames);
+
+	SoftRasterizer raster(jobs);
+	raster.resize(scene.width, scene.height);
+	Clock::time_point start = Clock::now();
+	scene.render(raster);
+	double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+	cout << "Frame: " << fixed << setprecision(2) << ms << " ms com " << jobs.laneCount() << " threads, "
+		 << raster.stats().rasterized << " triângulos rasterizados, " << raster.stats().fragments << " fragmentos" << defaultfloat << endl;
+
+	vector<uint8_t> pixels;
+	raster.readPixels(pixels);
+	if (!writeImage(outPath, scene, pixels))
+		return 1;
+
+	if (benchFrames > 0)
+	{
+		// Escalabilidade: o mesmo frame com 1, 2, 4, ... threads
+		unsigned maxThreads = jobs.laneCount();
+		cout << "Benchmark: " << benchFrames << " frames" << endl;
+		for (unsigned threads = 1;; threads = min(threads * 2, maxThreads))
+		{
+			JobSystem benchJobs(threads);
+			SoftRasterizer benchRaster(benchJobs);
+			benchRaster.resize(scene.width, scene.height);
+			scene.render(benchRaster); // aquecimento (aloca os buffers)
+			Clock::time_point benchStart = Clock::now();
+			for (int f = 0; f < benchFrames; ++f)
+				scene.render(benchRaster);
+			double frameMs = chrono::duration<double, milli>(Clock::now() - benchStart).count() / benchFrames;
+			cout << "  " << setw(3) << threads << " threads: " << fixed << setprecision(2) << setw(8) << frameMs << " ms/frame, "
+				 << setw(7) << triangles / frameMs / 1000.0 << " Mtri/s, "
+				 << setw(7) << benchRaster.stats().fragments / frameMs / 1000.0 << " Mfrag/s" << defaultfloat << endl;
+			if (threads == maxThreads)
+				break;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,257 @@
+/*
+ * SpatialHash.h - grade uniforme com hash para seleção de objetos por raio
+ *
+ * Cada objeto é uma esfera envolvente (centro, raio) registrada em todas as células
+ * de tamanho 'cellSize' que a caixa dela toca; só as células ocupadas existem
+ * (unordered_map da coordenada da célula para a lista de objetos). Com células do
+ * tamanho dos objetos, cada célula tem poucos deles.
+ *
+ * raycast percorre as células atravessadas pelo raio em ordem (DDA de Amanatides &
+ * Woo), dentro da caixa das células ocupadas, e testa só os objetos delas; para
+ * assim que o hit mais próximo encontrado está antes da saída da célula atual. Um
+ * objeto em várias células é testado uma vez por consulta (carimbo por objeto).
+ *
+ * update(i, ...) move um objeto: se as células que ele toca não mudaram (o caso
+ * comum entre um frame e outro), não faz nada.
+ *
+ * Uso:
+ *   SpatialHash grid(2.0f);
+ *   grid.insert(i, center, radius);              // i = 0, 1, 2, ... (índice do objeto)
+ *   grid.update(i, newCenter, radius);
+ *   float t; int hit = grid.raycast(origin, dir, maxT, t, test);
+ *   // test(i, origin, dir, t) -> bool: interseção exata com o objeto i (t na saída)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class SpatialHash
+{
+public:
+	explicit SpatialHash(float size = 2.0f) : cellSize(size), invCellSize(1.0f / size) {}
+
+	void clear()
+	{
+		cells.clear();
+		objects.clear();
+		stamps.clear();
+		boundsMin = glm::ivec3(INT32_MAX);
+		boundsMax = glm::ivec3(INT32_MIN);
+	}
+
+	void setCellSize(float size)
+	{
+		clear();
+		cellSize = size;
+		invCellSize = 1.0f / size;
+	}
+
+	float getCellSize() const { return cellSize; }
+	size_t size() const { return objects.size(); }
+	size_t cellCount() const { return cells.size(); }
+
+	// Os índices são densos: inserir i cria os objetos 0..i que faltarem (vazios)
+	void insert(uint32_t index, const glm::vec3 &center, float radius)
+	{
+		if (index >= objects.size())
+		{
+			objects.resize(index + 1);
+			stamps.resize(index + 1, 0);
+		}
+		Object &o = objects[index];
+		o.minCell = cellOf(center - glm::vec3(radius));
+		o.maxCell = cellOf(center + glm::vec3(radius));
+		o.center = center;
+		o.radius = radius;
+		o.present = true;
+		forEachCell(o, [&](uint64_t key)
+					{ cells[key].push_back(index); });
+		boundsMin = glm::min(boundsMin, o.minCell);
+		boundsMax = glm::max(boundsMax, o.maxCell);
+	}
+
+	void remove(uint32_t index)
+	{
+		if (index >= objects.size() || !objects[index].present)
+			return;
+		Object &o = objects[index];
+		forEachCell(o, [&](uint64_t key)
+					{
+			auto it = cells.find(key);
+			std::vector<uint32_t> &list = it->second;
+			auto pos = std::find(list.begin(), list.end(), index);
+			*pos = list.back(); // a ordem dentro da célula não importa
+			list.pop_back();
+			if (list.empty())
+				cells.erase(it); });
+		o.present = false;
+	}
+
+	void update(uint32_t index, const glm::vec3 &center, float radius)
+	{
+		if (index < objects.size() && objects[index].present)
+		{
+			Object &o = objects[index];
+			if (o.minCell == cellOf(center - glm::vec3(radius)) && o.maxCell == cellOf(center + glm::vec3(radius)))
+			{
+				o.center = center;
+				o.radius = radius;
+				return;
+			}
+			remove(index);
+		}
+		insert(index, center, radius);
+	}
+
+	// Objeto mais próximo atingido pelo raio em [0, maxT] (-1 se nenhum) e o t dele;
+	// 'dir' não precisa ser normalizado (t é em unidades de dir).
+	// test(i, origin, dir, t) faz a interseção exata (ex.: caixa orientada do objeto);
+	// só é chamado para objetos cuja esfera o raio atinge antes do melhor hit atual
+	template <typename Test>
+	int raycast(const glm::vec3 &origin, const glm::vec3 &dir, float maxT, float &tHit, Test &&test)
+	{
+		tHit = maxT;
+		if (cells.empty())
+			return -1;
+		if (++currentStamp == 0)
+		{
+			std::fill(stamps.begin(), stamps.end(), 0);
+			currentStamp = 1;
+		}
+
+		// Recorta o raio na caixa das células ocupadas (pode ter sobrado folga de
+		// objetos removidos, o que só custa células vazias)
+		glm::vec3 boxMin = glm::vec3(boundsMin) * cellSize, boxMax = glm::vec3(boundsMax + glm::ivec3(1)) * cellSize;
+		float tEnter = 0.0f, tExit = maxT;
+		for (int a = 0; a < 3; ++a)
+		{
+			if (std::abs(dir[a]) < 1e-12f)
+			{
+				if (origin[a] < boxMin[a] || origin[a] > boxMax[a])
+					return -1;
+				continue;
+			}
+			float t1 = (boxMin[a] - origin[a]) / dir[a], t2 = (boxMax[a] - origin[a]) / dir[a];
+			tEnter = std::max(tEnter, std::min(t1, t2));
+			tExit = std::min(tExit, std::max(t1, t2));
+		}
+		if (tEnter > tExit)
+			return -1;
+
+		// DDA: célula inicial, passo e t da próxima fronteira em cada eixo
+		glm::vec3 start = origin + dir * tEnter;
+		glm::ivec3 cell = glm::clamp(cellOf(start), boundsMin, boundsMax);
+		glm::ivec3 step;
+		glm::vec3 tNext, tDelta;
+		for (int a = 0; a < 3; ++a)
+		{
+			if (dir[a] > 0.0f)
+			{
+				step[a] = 1;
+				tDelta[a] = cellSize / dir[a];
+				tNext[a] = ((cell[a] + 1) * cellSize - origin[a]) / dir[a];
+			}
+			else if (dir[a] < 0.0f)
+			{
+				step[a] = -1;
+				tDelta[a] = -cellSize / dir[a];
+				tNext[a] = (cell[a] * cellSize - origin[a]) / dir[a];
+			}
+			else
+			{
+				step[a] = 0;
+				tDelta[a] = tNext[a] = 1e30f;
+			}
+		}
+
+		int best = -1;
+		while (true)
+		{
+			auto it = cells.find(key(cell));
+			if (it != cells.end())
+			{
+				for (uint32_t index : it->second)
+				{
+					if (stamps[index] == currentStamp)
+						continue;
+					stamps[index] = currentStamp;
+					const Object &o = objects[index];
+					float t;
+					if (raySphere(origin, dir, o.center, o.radius, t) && t < tHit && test(index, origin, dir, t) && t < tHit)
+					{
+						tHit = t;
+						best = (int)index;
+					}
+				}
+			}
+
+			// Próxima célula pelo eixo da fronteira mais próxima
+			int axis = tNext.x < tNext.y ? (tNext.x < tNext.z ? 0 : 2) : (tNext.y < tNext.z ? 1 : 2);
+			float cellExit = tNext[axis];
+			if (tHit <= cellExit || cellExit > tExit)
+				break;
+			cell[axis] += step[axis];
+			tNext[axis] += tDelta[axis];
+		}
+		return best;
+	}
+
+private:
+	struct Object
+	{
+		glm::ivec3 minCell, maxCell;
+		glm::vec3 center;
+		float radius = 0.0f;
+		bool present = false;
+	};
+
+	float cellSize, invCellSize;
+	std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+	std::vector<Object> objects;
+	std::vector<uint32_t> stamps; // última consulta que testou cada objeto
+	uint32_t currentStamp = 0;
+	glm::ivec3 boundsMin = glm::ivec3(INT32_MAX), boundsMax = glm::ivec3(INT32_MIN);
+
+	glm::ivec3 cellOf(const glm::vec3 &p) const
+	{
+		return glm::ivec3((int)std::floor(p.x * invCellSize), (int)std::floor(p.y * invCellSize), (int)std::floor(p.z * invCellSize));
+	}
+
+	// 21 bits por eixo (células de -1M a +1M)
+	static uint64_t key(const glm::ivec3 &c)
+	{
+		return ((uint64_t)(c.x & 0x1FFFFF) << 42) | ((uint64_t)(c.y & 0x1FFFFF) << 21) | (uint64_t)(c.z & 0x1FFFFF);
+	}
+
+	template <typename Fn>
+	void forEachCell(const Object &o, Fn &&fn) const
+	{
+		for (int z = o.minCell.z; z <= o.maxCell.z; ++z)
+			for (int y = o.minCell.y; y <= o.maxCell.y; ++y)
+				for (int x = o.minCell.x; x <= o.maxCell.x; ++x)
+					fn(key(glm::ivec3(x, y, z)));
+	}
+
+	// Primeira interseção com t >= 0 (0 se a origem está dentro da esfera)
+	static bool raySphere(const glm::vec3 &origin, const glm::vec3 &dir, const glm::vec3 &center, float radius, float &t)
+	{
+		glm::vec3 oc = origin - center;
+		float a = glm::dot(dir, dir), b = glm::dot(oc, dir), c = glm::dot(oc, oc) - radius * radius;
+		float discriminant = b * b - a * c;
+		if (discriminant < 0.0f)
+			return false;
+		float root = std::sqrt(discriminant);
+		float far = (-b + root) / a;
+		if (far < 0.0f)
+			return false;
+		t = std::max((-b - root) / a, 0.0f);
+		return true;
+	}
+};
@@ -30,91 +30,61 @@ using namespace std;
 using namespace glm;
 
 #include <cmath>
+#include <vector>
+
+#include "Mesh.h"
+#include "LOD.h"
+#include "GLExtensions.h"
+#include "ShaderManager.h"
+#include "Material.h"
+#include "RenderOnDemand.h"
+#include "FramePacer.h"
 
 // Protótipo da função de callback de teclado
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 
 // Protótipos das funções
-int setupShader();
 int setupGeometry();
 GLuint loadTexture(string filePath, int &width, int &height);
 
-void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, int nVertices, vec3 color= vec3(1.0,0.0,0.0), vec3 axis = (vec3(0.0, 0.0, 1.0)));
-GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVertices);
+void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, int nIndices, vec3 color= vec3(1.0,0.0,0.0), vec3 axis = (vec3(0.0, 0.0, 1.0)));
  
 // Dimensões da janela (pode ser alterado em tempo de execução)
 const GLuint WIDTH = 800, HEIGHT = 800;
 
-// Código fonte do Vertex Shader (em GLSL): ainda hardcoded
-const GLchar *vertexShaderSource = R"(
-#version 400
-layout (location = 0) in vec3 position;
-layout (location = 1) in vec3 color;
-layout (location = 2) in vec3 normal;
-layout (location = 3) in vec2 texc;
-
-uniform mat4 projection;
-uniform mat4 model;
-
-out vec2 texCoord;
-out vec3 vNormal;
-out vec4 fragPos; 
-out vec4 vColor;
-void main()
-{
-   	gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
-	fragPos = model * vec4(position.x, position.y, position.z, 1.0);
-	texCoord = texc;
-	vNormal = normal;
-	vColor = vec4(color,1.0);
-})";
-
-// Código fonte do Fragment Shader (em GLSL): ainda hardcoded
-const GLchar *fragmentShaderSource = R"(
-#version 400
-in vec2 texCoord;
-uniform sampler2D texBuff;
-uniform vec3 lightPos;
-uniform vec3 camPos;
-uniform float ka;
-uniform float kd;
-uniform float ks;
-uniform float q;
-out vec4 color;
-in vec4 fragPos;
-in vec3 vNormal;
-in vec4 vColor;
-void main()
-{
-
-	vec3 lightColor = vec3(1.0,1.0,1.0);
-	//vec4 objectColor = texture(texBuff,texCoord);
-	vec4 objectColor = vColor;
+// Níveis de detalhe da esfera (segmentos de latitude e longitude), do mais fino ao mais grosso
+const int NUM_SPHERE_LODS = 4;
+const int sphereLODSegments[NUM_SPHERE_LODS] = {64, 32, 16, 8};
 
-	//Coeficiente de luz ambiente
-	vec3 ambient = ka * lightColor;
+// Escala da esfera, alterada pelas setas para cima/baixo (muda o tamanho na tela e o LOD)
+float sphereScale = 1.0f;
 
-	//Coeficiente de reflexão difusa
-	vec3 N = normalize(vNormal);
-	vec3 L = normalize(lightPos - vec3(fragPos));
-	float diff = max(dot(N, L),0.0);
-	vec3 diffuse = kd * diff * lightColor;
+// Textura da esfera ligada pela tecla T (o caminho de textura que antes ficava comentado no shader)
+bool sphereTextured = false;
 
-	//Coeficiente de reflexão especular
-	vec3 R = normalize(reflect(-L,N));
-	vec3 V = normalize(camPos - vec3(fragPos));
-	float spec = max(dot(R,V),0.0);
-	spec = pow(spec,q);
-	vec3 specular = ks * spec * lightColor; 
-
-	vec3 result = (ambient + diffuse) * vec3(objectColor) + specular;
-	color = vec4(result,1.0);
-
-})";
+// Alguma tecla mudou a cena desde o último frame (redesenho com --redraw on-demand)
+bool sceneChanged = false;
 
 // Função MAIN
-int main()
+//   --redraw on-demand  só desenha quando algo muda (tecla, shader recarregado)
+//   --present M  vsync (padrão), adaptive, uncapped ou N (limite de N fps; ver FramePacer.h)
+//   --pacing low-latency  com vsync, atrasa o início do frame para reduzir a latência
+int main(int argc, char **argv)
 {
+	bool onDemandEnabled = false, lowLatencyPacing = false;
+	FramePacer::Mode presentMode = FramePacer::PRESENT_VSYNC;
+	double fpsCap = 0.0;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		string arg = argv[i];
+		if (arg == "--redraw")
+			onDemandEnabled = string(argv[i + 1]) == "on-demand";
+		else if (arg == "--present" && !FramePacer::parseMode(argv[i + 1], presentMode, fpsCap))
+			cout << "Modo de apresentação desconhecido: " << argv[i + 1] << " (use vsync, adaptive, uncapped ou um número de fps)" << endl;
+		else if (arg == "--pacing")
+			lowLatencyPacing = string(argv[i + 1]) == "low-latency";
+	}
+
 	// Inicialização da GLFW
 	glfwInit();
 
@@ -143,6 +113,7 @@ int main()
 	{
 		std::cout << "Failed to initialize GLAD" << std::endl;
 	}
+	glext::load();
 
 	// Obtendo as informações de versão
 	const GLubyte *renderer = glGetString(GL_RENDERER); /* get renderer string */
@@ -155,71 +126,132 @@ int main()
 	glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
 
-	// Compilando e buildando o programa de shader
-	GLuint shaderID = setupShader();
+	// Compilando e buildando o programa de shader: variante do uber-shader pedida pelo
+	// material (arquivos em assets/shaders, com cache do programa linkado entre execuções)
+	ShaderManager shaders;
+	ShaderPermutations permutations(shaders);
+	Material sphereMaterial;
+	sphereMaterial.color = vec3(1.0f, 0.0f, 0.0f);
+	sphereMaterial.ambient = 0.1f;
+	sphereMaterial.diffuse = 0.5f;
+	sphereMaterial.specular = 0.5f;
+	sphereMaterial.shininess = 10.0f;
+	permutations.prepare({sphereMaterial.features(false)});
+	shaders.printStats();
+	shaders.enableHotReload(); // edite assets/shaders/uber.* com o programa aberto
+
+	// Gerando a geometria da esfera em vários níveis de detalhe (indexada e reaproveitada
+	// entre pedidos iguais), com o erro de cada nível em relação ao mais detalhado
+	// Os vértices usam o formato compacto (16 bytes: posição snorm16, textura half, normal octaédrica)
+	const Mesh *sphereMeshes[NUM_SPHERE_LODS];
+	float sphereErrors[NUM_SPHERE_LODS];
+	for (int l = 0; l < NUM_SPHERE_LODS; l++)
+	{
+		int segments = sphereLODSegments[l];
+		sphereMeshes[l] = &getSphereMesh(0.5, segments, segments);
+		sphereErrors[l] = sphereTessellationError(0.5f, segments, segments) - sphereTessellationError(0.5f, sphereLODSegments[0], sphereLODSegments[0]);
+	}
 
-	// Gerando um buffer simples, com a geometria de um triângulo
-	int nVertices;
-	GLuint VAO = generateSphere(0.5, 16, 16, nVertices);
+	// Projeção ortográfica com altura 2 (ver 'projection' abaixo)
+	LODSelector lodSelector = LODSelector::forOrtho(2.0f, (float)height);
+	int sphereLOD = 0;
 
 	// Carregando uma textura e armazenando seu id
 	int imgWidth, imgHeight;
 	GLuint texID = loadTexture("../assets/tex/pixelWall.png",imgWidth,imgHeight);
 
-	float ka = 0.1, kd =0.5, ks = 0.5, q = 10.0;
 	vec3 lightPos = vec3(0.6, 1.2, -0.5);
 	vec3 camPos = vec3(0.0,0.0,-3.0);
 
 
-	glUseProgram(shaderID);
+	// Uniforms que não mudam durante a execução (enviados a cada troca de programa:
+	// variante nova ou shader recarregado)
+	GLuint shaderID = 0;
+	auto setupProgram = [&]()
+	{
+		glUseProgram(shaderID);
 
-	// Enviar a informação de qual variável armazenará o buffer da textura
-	glUniform1i(glGetUniformLocation(shaderID, "texBuff"), 0);
+		glUniform3f(glGetUniformLocation(shaderID, "lightPos"), lightPos.x,lightPos.y,lightPos.z);
+		glUniform3f(glGetUniformLocation(shaderID, "viewPos"), camPos.x,camPos.y,camPos.z);
+		glUniform3f(glGetUniformLocation(shaderID, "lightColor"), 1.0f, 1.0f, 1.0f);
 
-	glUniform1f(glGetUniformLocation(shaderID, "ka"), ka);
-	glUniform1f(glGetUniformLocation(shaderID, "kd"), kd);
-	glUniform1f(glGetUniformLocation(shaderID, "ks"), ks);
-	glUniform1f(glGetUniformLocation(shaderID, "q"), q);
-	glUniform3f(glGetUniformLocation(shaderID, "lightPos"), lightPos.x,lightPos.y,lightPos.z);
-	glUniform3f(glGetUniformLocation(shaderID, "camPos"), camPos.x,camPos.y,camPos.z);
 
-	//Ativando o primeiro buffer de textura da OpenGL
-	glActiveTexture(GL_TEXTURE0);
-	
+		// Matriz de projeção paralela ortográfica
+		// mat4 projection = ortho(-10.0, 10.0, -10.0, 10.0, -1.0, 1.0);
+		mat4 projection = ortho(-1.0, 1.0, -1.0, 1.0, -3.0, 3.0);
+		glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
 
-	// Matriz de projeção paralela ortográfica
-	// mat4 projection = ortho(-10.0, 10.0, -10.0, 10.0, -1.0, 1.0);
-	mat4 projection = ortho(-1.0, 1.0, -1.0, 1.0, -3.0, 3.0);
-	glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+		// Matriz de modelo: transformações na geometria (objeto)
+		mat4 model = mat4(1); // matriz identidade
+		glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
+		glUniformMatrix4fv(glGetUniformLocation(shaderID, "view"), 1, GL_FALSE, value_ptr(mat4(1)));
+	};
 
-	// Matriz de modelo: transformações na geometria (objeto)
-	mat4 model = mat4(1); // matriz identidade
-	glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
+	RenderOnDemand onDemand(window, onDemandEnabled);
+	FramePacer pacer;
+	pacer.setup(presentMode, fpsCap, lowLatencyPacing);
 
 	// Loop da aplicação - "game loop"
 	while (!glfwWindowShouldClose(window))
 	{
+		pacer.waitForFrame(); // limite de fps ou atraso de baixa latência
+
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
-		glfwPollEvents();
+		// (no modo sob demanda, dorme até chegar um se nada mudou)
+		onDemand.waitEvents();
+
+		// Variante do material (a tecla T liga/desliga a textura); muda também quando os
+		// arquivos de shader são alterados e a nova versão linka
+		if (shaders.update())
+			onDemand.invalidate();
+		sphereMaterial.texture = sphereTextured ? texID : 0;
+		GLuint program = permutations.get(sphereMaterial.features(false));
+		if (program != shaderID)
+		{
+			shaderID = program;
+			setupProgram();
+			onDemand.invalidate();
+		}
+		if (sceneChanged)
+		{
+			sceneChanged = false;
+			onDemand.invalidate();
+		}
+		onDemand.setAnimating(shaders.reloadPending());
+		if (!onDemand.beginFrame())
+		{
+			pacer.skipFrame();
+			continue;
+		}
 
 		// Limpa o buffer de cor
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
 		glClear(GL_COLOR_BUFFER_BIT);
 
+		// Escolhe o nível de detalhe pelo erro projetado na tela
+		int newLOD = lodSelector.select(sphereErrors, NUM_SPHERE_LODS, sphereScale, 0.0f, sphereLOD);
+		if (newLOD != sphereLOD)
+		{
+			sphereLOD = newLOD;
+			cout << "Esfera: LOD " << sphereLOD << " (" << sphereMeshes[sphereLOD]->indexCount / 3 << " triângulos, " << sphereMeshes[sphereLOD]->byteSize() << " bytes)" << endl;
+		}
+		const Mesh &sphere = *sphereMeshes[sphereLOD];
+		GLuint VAO = sphere.VAO;
+
 		glBindVertexArray(VAO); // Conectando ao buffer de geometria
-		glBindTexture(GL_TEXTURE_2D, texID); //conectando com o buffer de textura que será usado no draw
+		ShaderPermutations::applyMaterial(shaderID, sphereMaterial); // conecta a textura, se o material usa
+		setVertexDecodeUniforms(shaderID, sphere); // posição quantizada na AABB e normal octaédrica
 
-		// Primeiro Triângulo
-		drawGeometry(shaderID, VAO, vec3(0, 0, 0), vec3(1, 1, 1), 0.0, nVertices);
+		// Esfera
+		drawGeometry(shaderID, VAO, vec3(0, 0, 0), vec3(sphereScale), 0.0, sphere.indexCount, sphereMaterial.color);
 
 	
 		glBindVertexArray(0); // Desconectando o buffer de geometria
 
 		// Troca os buffers da tela
-		glfwSwapBuffers(window);
+		pacer.present(window);
 	}
-	// Pede pra OpenGL desalocar os buffers
-	glDeleteVertexArrays(1, &VAO);
+	// Os buffers da esfera pertencem ao cache de malhas (getSphereMesh) e são liberados junto com o contexto
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
 	glfwTerminate();
 	return 0;
@@ -232,58 +264,18 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
-}
 
-// Esta função está basntante hardcoded - objetivo é compilar e "buildar" um programa de
-//  shader simples e único neste exemplo de código
-//  O código fonte do vertex e fragment shader está nos arrays vertexShaderSource e
-//  fragmentShader source no iniçio deste arquivo
-//  A função retorna o identificador do programa de shader
-int setupShader()
-{
-	// Vertex shader
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	// Checando erros de compilação (exibição via log no terminal)
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	// Fragment shader
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	// Checando erros de compilação (exibição via log no terminal)
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	// Linkando os shaders e criando o identificador do programa de shader
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	// Checando por erros de linkagem
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success)
-	{
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+	// Setas: aumenta/diminui a esfera
+	if (key == GLFW_KEY_UP && action != GLFW_RELEASE)
+		sphereScale = std::min(sphereScale * 1.1f, 2.0f);
+	if (key == GLFW_KEY_DOWN && action != GLFW_RELEASE)
+		sphereScale = std::max(sphereScale / 1.1f, 0.01f);
 
-	return shaderProgram;
+	// T: liga/desliga a textura (outra variante do uber-shader, compilada no primeiro uso)
+	if (key == GLFW_KEY_T && action == GLFW_PRESS)
+		sphereTextured = !sphereTextured;
+
+	sceneChanged = true;
 }
 
 // Esta função está bastante harcoded - objetivo é criar os buffers que armazenam a
@@ -392,7 +384,7 @@ GLuint loadTexture(string filePath, int &width, int &height)
 	return texID;
 }
 
-void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, int nVertices, vec3 color, vec3 axis)
+void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, int nIndices, vec3 color, vec3 axis)
 {
 	// Matriz de modelo: transformações na geometria (objeto)
 	mat4 model = mat4(1); // matriz identidade
@@ -404,88 +396,8 @@ void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, f
 	model = scale(model, dimensions);
 	glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
 
-	//glUniform4f(glGetUniformLocation(shaderID, "inputColor"), color.r, color.g, color.b, 1.0f); // enviando cor para variável uniform inputColor
-																								//  Chamada de desenho - drawcall
-																								//  Poligono Preenchido - GL_TRIANGLES
-	glDrawArrays(GL_TRIANGLES, 0, nVertices);
+	glUniform3f(glGetUniformLocation(shaderID, "objectColor"), color.r, color.g, color.b); // enviando cor para variável uniform objectColor
+	//  Chamada de desenho - drawcall
+	//  Poligono Preenchido - GL_TRIANGLES (indexado)
+	glDrawElements(GL_TRIANGLES, nIndices, GL_UNSIGNED_INT, 0);
 }
-
-GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVertices) {
-    vector<GLfloat> vBuffer; // Posição + Cor + Normal + UV
-
-    vec3 color = vec3(1.0f, 0.0f, 0.0f); // Laranja
-
-    auto calcPosUVNormal = [&](int lat, int lon, vec3& pos, vec2& uv, vec3& normal) {
-        float theta = lat * pi<float>() / latSegments;
-        float phi = lon * 2.0f * pi<float>() / lonSegments;
-
-        pos = vec3(
-            radius * cos(phi) * sin(theta),
-            radius * cos(theta),
-            radius * sin(phi) * sin(theta)
-        );
-
-        uv = vec2(
-            phi / (2.0f * pi<float>()),  // u
-            theta / pi<float>()          // v
-        );
-
-        // Normal é a posição normalizada (posição/radius)
-        normal = normalize(pos);
-    };
-
-    for (int i = 0; i < latSegments; ++i) {
-        for (int j = 0; j < lonSegments; ++j) {
-            vec3 v0, v1, v2, v3;
-            vec2 uv0, uv1, uv2, uv3;
-            vec3 n0, n1, n2, n3;
-
-            calcPosUVNormal(i, j, v0, uv0, n0);
-            calcPosUVNormal(i + 1, j, v1, uv1, n1);
-            calcPosUVNormal(i, j + 1, v2, uv2, n2);
-            calcPosUVNormal(i + 1, j + 1, v3, uv3, n3);
-
-            // Primeiro triângulo
-            vBuffer.insert(vBuffer.end(), { v0.x, v0.y, v0.z, color.r, color.g, color.b, n0.x, n0.y, n0.z, uv0.x, uv0.y });
-            vBuffer.insert(vBuffer.end(), { v1.x, v1.y, v1.z, color.r, color.g, color.b, n1.x, n1.y, n1.z, uv1.x, uv1.y });
-            vBuffer.insert(vBuffer.end(), { v2.x, v2.y, v2.z, color.r, color.g, color.b, n2.x, n2.y, n2.z, uv2.x, uv2.y });
-
-            // Segundo triângulo
-            vBuffer.insert(vBuffer.end(), { v1.x, v1.y, v1.z, color.r, color.g, color.b, n1.x, n1.y, n1.z, uv1.x, uv1.y });
-            vBuffer.insert(vBuffer.end(), { v3.x, v3.y, v3.z, color.r, color.g, color.b, n3.x, n3.y, n3.z, uv3.x, uv3.y });
-            vBuffer.insert(vBuffer.end(), { v2.x, v2.y, v2.z, color.r, color.g, color.b, n2.x, n2.y, n2.z, uv2.x, uv2.y });
-        }
-    }
-
-    // Criar VAO e VBO
-    GLuint VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
-
-    // Layout da posição (location 0)
-glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(0));
-glEnableVertexAttribArray(0);
-
-// Layout da cor (location 1)
-glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-glEnableVertexAttribArray(1);
-
-// Layout da normal (location 2)
-glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
-glEnableVertexAttribArray(2);
-
-// Layout da UV (location 3)
-glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(9 * sizeof(GLfloat)));
-glEnableVertexAttribArray(3);
-
-    glBindVertexArray(0);
-
-    nVertices = vBuffer.size() / 11; // Cada vértice agora tem 11 floats!
-
-    return VAO;
-}
\ No newline at end of file
@@ -0,0 +1,243 @@
+/*
+ * StreamBuffer.h - buffer para dados dinâmicos reenviados a cada frame
+ *
+ * Modo PERSISTENT_RING: um único buffer imutável (glBufferStorage) com três regiões,
+ * mapeado uma vez com GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT. A CPU escreve
+ * direto na memória mapeada da região do frame atual enquanto a GPU ainda lê as
+ * regiões dos frames anteriores; uma fence por região garante que a CPU só
+ * reescreve uma região depois que a GPU terminou de usá-la.
+ *
+ * Os modos ORPHAN_SUBDATA (glBufferData(NULL) + glBufferSubData) e BUFFER_DATA
+ * (reespecificação completa com glBufferData) escrevem em uma cópia na CPU e a
+ * enviam em unmap(). Servem de alternativa quando o driver não tem
+ * ARB_buffer_storage e de referência para o benchmark "stream".
+ *
+ * Uso por frame:
+ *   size_t offset;
+ *   void *ptr = stream.map(bytes, offset);  // escreve 'bytes' em ptr
+ *   stream.unmap();
+ *   ... desenhos lendo o buffer stream.id() a partir de 'offset' ...
+ *   stream.endFrame();                     // depois dos desenhos
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "GLExtensions.h"
+
+class StreamBuffer
+{
+public:
+	enum Mode
+	{
+		PERSISTENT_RING,
+		ORPHAN_SUBDATA,
+		BUFFER_DATA
+	};
+
+	static const int REGIONS = 3; // triple buffering
+
+	StreamBuffer() {}
+	~StreamBuffer() { destroy(); }
+
+	StreamBuffer(const StreamBuffer &) = delete;
+	StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+	// Cria o buffer com 'regionBytes' disponíveis por frame. Se o modo persistente
+	// for pedido e o driver não suportar (ou o mapeamento falhar), cai para
+	// ORPHAN_SUBDATA.
+	bool create(GLenum bufferTarget, size_t regionBytes, Mode requestedMode)
+	{
+		destroy();
+		target = bufferTarget;
+		mode = requestedMode;
+		if (mode == PERSISTENT_RING && !glext::hasBufferStorage)
+		{
+			std::cout << "StreamBuffer: ARB_buffer_storage indisponível, usando glBufferData + glBufferSubData\n";
+			mode = ORPHAN_SUBDATA;
+		}
+		return allocate(regionBytes);
+	}
+
+	void destroy()
+	{
+		if (buffer == 0)
+			return;
+		waitAll();
+		glBindBuffer(target, buffer);
+		if (mappedBase)
+			glUnmapBuffer(target);
+		glBindBuffer(target, 0);
+		glDeleteBuffers(1, &buffer);
+		buffer = 0;
+		mappedBase = nullptr;
+	}
+
+	// Reserva 'bytes' (alinhado a 'alignment') na região do frame atual e retorna o
+	// ponteiro de escrita. 'offset' recebe a posição dos dados dentro de id().
+	// Se a região não comporta o pedido, o buffer é recriado maior; isso espera a
+	// GPU e descarta as reservas anteriores do mesmo frame, então o crescimento
+	// deve acontecer na primeira reserva do frame.
+	void *map(size_t bytes, size_t &offset, size_t alignment = 256)
+	{
+		size_t start = (head + alignment - 1) / alignment * alignment;
+		if (start + bytes > regionSize)
+		{
+			size_t newSize = regionSize * 2;
+			while (newSize < bytes)
+				newSize *= 2;
+			destroy();
+			allocate(newSize);
+			start = 0;
+		}
+
+		if (mode != PERSISTENT_RING)
+		{
+			// Sem buffer persistente a região é sempre a mesma: o driver renomeia o
+			// armazenamento (orphaning) e cuida da sincronização
+			offset = start;
+			head = start + bytes;
+			pendingStart = start;
+			pendingBytes = bytes;
+			return staging.data() + start;
+		}
+
+		if (head == 0)
+			waitRegion(region);
+
+		offset = (size_t)region * regionSize + start;
+		head = start + bytes;
+		return mappedBase + offset;
+	}
+
+	// Envia os dados escritos desde o último map() (nada a fazer no modo persistente:
+	// o mapeamento é coerente)
+	void unmap()
+	{
+		if (mode == PERSISTENT_RING || pendingBytes == 0)
+			return;
+
+		glBindBuffer(target, buffer);
+		if (mode == BUFFER_DATA)
+		{
+			glBufferData(target, pendingStart + pendingBytes, staging.data(), GL_STREAM_DRAW);
+		}
+		else
+		{
+			if (pendingStart == 0)
+				glBufferData(target, regionSize, nullptr, GL_STREAM_DRAW); // orphaning
+			glBufferSubData(target, pendingStart, pendingBytes, staging.data() + pendingStart);
+		}
+		pendingBytes = 0;
+	}
+
+	// Marca o fim do uso da região atual pela GPU e avança para a próxima
+	void endFrame()
+	{
+		head = 0;
+		if (mode != PERSISTENT_RING)
+			return;
+
+		if (fences[region])
+			glDeleteSync(fences[region]);
+		fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		region = (region + 1) % REGIONS;
+	}
+
+	GLuint id() const { return buffer; }
+	Mode activeMode() const { return mode; }
+	size_t capacity() const { return regionSize; }
+
+	// Quantas vezes a CPU precisou esperar uma fence (GPU atrasada em 2+ frames)
+	uint64_t stalls() const { return stallCount; }
+
+	static const char *modeName(Mode m)
+	{
+		switch (m)
+		{
+		case PERSISTENT_RING:
+			return "persistent ring";
+		case ORPHAN_SUBDATA:
+			return "orphan + glBufferSubData";
+		default:
+			return "glBufferData";
+		}
+	}
+
+private:
+	GLenum target = GL_ARRAY_BUFFER;
+	Mode mode = PERSISTENT_RING;
+	GLuint buffer = 0;
+	size_t regionSize = 0;
+	size_t head = 0;
+	int region = 0;
+
+	uint8_t *mappedBase = nullptr;
+	GLsync fences[REGIONS] = {};
+	uint64_t stallCount = 0;
+
+	std::vector<uint8_t> staging;
+	size_t pendingStart = 0, pendingBytes = 0;
+
+	bool allocate(size_t regionBytes)
+	{
+		regionSize = regionBytes > 0 ? regionBytes : 1;
+		head = 0;
+		region = 0;
+
+		glGenBuffers(1, &buffer);
+		glBindBuffer(target, buffer);
+
+		if (mode == PERSISTENT_RING)
+		{
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glext::glBufferStorage(target, regionSize * REGIONS, nullptr, flags);
+			mappedBase = (uint8_t *)glMapBufferRange(target, 0, regionSize * REGIONS, flags);
+			if (!mappedBase)
+			{
+				// O armazenamento imutável não aceita glBufferData: recria o buffer
+				std::cout << "StreamBuffer: falha ao mapear o buffer persistente, usando glBufferData + glBufferSubData\n";
+				glBindBuffer(target, 0);
+				glDeleteBuffers(1, &buffer);
+				buffer = 0;
+				mode = ORPHAN_SUBDATA;
+				return allocate(regionBytes);
+			}
+		}
+		else
+		{
+			staging.resize(regionSize);
+			glBufferData(target, regionSize, nullptr, GL_STREAM_DRAW);
+		}
+
+		glBindBuffer(target, 0);
+		return true;
+	}
+
+	void waitRegion(int r)
+	{
+		if (!fences[r])
+			return;
+
+		GLenum result = glClientWaitSync(fences[r], 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED)
+		{
+			++stallCount;
+			do
+			{
+				result = glClientWaitSync(fences[r], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+			} while (result == GL_TIMEOUT_EXPIRED);
+		}
+		glDeleteSync(fences[r]);
+		fences[r] = nullptr;
+	}
+
+	void waitAll()
+	{
+		for (int r = 0; r < REGIONS; ++r)
+			waitRegion(r);
+	}
+};
@@ -0,0 +1,298 @@
+/*
+ * TiledLighting.h - forward com muitas luzes: lista de luzes por tile de tela
+ *
+ * A tela é dividida em tiles de TILE_SIZE x TILE_SIZE pixels. A cada frame as luzes
+ * pontuais são distribuídas pelos tiles cujo frustum (4 planos laterais + near/far
+ * da câmera) elas alcançam, e o uber-shader com TILED_LIGHTS (Material.h) percorre
+ * só as luzes do tile do fragmento. Diferente do deferred (DeferredRenderer.h), os
+ * materiais continuam forward: névoa, transparência e MSAA funcionam como antes.
+ *
+ * Buffers (SSBO, assets/shaders/tiled_lights.glsl):
+ *   binding 0  luzes (LightData, 32 bytes cada), da mais próxima da câmera à mais distante
+ *   binding 1  por tile: quantidade + até MAX_LIGHTS_PER_TILE índices
+ *   binding 2  contador de tiles que transbordaram (só no compute shader)
+ *
+ * A distribuição roda em um compute shader (light_culling.comp, um grupo por tile)
+ * quando o driver tem GL 4.3 / ARB_compute_shader; senão na CPU, projetando a
+ * esfera de cada luz na tela e marcando os tiles do retângulo. Até
+ * MAX_LIGHTS_PER_TILE luzes por tile o teste é conservador (luz demais num tile só
+ * custa tempo, nunca imagem). Sem profundidade por tile, um tile recebe toda luz
+ * na sua coluna até o far, e com muitas luzes a lista enche: as excedentes são
+ * descartadas e faltam na imagem. O descarte é determinístico nos dois caminhos:
+ * as luzes vão ordenadas pela distância à câmera e ficam as mais próximas (as
+ * distantes, cortadas, costumam pesar menos e a imagem não pisca de um frame para
+ * o outro). overflowTiles() conta os tiles em que isso aconteceu.
+ *
+ * Requer glext::hasShaderStorage (SSBO nos shaders #version 400).
+ *
+ * Uso por frame:
+ *   tiled.cull(lights, projection, view);
+ *   ... programas com TILED_LIGHTS: tiled.setUniforms(program) e desenhos ...
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "GLExtensions.h"
+#include "Lights.h"
+#include "ShaderManager.h"
+
+class TiledLighting
+{
+public:
+	// Os mesmos valores de assets/shaders/tiled_lights.glsl
+	static const int TILE_SIZE = 16;
+	static const int MAX_LIGHTS_PER_TILE = 255;
+	static const int TILE_STRIDE = MAX_LIGHTS_PER_TILE + 1;
+
+	TiledLighting() {}
+	~TiledLighting() { release(); }
+
+	TiledLighting(const TiledLighting &) = delete;
+	TiledLighting &operator=(const TiledLighting &) = delete;
+
+	bool create(ShaderManager &shaderManager, int w, int h)
+	{
+		release();
+		if (!glext::hasShaderStorage)
+		{
+			std::cout << "Tiled lighting indisponível: o driver não tem SSBO (GL 4.3 / ARB_shader_storage_buffer_object)" << std::endl;
+			return false;
+		}
+		shaders = &shaderManager;
+		width = w;
+		height = h;
+		tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+		tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+		glGenBuffers(1, &lightBuffer);
+		glGenBuffers(1, &tileBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, tileBufferSize(), nullptr, GL_DYNAMIC_DRAW);
+		glGenBuffers(1, &overflowBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, overflowBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glGenBuffers(1, &overflowReadback);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, overflowReadback);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(GLuint), nullptr, GL_STREAM_READ);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		overflowCount = 0;
+		overflowWarned = false;
+
+		computeCulling = glext::hasComputeShader && shaders->loadCompute("light_culling.comp") != 0;
+		std::cout << "Tiled lighting: " << tilesX << "x" << tilesY << " tiles de " << TILE_SIZE << " px, distribuição "
+				  << (computeCulling ? "no compute shader" : "na CPU") << std::endl;
+		return true;
+	}
+
+	void release()
+	{
+		if (lightBuffer == 0)
+			return;
+		if (overflowFence)
+			glDeleteSync(overflowFence);
+		overflowFence = 0;
+		glDeleteBuffers(1, &lightBuffer);
+		glDeleteBuffers(1, &tileBuffer);
+		glDeleteBuffers(1, &overflowBuffer);
+		glDeleteBuffers(1, &overflowReadback);
+		lightBuffer = tileBuffer = overflowBuffer = overflowReadback = 0;
+	}
+
+	// Envia as luzes e monta as listas por tile para a câmera do frame
+	void cull(const std::vector<PointLight> &unsortedLights, const glm::mat4 &projection, const glm::mat4 &view)
+	{
+		// Mais próximas primeiro (pela superfície da esfera; empate pelo índice): as
+		// listas cheias ficam com as mesmas luzes em todo frame
+		glm::vec3 eye = glm::vec3(glm::inverse(view)[3]);
+		lightOrder.resize(unsortedLights.size());
+		for (size_t i = 0; i < unsortedLights.size(); ++i)
+			lightOrder[i] = {glm::length(unsortedLights[i].position - eye) - unsortedLights[i].radius, (uint32_t)i};
+		std::sort(lightOrder.begin(), lightOrder.end());
+		sortedLights.resize(unsortedLights.size());
+		for (size_t i = 0; i < lightOrder.size(); ++i)
+			sortedLights[i] = unsortedLights[lightOrder[i].second];
+		const std::vector<PointLight> &lights = sortedLights;
+
+		packLights(lights, lightData);
+		if (lightData.empty())
+			lightData.push_back(LightData{glm::vec4(0.0f), glm::vec4(0.0f)}); // buffer vazio não pode ser ligado
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, lightData.size() * sizeof(LightData), lightData.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		// Planos near/far da projeção perspectiva
+		float nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+		float farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+
+		bind();
+		if (computeCulling)
+		{
+			GLuint program = shaders->loadCompute("light_culling.comp");
+			glUseProgram(program);
+			glm::mat4 invProjection = glm::inverse(projection);
+			glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(view));
+			glUniformMatrix4fv(glGetUniformLocation(program, "invProjection"), 1, GL_FALSE, glm::value_ptr(invProjection));
+			glUniform2f(glGetUniformLocation(program, "screenSize"), (float)width, (float)height);
+			glUniform1f(glGetUniformLocation(program, "nearPlane"), nearPlane);
+			glUniform1f(glGetUniformLocation(program, "farPlane"), farPlane);
+			glUniform1ui(glGetUniformLocation(program, "lightCount"), (GLuint)lights.size());
+			setUniforms(program);
+
+			// Contador de transbordamento: zerado a cada dispatch e copiado para um
+			// buffer lido só quando a fence indica que a GPU terminou (sem esperar)
+			pollOverflow();
+			const GLuint zero = 0;
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, overflowBuffer);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, overflowBuffer);
+
+			glext::glDispatchCompute((GLuint)tilesX, (GLuint)tilesY, 1);
+			// Os fragment shaders leem a lista; glCopyBufferSubData lê o contador
+			glext::glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+			if (overflowFence == 0)
+			{
+				glBindBuffer(GL_COPY_READ_BUFFER, overflowBuffer);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, overflowReadback);
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(GLuint));
+				glBindBuffer(GL_COPY_READ_BUFFER, 0);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+				overflowFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			}
+		}
+		else
+		{
+			cullOnCPU(lights, projection, view, nearPlane, farPlane);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileBuffer);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, tileBufferSize(), tileData.data(), GL_STREAM_DRAW);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		}
+	}
+
+	// Liga os buffers nos bindings 0 e 1 (estado global, vale para todos os programas)
+	void bind() const
+	{
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lightBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, tileBuffer);
+	}
+
+	// Uniforms de tiled_lights.glsl; o programa deve estar em uso
+	void setUniforms(GLuint program) const
+	{
+		glUniform2i(glGetUniformLocation(program, "tileCount"), tilesX, tilesY);
+	}
+
+	bool usesCompute() const { return computeCulling; }
+
+	// Tiles com mais de MAX_LIGHTS_PER_TILE luzes no último resultado conhecido (no
+	// compute shader, de alguns frames atrás)
+	int overflowTiles() const { return overflowCount; }
+
+private:
+	ShaderManager *shaders = nullptr;
+	int width = 0, height = 0;
+	int tilesX = 0, tilesY = 0;
+	bool computeCulling = false;
+
+	GLuint lightBuffer = 0, tileBuffer = 0;
+	GLuint overflowBuffer = 0, overflowReadback = 0;
+	GLsync overflowFence = 0;
+	int overflowCount = 0;
+	bool overflowWarned = false;
+	std::vector<std::pair<float, uint32_t>> lightOrder;
+	std::vector<PointLight> sortedLights;
+	std::vector<LightData> lightData;
+	std::vector<uint32_t> tileData;		// só no caminho da CPU
+	std::vector<uint8_t> tileOverflow; // idem: tile com luzes descartadas
+
+	// Lê o contador da GPU se a cópia já terminou
+	void pollOverflow()
+	{
+		if (overflowFence == 0)
+			return;
+		GLenum result = glClientWaitSync(overflowFence, 0, 0);
+		if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+			return;
+		glDeleteSync(overflowFence);
+		overflowFence = 0;
+		GLuint count = 0;
+		glBindBuffer(GL_COPY_READ_BUFFER, overflowReadback);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(GLuint), &count);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		setOverflow((int)count);
+	}
+
+	void setOverflow(int count)
+	{
+		overflowCount = count;
+		if (count > 0 && !overflowWarned)
+		{
+			std::cout << "Tiled lighting: " << count << " tiles com mais de " << MAX_LIGHTS_PER_TILE
+					  << " luzes; ficam as mais próximas da câmera" << std::endl;
+			overflowWarned = true;
+		}
+	}
+
+	size_t tileBufferSize() const { return (size_t)tilesX * tilesY * TILE_STRIDE * sizeof(uint32_t); }
+
+	// Retângulo de tiles coberto pela AABB (em coordenadas de câmera) de cada esfera.
+	// Esferas que cruzam o near plane cobrem a tela inteira. As luzes chegam da mais
+	// próxima à mais distante: numa lista cheia, as descartadas são as últimas.
+	void cullOnCPU(const std::vector<PointLight> &lights, const glm::mat4 &projection, const glm::mat4 &view, float nearPlane, float farPlane)
+	{
+		tileData.assign((size_t)tilesX * tilesY * TILE_STRIDE, 0);
+		tileOverflow.assign((size_t)tilesX * tilesY, 0);
+		for (size_t i = 0; i < lights.size(); ++i)
+		{
+			glm::vec3 center = glm::vec3(view * glm::vec4(lights[i].position, 1.0f));
+			float radius = lights[i].radius;
+			if (center.z - radius >= -nearPlane || center.z + radius <= -farPlane)
+				continue; // atrás da câmera ou além do far
+
+			int x0 = 0, y0 = 0, x1 = tilesX - 1, y1 = tilesY - 1;
+			if (center.z + radius < -nearPlane)
+			{
+				glm::vec2 minNdc(1e30f), maxNdc(-1e30f);
+				for (int c = 0; c < 8; ++c)
+				{
+					glm::vec3 corner = center + radius * glm::vec3(c & 1 ? 1.0f : -1.0f, c & 2 ? 1.0f : -1.0f, c & 4 ? 1.0f : -1.0f);
+					glm::vec4 clip = projection * glm::vec4(corner, 1.0f);
+					glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+					minNdc = glm::min(minNdc, ndc);
+					maxNdc = glm::max(maxNdc, ndc);
+				}
+				if (maxNdc.x < -1.0f || maxNdc.y < -1.0f || minNdc.x > 1.0f || minNdc.y > 1.0f)
+					continue;
+				x0 = std::max(0, (int)std::floor((minNdc.x * 0.5f + 0.5f) * width / TILE_SIZE));
+				y0 = std::max(0, (int)std::floor((minNdc.y * 0.5f + 0.5f) * height / TILE_SIZE));
+				x1 = std::min(tilesX - 1, (int)std::floor((maxNdc.x * 0.5f + 0.5f) * width / TILE_SIZE));
+				y1 = std::min(tilesY - 1, (int)std::floor((maxNdc.y * 0.5f + 0.5f) * height / TILE_SIZE));
+			}
+
+			for (int y = y0; y <= y1; ++y)
+			{
+				for (int x = x0; x <= x1; ++x)
+				{
+					uint32_t *tile = &tileData[((size_t)y * tilesX + x) * TILE_STRIDE];
+					if (tile[0] < (uint32_t)MAX_LIGHTS_PER_TILE)
+						tile[1 + tile[0]++] = (uint32_t)i;
+					else
+						tileOverflow[(size_t)y * tilesX + x] = 1;
+				}
+			}
+		}
+		setOverflow((int)std::count(tileOverflow.begin(), tileOverflow.end(), (uint8_t)1));
+	}
+};
@@ -6,8 +6,9 @@
 #include <string>
 #include <cmath>
 #include <unordered_map>
-
-#include "json.hpp"
+#include <unordered_set>
+#include <set>
+#include <atomic>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -20,9 +21,33 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <filesystem>
 
+#include "JobSystem.h"
+#include "DrawList.h"
+#include "GLExtensions.h"
+#include "StreamBuffer.h"
+#include "MeshIO.h"
+#include "Mesh.h"
+#include "LOD.h"
+#include "ShaderManager.h"
+#include "Material.h"
+#include "Lights.h"
+#include "DeferredRenderer.h"
+#include "TiledLighting.h"
+#include "ShadowMap.h"
+#include "DepthPrepass.h"
+#include "SceneSnapshot.h"
+#include "SceneDiff.h"
+#include "FileWatcher.h"
+#include "SpatialHash.h"
+#include "ObjectIdBuffer.h"
+#include "FixedStep.h"
+#include "Camera.h"
+#include "Input.h"
+#include "RenderOnDemand.h"
+#include "FramePacer.h"
+
 using namespace std;
 using namespace glm;
-using json = nlohmann::json;
 
 bool mouseEnabled = true;
 // --- Configurações ---
@@ -30,16 +55,62 @@ const GLuint WIDTH = 800, HEIGHT = 600;
 
 GLFWwindow *window;
 
-// Dados para o cubo
-vector<vec3> positions;
-vector<vec2> texCoords;
-vector<vec3> normals;
+// Luz do caminho forward e névoa opcional (--fog); a névoa tem a cor do fundo
+vec3 lightPos(3.0f, 3.0f, 3.0f);
+vec3 lightColor(1.0f, 1.0f, 1.0f);
+vec3 clearColor(0.1f, 0.1f, 0.1f);
+float fogDistance = 0.0f; // distância em que a névoa cobre tudo (0: sem névoa)
+
+// Luzes pontuais da cena ("lights" no JSON, mais as geradas por --lights). O caminho
+// forward usa só a primeira (lightPos/lightColor); o deferred e o tiled usam todas.
+vector<PointLight> lights;
+vec3 ambientColor(1.0f, 1.0f, 1.0f); // multiplicada pelo ka de cada material
+
+enum RenderPath
+{
+	RENDER_FORWARD,
+	RENDER_DEFERRED,
+	RENDER_TILED
+};
+RenderPath renderPath = RENDER_FORWARD;
+uint32_t pathFeatures = 0; // recursos do uber-shader pedidos pelo caminho (FEATURE_TILED_LIGHTS)
+
+// Listas de luzes por tile do caminho tiled (SSBO + compute shader)
+TiledLighting tiledLighting;
+
+// Sombras da luz lightPos no caminho forward (--shadows cached|always|off; H alterna
+// entre cache e redesenho a cada frame). A camada estática só é redesenhada quando um
+// cubo sem trajetória é movido pelo teclado.
+ShadowMap shadowMap;
+bool shadowsEnabled = true;
+GLuint shadowInstanceBuffer = 0; // matrizes dos cubos da passada de profundidade
+bool shadowBoundsDirty = true;	 // recalcular a esfera que envolve a cena (frustum da luz)
+
+// Pré-passada de profundidade nos caminhos forward e tiled (--prepass off|on|auto,
+// --overdraw L): no modo automático liga quando o overdraw medido passa de L
+DepthPrepass depthPrepass;
+DepthPrepass::Mode prepassMode = DepthPrepass::PREPASS_AUTO;
+float overdrawThreshold = 1.5f;
+bool prepassThisFrame = false;
+
+// Níveis de detalhe da malha do cubo (0 = malha original do OBJ), cada um com seu VAO
+struct LODMesh
+{
+	Mesh mesh;
+	GLuint depthVAO = 0; // só posição + matriz de modelo, para a pré-passada
+	float error; // desvio em relação ao nível 0, em unidades do modelo
+};
+vector<LODMesh> cubeLODs;
+vector<float> cubeLODErrors;
+LODSelector lodSelector;
 
-// Shader
-GLuint shaderProgram;
+// Dados por instância (matriz de modelo + matriz normal), reenviados a cada frame
+// por um ring buffer persistente (ou orphaning, se o driver não suportar)
+StreamBuffer instanceStream;
+StreamBuffer::Mode instanceStreamMode = StreamBuffer::PERSISTENT_RING;
 
-// VAO e VBO
-GLuint VAO, VBO;
+// Formato dos vértices da malha na GPU (ver VertexFormat.h)
+VertexFormat meshVertexFormat = VertexFormat::compact();
 
 // --- Estrutura do Cubo ---
 struct Cube
@@ -47,82 +118,149 @@ struct Cube
 	vec3 position;
 	vec3 rotation; // rotações em graus
 	vec3 scale;
-	GLuint textureID;
+	uint32_t batch; // índice em materials (cubos com o mesmo material são desenhados juntos)
+	int lod = 0;	// nível de detalhe usado no último frame (para a histerese)
+	int trajectory = -1; // índice em trajectories (-1: parado, a não ser pelo teclado)
+	int id = -1;		 // "id" na cena (-1: cópia criada pelo --stress)
+	size_t waypoint = 0; // próximo ponto da trajetória
 };
 
 vector<Cube> cubes;
+
+// Trajetórias do JSON ("trajectory": [[x, y, z], ...]): o cubo percorre a posição
+// inicial e os pontos, em ciclo, com velocidade constante
+vector<vector<vec3>> trajectories;
+float trajectorySpeed = 1.0f; // unidades por segundo
 int selectedCube = 0; // cubo selecionado
 
-// --- Câmera FPS ---
-class Camera
+// Recarga a quente da cena: quando o arquivo muda ele é lido de novo e só os cubos
+// com diferenças (pelo "id", ver SceneDiff.h) são aplicados. As texturas ficam em
+// cache pelo caminho e são reaproveitadas entre recargas.
+string scenePath;
+SceneDescription loadedScene;			 // última versão lida do arquivo
+unordered_map<int, size_t> cubeIndexById; // id -> índice em cubes
+unordered_map<string, GLuint> textureCache;
+FileWatcher sceneWatcher;
+size_t extraLightCount = 0; // --lights, refeitas quando as luzes da cena mudam
+
+// Seleção com o mouse (botão esquerdo): raio da câmera contra uma grade com hash das
+// esferas envolventes dos cubos (SpatialHash.h), atualizada quando eles se movem, e
+// teste exato com a caixa orientada de cada candidato. Com o mouse capturado (M) o
+// raio sai do centro da tela; com o cursor livre, da posição dele.
+SpatialHash pickGrid;
+
+// Com --picking gpu a seleção lê o pixel do clique num buffer de ids desenhado pela
+// GPU (ObjectIdBuffer.h), um frame depois, sem percorrer a cena na CPU
+enum PickMode
 {
-public:
-	vec3 position;
-	float yaw;
-	float pitch;
+	PICK_GRID,
+	PICK_GPU
+};
+PickMode pickMode = PICK_GRID;
+ObjectIdBuffer objectIds;
 
-	Camera(vec3 pos = vec3(0.0f, 0.0f, 3.0f), float y = -90.0f, float p = 0.0f)
-		: position(pos), yaw(y), pitch(p) {}
+// Um material por combinação distinta de textura e parâmetros: cada um vira uma
+// chamada instanciada por nível de detalhe, com a variante do uber-shader que ele pede
+vector<Material> materials;
 
-	mat4 getViewMatrix()
-	{
-		vec3 front;
-		front.x = cos(radians(yaw)) * cos(radians(pitch));
-		front.y = sin(radians(pitch));
-		front.z = sin(radians(yaw)) * cos(radians(pitch));
-		front = normalize(front);
+// Lista de desenho montada pelas threads de trabalho a cada frame
+DrawList drawList;
+float meshRadius = 1.0f; // raio da esfera envolvente do OBJ (para o culling)
+vec3 meshBoundsMin(-0.5f), meshBoundsMax(0.5f); // caixa do OBJ em espaço de modelo
+size_t trianglesDrawn = 0; // triângulos enviados no último frame (estatística de LOD)
 
-		vec3 right = normalize(cross(front, vec3(0.0f, 1.0f, 0.0f)));
-		vec3 up = normalize(cross(right, front));
-
-		return lookAt(position, position + front, up);
-	}
+// --- Câmera FPS (Camera.h) ---
+Camera camera;
 
-	void moveForward(float delta)
-	{
-		vec3 front = getFrontVector();
-		position += delta * front;
-	}
+// Simulação em passo fixo (FixedStep.h): a câmera, o cubo selecionado e as
+// trajetórias avançam numa thread própria a tickRate Hz (--tick-rate), e o render
+// interpola entre os dois últimos passos publicados, sem esperar por ela. As teclas
+// são lidas na thread principal (o GLFW só permite consultar a entrada nela) e
+// repassadas numa máscara atômica; a orientação da câmera segue o mouse no render.
+// A recarga da cena para a simulação enquanto altera os cubos. Com --replay não há
+// thread: cada frame reproduzido avança exatamente um passo, na thread principal,
+// para que a sessão reproduzida não dependa do tempo de cada frame.
+struct CubeTransform
+{
+	vec3 position;
+	vec3 rotation;
+};
 
-	void moveRight(float delta)
-	{
-		vec3 right = getRightVector();
-		position += delta * right;
-	}
+// Estado publicado a cada passo: só os cubos que se movem (trajetória ou teclado)
+struct SimSnapshot
+{
+	bool valid = false;
+	double time = 0.0; // instante de 'current' (FixedStepThread::now())
+	vec3 cameraPrevious, cameraCurrent;
+	vector<uint32_t> indices;				 // índices em cubes
+	vector<CubeTransform> previous, current; // alinhados com indices
+	uint64_t staticEdits = 0;				 // versão dos cubos parados movidos pelo teclado
+};
 
-	void moveUp(float delta)
-	{
-		position.y += delta;
-	}
+// Estado da thread da simulação (só ela o acessa enquanto roda)
+struct SimulationState
+{
+	vec3 cameraPosition;
+	vector<CubeTransform> transforms; // todos os cubos
+	vector<int32_t> slot;			  // cubo -> posição em active (-1: parado)
+	vector<uint32_t> active;		  // cubos em movimento
+	vector<int> trajectory;			  // por cubo de active
+	vector<size_t> waypoint;
+	vector<CubeTransform> previous; // active no passo anterior
+	uint64_t staticEdits = 0;
+};
 
-	void rotate(float deltaYaw, float deltaPitch)
-	{
-		yaw += deltaYaw;
-		pitch += deltaPitch;
+// Ações da entrada (Input.h). As SIM_ACTIONS primeiras são repassadas à simulação,
+// na ordem dos bits de SimInput::keys; as teclas ficam na tabela de ligações (main)
+// e podem ser trocadas com --bindings.
+enum Action
+{
+	MOVE_FORWARD,
+	MOVE_BACK,
+	MOVE_LEFT,
+	MOVE_RIGHT,
+	MOVE_UP,
+	MOVE_DOWN,
+	CUBE_UP,
+	CUBE_DOWN,
+	CUBE_LEFT,
+	CUBE_RIGHT,
+	CUBE_FORWARD,
+	CUBE_BACK,
+	CUBE_ROTATE_X_POS,
+	CUBE_ROTATE_X_NEG,
+	CUBE_ROTATE_Y_POS,
+	CUBE_ROTATE_Y_NEG,
+	CUBE_ROTATE_Z_POS,
+	CUBE_ROTATE_Z_NEG,
+	SIM_ACTIONS,
+	TOGGLE_MOUSE = SIM_ACTIONS,
+	TOGGLE_SHADOW_CACHE,
+	PICK,
+	QUIT,
+	SELECT_1 // SELECT_1 + k seleciona o cubo k (k de 0 a 8)
+};
+const uint32_t CUBE_KEYS = 0xFFFu << CUBE_UP; // setas, R/F e IJKL/U/O
 
-		if (pitch > 89.0f)
-			pitch = 89.0f;
-		if (pitch < -89.0f)
-			pitch = -89.0f;
-	}
+InputSystem input({"move_forward", "move_back", "move_left", "move_right", "move_up", "move_down",
+				   "cube_up", "cube_down", "cube_left", "cube_right", "cube_forward", "cube_back",
+				   "cube_rotate_x+", "cube_rotate_x-", "cube_rotate_y+", "cube_rotate_y-", "cube_rotate_z+", "cube_rotate_z-",
+				   "toggle_mouse", "toggle_shadow_cache", "pick", "quit",
+				   "select_1", "select_2", "select_3", "select_4", "select_5", "select_6", "select_7", "select_8", "select_9"});
 
-private:
-	vec3 getFrontVector()
-	{
-		vec3 front;
-		front.x = cos(radians(yaw)) * cos(radians(pitch));
-		front.y = sin(radians(pitch));
-		front.z = sin(radians(yaw)) * cos(radians(pitch));
-		return normalize(front);
-	}
-	vec3 getRightVector()
-	{
-		vec3 front = getFrontVector();
-		return normalize(cross(front, vec3(0.0f, 1.0f, 0.0f)));
-	}
+struct SimInput
+{
+	atomic<uint32_t> keys{0};
+	atomic<float> yaw{-90.0f}, pitch{0.0f};
+	atomic<int> selected{0};
 };
 
-Camera camera;
+double tickRate = 60.0;
+FixedStepThread simulation;
+TripleBuffer<SimSnapshot> snapshots;
+SimulationState simState;
+SimInput simInput;
+uint64_t appliedStaticEdits = 0;
 
 // Estado mouse
 bool firstMouse = true;
@@ -135,78 +273,133 @@ float lastFrame = 0.0f;
 
 // Funções
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
-void processInput(GLFWwindow *window);
+void pickAt(GLFWwindow *window, double xpos, double ypos);
+bool processInput(GLFWwindow *window);
 GLuint loadTexture(const string &path);
-bool loadOBJ(const string &objPath);
-GLuint setupShader();
-void setupGeometry();
-void drawCube(const Cube &cube);
+void setupGeometry(const MeshData &meshData);
+void setupInstanceAttributes(size_t byteOffset);
+void drawCubes(JobSystem &jobs, ShaderPermutations &permutations, Camera &view);
+void setFrameUniforms(GLuint program, Camera &view);
+uint32_t batchForMaterial(const Material &material);
+void generateStressCubes(size_t count);
+void setupLights(size_t extra);
+void startSimulation();
+void stopSimulation();
+void simulationStep(double time);
+bool applySimulation(bool latest);
+void updateShadows();
+void drawShadowCasters(GLuint program, bool moving);
 bool loadCubesFromJSON(const string &jsonPath);
+void reloadScene();
+float cubeRadius(const Cube &cube);
+void rebuildPickGrid();
+int pickCube(float ndcX, float ndcY);
+void selectCube(int hit, const string &detail);
 
-const char *vertexShaderSource = R"(
-#version 400 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aTexCoord;
-layout (location = 2) in vec3 aNormal;
-
-out vec2 TexCoord;
-out vec3 FragPos;
-out vec3 Normal;
-
-uniform mat4 projection;
-uniform mat4 view;
-uniform mat4 model;
-
-void main()
-{
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    FragPos = vec3(model * vec4(aPos,1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    TexCoord = aTexCoord;
-}
-)";
-
-const char *fragmentShaderSource = R"(
-#version 400 core
-in vec2 TexCoord;
-in vec3 FragPos;
-in vec3 Normal;
-
-out vec4 FragColor;
-
-uniform sampler2D texture1;
-uniform vec3 lightPos;
-uniform vec3 viewPos;
-uniform vec3 lightColor;
-uniform vec3 objectColor;
-
-void main()
+int main(int argc, char **argv)
 {
-    vec3 ambient = 0.2 * lightColor;
-
-    vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * lightColor;
-
-    float shininess = 32.0;
-    vec3 viewDir = normalize(viewPos - FragPos);
-    vec3 reflectDir = reflect(-lightDir, norm);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-    vec3 specular = spec * lightColor;
-
-    vec3 phong = (ambient + diffuse + specular);
-
-    vec4 texColor = texture(texture1, TexCoord);
-    FragColor = vec4(phong, 1.0) * texColor;
-}
-)";
-
-int main()
-{
-	string cubeJsonPath = "cubes.json";												   // ajuste para seu arquivo JSON
+	string cubeJsonPath = "../assets/cube.json"; // ou --scene P
 	string objPath = "C:/Users/Kamar/Downloads/CGCCHibrido/assets/Modelos3D/Cube.obj"; // seu arquivo OBJ do cubo
 
+	// Argumentos opcionais:
+	//   --scene P    cena com os cubos, JSON ou .scene (padrão ../assets/cube.json)
+	//   --stress N   replica os cubos do JSON até N objetos (teste de escala)
+	//   --threads N  número de threads usadas para montar a lista de desenho
+	//   --stream M   envio das instâncias: persistent (padrão), orphan ou bufferdata
+	//   --obj P      malha usada pelos cubos, .obj ou .mesh (ex.: assets/Modelos3D/SuzanneSubdiv1.obj)
+	//   --lod-error E erro de tela máximo, em pixels, para a troca de nível de detalhe
+	//   --vertex-format F  full (32 bytes/vértice), compact (16, padrão) ou compact10
+	//   --fog D      névoa linear que cobre tudo a partir da distância D (forward e tiled)
+	//   --renderer R forward (padrão: uma luz), deferred (G-buffer, todas as luzes) ou
+	//                tiled (forward com lista de luzes por tile, todas as luzes)
+	//   --lights N   acrescenta N luzes pontuais aleatórias em volta dos cubos
+	//   --prepass P  pré-passada de profundidade: auto (padrão), on ou off
+	//   --overdraw L overdraw a partir do qual o modo auto liga a pré-passada (padrão: 1.5)
+	//   --shadows S  sombras no caminho forward: cached (padrão), always (redesenha o
+	//                shadow map inteiro a cada frame) ou off
+	//   --tick-rate H passos por segundo da simulação (padrão: 60)
+	//   --bindings P arquivo com as teclas das ações ("ação TECLA" por linha, ver Input.h)
+	//   --record P   grava a entrada (teclado e mouse) em P
+	//   --replay P   reproduz a entrada gravada em P, frame a frame, e fecha no fim; a
+	//                simulação anda um passo por frame (resultado repetível)
+	//   --picking P  seleção com o mouse: grid (padrão, raio na CPU) ou gpu (buffer de ids)
+	//   --redraw R   always (padrão) ou on-demand: só desenha quando algo muda (não vale
+	//                com --replay, que reproduz frame a frame)
+	//   --present M  vsync (padrão), adaptive, uncapped ou N (limite de N fps; ver FramePacer.h)
+	//   --pacing P   smooth (padrão) ou low-latency: com vsync, atrasa o início do frame
+	//                para que ele termine logo antes da troca
+	size_t stressCount = 0;
+	unsigned numThreads = 0;
+	string bindingsPath, recordPath, replayPath;
+	bool onDemandEnabled = false, lowLatencyPacing = false;
+	FramePacer::Mode presentMode = FramePacer::PRESENT_VSYNC;
+	double fpsCap = 0.0;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		string arg = argv[i];
+		if (arg == "--scene")
+			cubeJsonPath = argv[i + 1];
+		else if (arg == "--stress")
+			stressCount = stoul(argv[i + 1]);
+		else if (arg == "--threads")
+			numThreads = (unsigned)stoul(argv[i + 1]);
+		else if (arg == "--obj")
+			objPath = argv[i + 1];
+		else if (arg == "--lod-error")
+			lodSelector.threshold = stof(argv[i + 1]);
+		else if (arg == "--fog")
+			fogDistance = stof(argv[i + 1]);
+		else if (arg == "--lights")
+			extraLightCount = stoul(argv[i + 1]);
+		else if (arg == "--prepass")
+		{
+			if (!DepthPrepass::parseMode(argv[i + 1], prepassMode))
+				cout << "Pré-passada desconhecida: " << argv[i + 1] << " (use off, on ou auto)\n";
+		}
+		else if (arg == "--overdraw")
+			overdrawThreshold = stof(argv[i + 1]);
+		else if (arg == "--shadows")
+		{
+			string m = argv[i + 1];
+			shadowsEnabled = m != "off";
+			shadowMap.setCaching(m != "always");
+		}
+		else if (arg == "--tick-rate")
+			tickRate = std::max(stod(argv[i + 1]), 1.0);
+		else if (arg == "--bindings")
+			bindingsPath = argv[i + 1];
+		else if (arg == "--record")
+			recordPath = argv[i + 1];
+		else if (arg == "--replay")
+			replayPath = argv[i + 1];
+		else if (arg == "--picking")
+			pickMode = string(argv[i + 1]) == "gpu" ? PICK_GPU : PICK_GRID;
+		else if (arg == "--redraw")
+			onDemandEnabled = string(argv[i + 1]) == "on-demand";
+		else if (arg == "--present")
+		{
+			if (!FramePacer::parseMode(argv[i + 1], presentMode, fpsCap))
+				cout << "Modo de apresentação desconhecido: " << argv[i + 1] << " (use vsync, adaptive, uncapped ou um número de fps)\n";
+		}
+		else if (arg == "--pacing")
+			lowLatencyPacing = string(argv[i + 1]) == "low-latency";
+		else if (arg == "--renderer")
+		{
+			string r = argv[i + 1];
+			renderPath = r == "deferred" ? RENDER_DEFERRED : r == "tiled" ? RENDER_TILED
+																			: RENDER_FORWARD;
+		}
+		else if (arg == "--vertex-format" && !VertexFormat::fromName(argv[i + 1], meshVertexFormat))
+			cout << "Formato de vértice desconhecido: " << argv[i + 1] << endl;
+		else if (arg == "--stream")
+		{
+			string m = argv[i + 1];
+			instanceStreamMode = m == "orphan" ? StreamBuffer::ORPHAN_SUBDATA : m == "bufferdata" ? StreamBuffer::BUFFER_DATA
+																							   : StreamBuffer::PERSISTENT_RING;
+		}
+	}
+	JobSystem jobs(numThreads);
+
 	// Inicializa GLFW
 	if (!glfwInit())
 	{
@@ -227,8 +420,19 @@ int main()
 	}
 	glfwMakeContextCurrent(window);
 
-	// Configura callback mouse
-	glfwSetCursorPosCallback(window, mouse_callback);
+	// Entrada por eventos: os callbacks do GLFW enfileiram, processInput consome
+	input.bindAll({{"move_forward", "W"}, {"move_back", "S"}, {"move_left", "A"}, {"move_right", "D"}, {"move_up", "Q"}, {"move_down", "E"},
+				   {"cube_up", "UP"}, {"cube_down", "DOWN"}, {"cube_left", "LEFT"}, {"cube_right", "RIGHT"}, {"cube_forward", "R"}, {"cube_back", "F"},
+				   {"cube_rotate_x+", "I"}, {"cube_rotate_x-", "K"}, {"cube_rotate_y+", "J"}, {"cube_rotate_y-", "L"}, {"cube_rotate_z+", "U"}, {"cube_rotate_z-", "O"},
+				   {"toggle_mouse", "M"}, {"toggle_shadow_cache", "H"}, {"pick", "MOUSE_LEFT"}, {"quit", "ESCAPE"},
+				   {"select_1", "1"}, {"select_2", "2"}, {"select_3", "3"}, {"select_4", "4"}, {"select_5", "5"}, {"select_6", "6"}, {"select_7", "7"}, {"select_8", "8"}, {"select_9", "9"}});
+	if (!bindingsPath.empty())
+		input.loadBindings(bindingsPath);
+	if (!recordPath.empty())
+		input.record(recordPath);
+	if (!replayPath.empty() && !input.replay(replayPath))
+		return -1;
+	input.attach(window);
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -236,6 +440,7 @@ int main()
 		cout << "Failed to initialize GLAD\n";
 		return -1;
 	}
+	glext::load();
 
 	glViewport(0, 0, WIDTH, HEIGHT);
 	glEnable(GL_DEPTH_TEST);
@@ -248,230 +453,543 @@ int main()
 	}
 
 	// Carrega OBJ
-	if (!loadOBJ(objPath))
+	MeshData cubeMesh;
+	if (!loadMeshFile(objPath, cubeMesh))
 	{
 		cout << "Failed to load OBJ\n";
 		return -1;
 	}
 
-	setupGeometry();
-	shaderProgram = setupShader();
-
-	// Carregar texturas dos cubos
-	for (auto &cube : cubes)
+	if (stressCount > cubes.size())
+		generateStressCubes(stressCount);
+	cout << "Cubos: " << cubes.size() << ", threads: " << jobs.laneCount() << endl;
+	setupLights(extraLightCount);
+
+	setupGeometry(cubeMesh);
+	// Shaders em assets/shaders, com cache dos programas linkados entre execuções.
+	// Só as variantes do uber-shader usadas pelos materiais da cena são compiladas:
+	// no deferred, as da passada de geometria (uber.vert + gbuffer.frag).
+	ShaderManager shaders;
+	ShaderPermutations forwardPermutations(shaders);
+	DeferredRenderer deferred(shaders);
+	if (renderPath == RENDER_DEFERRED && !deferred.create(WIDTH, HEIGHT))
 	{
+		cout << "Falha ao criar o G-buffer, usando o caminho forward\n";
+		renderPath = RENDER_FORWARD;
 	}
-
-
-	// Luz e câmera
-	vec3 lightPos(3.0f, 3.0f, 3.0f);
-	vec3 lightColor(1.0f, 1.0f, 1.0f);
-	vec3 objectColor(1.0f, 1.0f, 1.0f);
-
-	mat4 projection = perspective(radians(45.0f), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
+	if (renderPath == RENDER_TILED && !tiledLighting.create(shaders, WIDTH, HEIGHT))
+	{
+		cout << "Usando o caminho forward\n";
+		renderPath = RENDER_FORWARD;
+	}
+	if (renderPath == RENDER_FORWARD && shadowsEnabled && !shadowMap.create(shaders))
+	{
+		cout << "Falha ao criar o shadow map, sombras desligadas\n";
+		shadowsEnabled = false;
+	}
+	shadowsEnabled = shadowsEnabled && renderPath == RENDER_FORWARD;
+	if (renderPath != RENDER_DEFERRED && !depthPrepass.create(shaders, prepassMode, overdrawThreshold))
+		cout << "Falha ao carregar o shader da pré-passada, ela fica desligada\n";
+	if (pickMode == PICK_GPU && !objectIds.create(shaders, WIDTH, HEIGHT))
+	{
+		cout << "Falha ao criar o buffer de ids, usando a seleção pela grade\n";
+		pickMode = PICK_GRID;
+	}
+	cout << "Seleção: " << (pickMode == PICK_GPU ? "buffer de ids na GPU" : "grade com hash na CPU") << endl;
+	// Os materiais foram montados antes dos create(): um caminho que voltou para o
+	// forward passa a ter névoa
+	for (Material &material : materials)
+		material.fog = fogDistance > 0.0f && renderPath != RENDER_DEFERRED;
+	if (renderPath == RENDER_TILED)
+		pathFeatures = FEATURE_TILED_LIGHTS;
+	else if (shadowsEnabled)
+		pathFeatures = FEATURE_SHADOWS;
+	ShaderPermutations &permutations = renderPath == RENDER_DEFERRED ? deferred.geometryPermutations() : forwardPermutations;
+	set<uint32_t> usedFeatures;
+	for (const Material &material : materials)
+		usedFeatures.insert(material.features(true) | pathFeatures);
+	permutations.prepare(usedFeatures);
+	shaders.printStats();
+	shaders.enableHotReload(); // edite assets/shaders/uber.* com o programa aberto
+
+	camera.setPerspective(radians(45.0f), (float)WIDTH / (float)HEIGHT, 0.1f, 1000.0f);
+	const mat4 &projection = camera.getProjectionMatrix();
+	rebuildPickGrid();
+	startSimulation();
+	float lodThreshold = lodSelector.threshold;
+	lodSelector = LODSelector::forPerspective(radians(45.0f), (float)HEIGHT);
+	lodSelector.threshold = lodThreshold;
+
+	// Sob demanda, um frame só é desenhado se a entrada, a simulação, uma seleção
+	// ou uma recarga (shader, cena) mudou algo; parado, o loop dorme nos eventos
+	RenderOnDemand onDemand(window, onDemandEnabled && replayPath.empty());
+	bool wasMoving = false;
+	FramePacer pacer;
+	pacer.setup(presentMode, fpsCap, lowLatencyPacing);
+	double replayStart = -1.0; // glfwGetTime do primeiro frame reproduzido
 
 	while (!glfwWindowShouldClose(window))
 	{
+		// Limite de fps ou atraso de baixa latência antes de ler a entrada
+		pacer.waitForFrame();
+		onDemand.waitEvents();
+
 		// Tempo
 		float currentFrame = glfwGetTime();
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
+		if (!replayPath.empty() && replayStart < 0.0)
+			replayStart = currentFrame;
 
 		// Input
-		processInput(window);
-
-		// Render
-		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		if (processInput(window))
+			onDemand.invalidate();
+		bool moving;
+		if (input.isReplaying())
+		{
+			simulationStep(FixedStepThread::now());
+			moving = applySimulation(true);
+		}
+		else
+			moving = applySimulation(false);
+		if (input.replayFinished())
+		{
+			double replayTime = currentFrame - replayStart;
+			cout << "Reprodução concluída: " << input.frameIndex() << " frames em " << replayTime << " s ("
+				 << replayTime * 1000.0 / input.frameIndex() << " ms/frame)" << endl;
+			glfwSetWindowShouldClose(window, true);
+		}
+		ObjectIdBuffer::Pick pick;
+		if (pickMode == PICK_GPU && objectIds.poll(pick))
+		{
+			selectCube(pick.object, "GPU, lido " + to_string(pick.latency) + " frame(s) depois");
+			onDemand.invalidate();
+		}
 
-		glUseProgram(shaderProgram);
+		// Troca os programas cujos arquivos mudaram (permutations.get devolve os novos)
+		if (shaders.update())
+			onDemand.invalidate();
+		for (const string &file : sceneWatcher.poll())
+		{
+			if (file == filesystem::path(scenePath).filename().string())
+			{
+				reloadScene();
+				onDemand.invalidate();
+				break;
+			}
+		}
 
-		glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, value_ptr(projection));
-		mat4 view = camera.getViewMatrix();
-		glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, value_ptr(view));
+		// Depois do último passo em movimento ainda é preciso um frame com o estado final
+		onDemand.setAnimating(moving || wasMoving || objectIds.busy() || shaders.reloadPending());
+		wasMoving = moving;
+		if (!onDemand.beginFrame())
+		{
+			pacer.skipFrame();
+			continue;
+		}
 
-		glUniform3fv(glGetUniformLocation(shaderProgram, "lightPos"), 1, value_ptr(lightPos));
-		glUniform3fv(glGetUniformLocation(shaderProgram, "viewPos"), 1, value_ptr(camera.position));
-		glUniform3fv(glGetUniformLocation(shaderProgram, "lightColor"), 1, value_ptr(lightColor));
-		glUniform3fv(glGetUniformLocation(shaderProgram, "objectColor"), 1, value_ptr(objectColor));
+		// Render
+		const mat4 &view = camera.getViewMatrix();
+		if (renderPath == RENDER_DEFERRED)
+		{
+			deferred.beginGeometryPass(clearColor);
+			drawCubes(jobs, permutations, camera);
+			deferred.lightingPass(lights, projection, view, camera.getPosition());
+			deferred.present();
+		}
+		else
+		{
+			if (renderPath == RENDER_TILED)
+				tiledLighting.cull(lights, projection, view);
+			if (shadowsEnabled)
+				updateShadows();
+			prepassThisFrame = depthPrepass.beginFrame();
+			glClearColor(clearColor.r, clearColor.g, clearColor.b, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			drawCubes(jobs, permutations, camera);
+		}
 
-		for (const Cube &cube : cubes)
+		// Estatísticas no título da janela, uma vez por segundo
+		if ((int)currentFrame != (int)(currentFrame - deltaTime))
 		{
-			drawCube(cube);
+			string title = "Cubes Movable with FPS Camera | " + to_string(cubes.size()) + " cubos, " + to_string(trianglesDrawn) + " triângulos, " + to_string((int)(1.0f / max(deltaTime, 1e-6f))) + " fps";
+			if (renderPath == RENDER_DEFERRED)
+				title += ", " + to_string(deferred.visibleLightCount()) + "/" + to_string(lights.size()) + " luzes";
+			else if (renderPath == RENDER_TILED)
+			{
+				title += ", " + to_string(lights.size()) + " luzes (tiled)";
+				if (tiledLighting.overflowTiles() > 0)
+					title += ", " + to_string(tiledLighting.overflowTiles()) + " tiles acima de " + to_string(TiledLighting::MAX_LIGHTS_PER_TILE) + " luzes";
+			}
+			if (renderPath != RENDER_DEFERRED)
+			{
+				const DepthPrepass::Stats &ps = depthPrepass.stats();
+				title += string(", pré-passada ") + (depthPrepass.isEnabled() ? "ligada" : "desligada") + ", " + to_string(ps.shadedFragments / 1000) + "k fragmentos sombreados";
+				if (ps.fragmentInvocations > 0)
+					title += " (" + to_string(ps.fragmentInvocations / 1000) + "k invocações)";
+				if (ps.overdraw > 0.0f)
+					title += ", overdraw " + to_string(ps.overdraw).substr(0, 4);
+			}
+			title += ", simulação " + to_string((int)tickRate) + " Hz (" + to_string(simulation.droppedTicks()) + " passos descartados)";
+			if (shadowsEnabled)
+				title += string(", sombras ") + (shadowMap.cachingEnabled() ? "em cache" : "redesenhadas") + " (" + to_string(shadowMap.stats().staticRenders) + " passadas estáticas)";
+			title += ", " + pacer.summary();
+			glfwSetWindowTitle(window, title.c_str());
 		}
 
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+		pacer.present(window);
 	}
 
+	simulation.stop();
+	deferred.release();
+	tiledLighting.release();
+	shadowMap.release();
+	depthPrepass.release();
+	objectIds.release();
+	for (LODMesh &lod : cubeLODs)
+		glDeleteVertexArrays(1, &lod.depthVAO);
+	glDeleteBuffers(1, &shadowInstanceBuffer);
 	glfwTerminate();
 	return 0;
 }
 
-// Função que carrega o OBJ (simples, sem indices, triangulado)
-// Atribui valores aos vetores globais: positions, texCoords, normals
-bool loadOBJ(const string &objPath)
+// Completa a lista de luzes: 'extra' luzes aleatórias na caixa que envolve os cubos
+// (com folga de 2 unidades) e, se a cena não tiver nenhuma, a luz padrão em lightPos.
+// A primeira luz é a usada pelo caminho forward.
+void setupLights(size_t extra)
 {
-	ifstream file(objPath);
-	if (!file.is_open())
+	if (extra > 0 && !cubes.empty())
 	{
-		cout << "Failed to open OBJ file: " << objPath << endl;
-		return false;
+		vec3 minCorner = cubes[0].position, maxCorner = cubes[0].position;
+		for (const Cube &cube : cubes)
+		{
+			minCorner = glm::min(minCorner, cube.position);
+			maxCorner = glm::max(maxCorner, cube.position);
+		}
+		vector<PointLight> generated = generateLights(extra, minCorner - vec3(2.0f), maxCorner + vec3(2.0f), 3.0f);
+		lights.insert(lights.end(), generated.begin(), generated.end());
 	}
 
-	vector<vec3> temp_positions;
-	vector<vec2> temp_texCoords;
-	vector<vec3> temp_normals;
-
-	vector<unsigned int> vertexIndices, texCoordIndices, normalIndices;
+	if (lights.empty())
+	{
+		PointLight light;
+		light.position = lightPos;
+		light.color = lightColor;
+		light.radius = 100.0f;
+		lights.push_back(light);
+	}
+	lightPos = lights[0].position;
+	lightColor = lights[0].color;
+
+	const char *pathNames[] = {"forward", "deferred", "tiled"};
+	cout << "Luzes: " << lights.size() << " (caminho " << pathNames[renderPath] << ")" << endl;
+	if (renderPath == RENDER_FORWARD && lights.size() > 1)
+		cout << "O caminho forward usa só a primeira luz; use --renderer deferred ou tiled para todas" << endl;
+	if (renderPath == RENDER_DEFERRED && fogDistance > 0.0f)
+		cout << "A névoa (--fog) não é aplicada no caminho deferred" << endl;
+}
 
-	string line;
-	while (getline(file, line))
+// Avança 'position' 'step' unidades em direção ao próximo ponto da trajetória, em ciclo
+static void advanceTrajectory(vec3 &position, size_t &waypoint, const vector<vec3> &points, float step)
+{
+	while (step > 0.0f)
 	{
-		if (line.substr(0, 2) == "v ")
+		vec3 toTarget = points[waypoint] - position;
+		float distance = length(toTarget);
+		if (distance > step)
 		{
-			istringstream s(line.substr(2));
-			vec3 v;
-			s >> v.x >> v.y >> v.z;
-			temp_positions.push_back(v);
+			position += toTarget * (step / distance);
+			break;
 		}
-		else if (line.substr(0, 3) == "vt ")
+		position = points[waypoint];
+		waypoint = (waypoint + 1) % points.size();
+		step -= distance;
+		if (distance == 0.0f && points.size() == 1)
+			break;
+	}
+}
+
+// Copia o estado atual dos cubos e da câmera para a simulação e inicia a thread
+// (reproduzindo, só prepara o estado)
+void startSimulation()
+{
+	SimulationState &s = simState;
+	s = SimulationState();
+	s.cameraPosition = camera.getPosition();
+	s.transforms.resize(cubes.size());
+	s.slot.assign(cubes.size(), -1);
+	for (size_t i = 0; i < cubes.size(); ++i)
+	{
+		s.transforms[i] = CubeTransform{cubes[i].position, cubes[i].rotation};
+		if (cubes[i].trajectory < 0)
+			continue;
+		s.slot[i] = (int32_t)s.active.size();
+		s.active.push_back((uint32_t)i);
+		s.trajectory.push_back(cubes[i].trajectory);
+		s.waypoint.push_back(cubes[i].waypoint);
+	}
+	s.previous.resize(s.active.size());
+	snapshots.reset();
+	appliedStaticEdits = 0;
+	if (input.isReplaying())
+		return; // main chama simulationStep a cada frame reproduzido
+	simulation.start(tickRate, [](uint64_t, double time)
+					 { simulationStep(time); });
+}
+
+// Para a thread e aplica o último passo sem interpolação: os cubos ficam com o
+// estado exato da simulação, inclusive o próximo ponto de cada trajetória
+void stopSimulation()
+{
+	simulation.stop();
+	applySimulation(true);
+	for (size_t k = 0; k < simState.active.size(); ++k)
+	{
+		uint32_t i = simState.active[k];
+		if (simState.trajectory[k] >= 0 && i < cubes.size())
+			cubes[i].waypoint = simState.waypoint[k];
+	}
+}
+
+// Um passo da simulação (na thread dela): câmera e cubo selecionado pelas teclas
+// pressionadas e cubos com trajetória; publica o resultado para o render
+void simulationStep(double time)
+{
+	SimulationState &s = simState;
+	float dt = (float)(1.0 / tickRate); // o passo da thread, também sem ela (--replay)
+	uint32_t keys = simInput.keys.load(memory_order_relaxed);
+
+	// Movimenta câmera (a orientação vem do mouse, na thread principal)
+	vec3 cameraPrevious = s.cameraPosition;
+	Camera view(s.cameraPosition, simInput.yaw.load(memory_order_relaxed), simInput.pitch.load(memory_order_relaxed));
+	float cameraSpeed = 2.5f * dt;
+	if (keys & (1u << 0))
+		view.moveForward(cameraSpeed);
+	if (keys & (1u << 1))
+		view.moveForward(-cameraSpeed);
+	if (keys & (1u << 2))
+		view.moveRight(-cameraSpeed);
+	if (keys & (1u << 3))
+		view.moveRight(cameraSpeed);
+	if (keys & (1u << 4))
+		view.moveUp(cameraSpeed);
+	if (keys & (1u << 5))
+		view.moveUp(-cameraSpeed);
+	s.cameraPosition = view.getPosition();
+
+	for (size_t k = 0; k < s.active.size(); ++k)
+		s.previous[k] = s.transforms[s.active[k]];
+	for (size_t k = 0; k < s.active.size(); ++k)
+	{
+		if (s.trajectory[k] >= 0)
+			advanceTrajectory(s.transforms[s.active[k]].position, s.waypoint[k], trajectories[s.trajectory[k]], trajectorySpeed * dt);
+	}
+
+	// Cubo selecionado: um cubo parado passa a ser publicado a partir do primeiro movimento
+	int selected = simInput.selected.load(memory_order_relaxed);
+	if ((keys & CUBE_KEYS) && selected >= 0 && selected < (int)s.transforms.size())
+	{
+		CubeTransform &c = s.transforms[selected];
+		if (s.slot[selected] < 0)
 		{
-			istringstream s(line.substr(3));
-			vec2 vt;
-			s >> vt.x >> vt.y;
-			temp_texCoords.push_back(vt);
+			s.slot[selected] = (int32_t)s.active.size();
+			s.active.push_back((uint32_t)selected);
+			s.trajectory.push_back(-1);
+			s.waypoint.push_back(0);
+			s.previous.push_back(c);
 		}
-		else if (line.substr(0, 3) == "vn ")
+		if (s.trajectory[s.slot[selected]] < 0)
+			s.staticEdits++; // a camada estática das sombras fica inválida
+
+		// Setas e R/F movem no plano XY e no eixo Z; IJKL/U/O giram em X, Y e Z
+		float cubeMoveSpeed = 1.0f * dt;
+		float cubeRotateSpeed = 45.0f * dt;
+		const vec3 moves[] = {vec3(0, 1, 0), vec3(0, -1, 0), vec3(-1, 0, 0), vec3(1, 0, 0), vec3(0, 0, 1), vec3(0, 0, -1)};
+		for (int k = 0; k < 6; ++k)
 		{
-			istringstream s(line.substr(3));
-			vec3 vn;
-			s >> vn.x >> vn.y >> vn.z;
-			temp_normals.push_back(vn);
+			if (keys & (1u << (6 + k)))
+				c.position += moves[k] * cubeMoveSpeed;
+			if (keys & (1u << (12 + k)))
+				c.rotation[k / 2] += k % 2 == 0 ? cubeRotateSpeed : -cubeRotateSpeed;
 		}
-		else if (line.substr(0, 2) == "f ")
-		{
-			istringstream s(line.substr(2));
-			string vertex1, vertex2, vertex3;
-			s >> vertex1 >> vertex2 >> vertex3;
+	}
 
-			unsigned int vi[3], ti[3], ni[3];
-			for (int i = 0; i < 3; ++i)
-			{
-				string vertexStr = (i == 0) ? vertex1 : (i == 1) ? vertex2
-																 : vertex3;
-				size_t pos1 = vertexStr.find('/');
-				size_t pos2 = vertexStr.find('/', pos1 + 1);
+	SimSnapshot &out = snapshots.back();
+	out.valid = true;
+	out.time = time;
+	out.cameraPrevious = cameraPrevious;
+	out.cameraCurrent = s.cameraPosition;
+	out.indices = s.active;
+	out.previous = s.previous;
+	out.current.resize(s.active.size());
+	for (size_t k = 0; k < s.active.size(); ++k)
+		out.current[k] = s.transforms[s.active[k]];
+	out.staticEdits = s.staticEdits;
+	snapshots.publish();
+}
 
-				vi[i] = stoi(vertexStr.substr(0, pos1)) - 1;
+// Copia para a câmera e os cubos o último passo publicado, interpolado para o
+// instante atual (latest: o passo exato, sem interpolação). Retorna true se esse
+// passo moveu algo (a câmera, um cubo ou um cubo parado pelo teclado).
+bool applySimulation(bool latest)
+{
+	snapshots.acquire();
+	const SimSnapshot &s = snapshots.front();
+	if (!s.valid)
+		return false;
+	float alpha = latest ? 1.0f : glm::clamp((float)((FixedStepThread::now() - s.time) / simulation.stepSeconds()), 0.0f, 1.0f);
 
-				ti[i] = stoi(vertexStr.substr(pos1 + 1, pos2 - pos1 - 1)) - 1;
+	camera.setPosition(mix(s.cameraPrevious, s.cameraCurrent, alpha));
+	bool moved = s.cameraPrevious != s.cameraCurrent;
+	for (size_t k = 0; k < s.indices.size(); ++k)
+	{
+		uint32_t i = s.indices[k];
+		if (i >= cubes.size())
+			continue;
+		moved = moved || s.previous[k].position != s.current[k].position || s.previous[k].rotation != s.current[k].rotation;
+		Cube &cube = cubes[i];
+		cube.position = mix(s.previous[k].position, s.current[k].position, alpha);
+		cube.rotation = mix(s.previous[k].rotation, s.current[k].rotation, alpha);
+		pickGrid.update(i, cube.position, cubeRadius(cube));
+	}
 
-				ni[i] = stoi(vertexStr.substr(pos2 + 1)) - 1;
-			}
+	// Cubo parado movido pelo teclado: a camada estática das sombras fica inválida
+	if (s.staticEdits != appliedStaticEdits)
+	{
+		appliedStaticEdits = s.staticEdits;
+		shadowMap.invalidate();
+		shadowBoundsDirty = true;
+		moved = true;
+	}
+	return moved;
+}
 
-			for (int i = 0; i < 3; ++i)
+// Atualiza o shadow map da luz lightPos: a camada estática (cubos sem trajetória) só
+// quando invalidada, os cubos em movimento a cada frame
+void updateShadows()
+{
+	if (shadowBoundsDirty)
+	{
+		// Esfera que envolve todos os cubos, incluindo os pontos das trajetórias
+		vec3 minCorner(1e30f), maxCorner(-1e30f);
+		float maxScale = 1.0f;
+		for (const Cube &cube : cubes)
+		{
+			minCorner = glm::min(minCorner, cube.position);
+			maxCorner = glm::max(maxCorner, cube.position);
+			maxScale = std::max(maxScale, std::max(cube.scale.x, std::max(cube.scale.y, cube.scale.z)));
+		}
+		for (const vector<vec3> &points : trajectories)
+		{
+			for (const vec3 &p : points)
 			{
-				positions.push_back(temp_positions[vi[i]]);
-				texCoords.push_back(temp_texCoords[ti[i]]);
-				normals.push_back(temp_normals[ni[i]]);
+				minCorner = glm::min(minCorner, p);
+				maxCorner = glm::max(maxCorner, p);
 			}
 		}
+		vec3 center = (minCorner + maxCorner) * 0.5f;
+		shadowMap.setLight(lightPos, center, length(maxCorner - center) + meshRadius * maxScale);
+		shadowBoundsDirty = false;
 	}
-	file.close();
-	return true;
+
+	shadowMap.update([](GLuint program)
+					 { drawShadowCasters(program, false); },
+					 [](GLuint program)
+					 { drawShadowCasters(program, true); },
+					 !trajectories.empty());
 }
 
-// Setup VAO, VBO
-void setupGeometry()
+// Desenha na passada de profundidade os cubos parados (moving = false) ou os com
+// trajetória, todos com o nível de detalhe 0 e sem culling
+void drawShadowCasters(GLuint program, bool moving)
 {
-	vector<float> data;
-	for (size_t i = 0; i < positions.size(); ++i)
+	static vector<InstanceData> instances;
+	instances.clear();
+	for (const Cube &cube : cubes)
 	{
-		// pos x,y,z
-		data.push_back(positions[i].x);
-		data.push_back(positions[i].y);
-		data.push_back(positions[i].z);
-
-		// tex coords u,v
-		data.push_back(texCoords[i].x);
-		data.push_back(texCoords[i].y);
-
-		// normals x,y,z
-		data.push_back(normals[i].x);
-		data.push_back(normals[i].y);
-		data.push_back(normals[i].z);
+		if ((cube.trajectory >= 0) != moving)
+			continue;
+		InstanceData data;
+		packInstance(composeModel(cube.position, cube.rotation, cube.scale), data);
+		instances.push_back(data);
 	}
-
-	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
-
-	glBindVertexArray(VAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
-
-	// posição
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
-	glEnableVertexAttribArray(0);
-
-	// textura
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	// normal
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(5 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-
+	if (instances.empty())
+		return;
+
+	if (shadowInstanceBuffer == 0)
+		glGenBuffers(1, &shadowInstanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, shadowInstanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(InstanceData), instances.data(), GL_STREAM_DRAW);
+
+	const Mesh &mesh = cubeLODs[0].mesh;
+	glBindVertexArray(mesh.VAO);
+	setVertexDecodeUniforms(program, mesh);
+	setupInstanceAttributes(0);
+	glDrawElementsInstanced(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0, (GLsizei)instances.size());
 	glBindVertexArray(0);
 }
 
-// Compila e cria shader program
-GLuint setupShader()
+// Gera a cadeia de LOD da malha (simplificação QEM) e envia cada nível para a GPU.
+// Cada VAO recebe também os atributos por instância (locations 3-9).
+void setupGeometry(const MeshData &meshData)
 {
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-	glCompileShader(vertexShader);
-
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
+	meshRadius = meshData.boundingRadius();
+	meshBoundsMin = vec3(1e30f);
+	meshBoundsMax = vec3(-1e30f);
+	for (const vec3 &p : meshData.positions)
 	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		cout << "Error compiling vertex shader:\n"
-			 << infoLog << endl;
+		meshBoundsMin = glm::min(meshBoundsMin, p);
+		meshBoundsMax = glm::max(meshBoundsMax, p);
 	}
 
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-	glCompileShader(fragmentShader);
+	instanceStream.create(GL_ARRAY_BUFFER, max<size_t>(cubes.size(), 1) * sizeof(InstanceData), instanceStreamMode);
+	cout << "Envio das instâncias: " << StreamBuffer::modeName(instanceStream.activeMode()) << endl;
 
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
+	cout << "Formato de vértice: " << meshVertexFormat.name() << " (" << meshVertexFormat.stride() << " bytes)" << endl;
+	vector<LODLevel> chain = buildLODChain(meshData);
+	for (size_t l = 0; l < chain.size(); ++l)
 	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		cout << "Error compiling fragment shader:\n"
-			 << infoLog << endl;
-	}
+		LODMesh lod;
+		lod.mesh = uploadMesh(chain[l].mesh, meshVertexFormat);
+		lod.error = chain[l].error;
+		cout << "LOD " << l << ": " << chain[l].mesh.triangleCount() << " triângulos, erro " << lod.error << ", " << lod.mesh.byteSize() / 1024.0f << " KB" << endl;
+
+		glBindVertexArray(lod.mesh.VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceStream.id());
+		for (GLuint loc = 3; loc <= 9; ++loc)
+		{
+			glEnableVertexAttribArray(loc);
+			glVertexAttribDivisor(loc, 1);
+		}
+		setupInstanceAttributes(0);
 
-	GLuint program = glCreateProgram();
-	glAttachShader(program, vertexShader);
-	glAttachShader(program, fragmentShader);
-	glLinkProgram(program);
+		// A pré-passada lê só a posição e a matriz de modelo (locations 3-6)
+		lod.depthVAO = createPositionOnlyVAO(lod.mesh);
+		glBindVertexArray(lod.depthVAO);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceStream.id());
+		for (GLuint loc = 3; loc <= 6; ++loc)
+		{
+			glEnableVertexAttribArray(loc);
+			glVertexAttribDivisor(loc, 1);
+		}
+		setupInstanceAttributes(0);
 
-	glGetProgramiv(program, GL_LINK_STATUS, &success);
-	if (!success)
-	{
-		glGetProgramInfoLog(program, 512, NULL, infoLog);
-		cout << "Error linking shader program:\n"
-			 << infoLog << endl;
+		cubeLODs.push_back(lod);
+		cubeLODErrors.push_back(lod.error);
 	}
+	glBindVertexArray(0);
+}
 
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	return program;
+// Aponta os atributos instanciados para o início de um batch dentro do buffer de instâncias
+// (sem glDrawArraysInstancedBaseInstance, que só existe a partir do OpenGL 4.2)
+// Requer o VAO e o buffer de instâncias vinculados
+void setupInstanceAttributes(size_t byteOffset)
+{
+	const GLsizei stride = sizeof(InstanceData);
+	for (GLuint c = 0; c < 4; ++c)
+		glVertexAttribPointer(3 + c, 4, GL_FLOAT, GL_FALSE, stride, (void *)(byteOffset + offsetof(InstanceData, model) + c * sizeof(vec4)));
+	for (GLuint c = 0; c < 3; ++c) // a primeira coluna com o w (id do objeto, ver drawCubes)
+		glVertexAttribPointer(7 + c, c == 0 ? 4 : 3, GL_FLOAT, GL_FALSE, stride, (void *)(byteOffset + offsetof(InstanceData, normalMatrix) + c * sizeof(vec4)));
 }
 
 // Carrega textura e retorna ID
@@ -523,116 +1041,277 @@ GLuint loadTexture(const string &path)
 	return textureID;
 }
 
-// Desenha cubo dado (posição, rotação, escala, textura)
-void drawCube(const Cube &cube)
+// Desenha todos os cubos: as threads de trabalho fazem o culling, escolhem o nível de
+// detalhe e empacotam as matrizes em buffers próprios; a thread de GL faz um único
+// upload e uma chamada instanciada por (textura, nível de detalhe)
+// Desenha os cubos vistos por 'viewCamera' (culling pelo frustum em cache dela)
+void drawCubes(JobSystem &jobs, ShaderPermutations &permutations, Camera &viewCamera)
 {
-	mat4 model = mat4(1.0f);
-	model = translate(model, cube.position);
-	model = rotate(model, radians(cube.rotation.x), vec3(1, 0, 0));
-	model = rotate(model, radians(cube.rotation.y), vec3(0, 1, 0));
-	model = rotate(model, radians(cube.rotation.z), vec3(0, 0, 1));
-	model = scale(model, cube.scale);
+	const Frustum &frustum = viewCamera.getFrustum();
+	const mat4 &projection = viewCamera.getProjectionMatrix();
+	const mat4 &view = viewCamera.getViewMatrix();
+	vec3 eye = viewCamera.getPosition();
+	int numLODs = (int)cubeLODs.size();
+
+	drawList.build(jobs, cubes.size(), (uint32_t)(materials.size() * numLODs), [&](size_t i, InstanceData &out, uint32_t &batch)
+				   {
+		Cube &cube = cubes[i];
+		float maxScale = std::max(cube.scale.x, std::max(cube.scale.y, cube.scale.z));
+		float radius = meshRadius * maxScale;
+		if (!frustum.intersectsSphere(cube.position, radius))
+			return false;
+
+		float distance = std::max(length(cube.position - eye) - radius, 0.0f);
+		cube.lod = lodSelector.select(cubeLODErrors.data(), numLODs, maxScale, distance, cube.lod);
+
+		packInstance(composeModel(cube.position, cube.rotation, cube.scale), out);
+		out.normalMatrix[0].w = (float)(i + 1); // id para o ObjectIdBuffer (exato até 2^24)
+		batch = cube.batch * numLODs + cube.lod;
+		return true; });
+
+	// As threads copiam direto para a memória mapeada da região do frame
+	size_t streamOffset = 0;
+	InstanceData *dst = (InstanceData *)instanceStream.map(drawList.totalCount() * sizeof(InstanceData), streamOffset, sizeof(InstanceData));
+	drawList.gather(jobs, dst);
+	instanceStream.unmap();
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceStream.id());
+	const vector<DrawBatch> &batches = drawList.batches();
+
+	// Pré-passada: os mesmos batches, só profundidade, sem trocar de programa
+	bool forwardPass = renderPath != RENDER_DEFERRED;
+	if (forwardPass && prepassThisFrame)
+	{
+		depthPrepass.depthPass(value_ptr(projection), value_ptr(view), [&](GLuint program)
+							   {
+			for (size_t b = 0; b < batches.size(); ++b)
+			{
+				if (batches[b].count == 0)
+					continue;
+				const LODMesh &lod = cubeLODs[b % numLODs];
+				glBindVertexArray(lod.depthVAO);
+				setVertexDecodeUniforms(program, lod.mesh);
+				setupInstanceAttributes(streamOffset + batches[b].first * sizeof(InstanceData));
+				glDrawElementsInstanced(GL_TRIANGLES, lod.mesh.indexCount, GL_UNSIGNED_INT, 0, (GLsizei)batches[b].count);
+			} });
+	}
+	if (forwardPass)
+		depthPrepass.beginShading();
+
+	// Os batches de um mesmo material são vizinhos: o programa e os uniforms do material
+	// só são trocados quando o material muda
+	GLuint currentProgram = 0;
+	size_t currentMaterial = SIZE_MAX;
+	trianglesDrawn = 0;
+	for (size_t b = 0; b < batches.size(); ++b)
+	{
+		if (batches[b].count == 0)
+			continue;
+		size_t m = b / numLODs;
+		if (m != currentMaterial)
+		{
+			GLuint program = permutations.get(materials[m].features(true) | pathFeatures);
+			if (program != currentProgram)
+			{
+				glUseProgram(program);
+				setFrameUniforms(program, viewCamera);
+				currentProgram = program;
+			}
+			ShaderPermutations::applyMaterial(program, materials[m]);
+			currentMaterial = m;
+		}
 
-	glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, value_ptr(model));
+		const Mesh &mesh = cubeLODs[b % numLODs].mesh;
+		trianglesDrawn += (size_t)batches[b].count * mesh.indexCount / 3;
+		glBindVertexArray(mesh.VAO);
+		setVertexDecodeUniforms(currentProgram, mesh);
+		setupInstanceAttributes(streamOffset + batches[b].first * sizeof(InstanceData));
+		glDrawElementsInstanced(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0, (GLsizei)batches[b].count);
+	}
+	glBindVertexArray(0);
+	if (forwardPass)
+		depthPrepass.endShading();
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, cube.textureID);
-	glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
+	// Clique pendente na seleção pela GPU: os mesmos batches no buffer de ids, antes da
+	// fence do frame no buffer de instâncias
+	if (objectIds.pickRequested())
+	{
+		objectIds.render(value_ptr(projection), value_ptr(view), [&](GLuint program)
+						 {
+			for (size_t b = 0; b < batches.size(); ++b)
+			{
+				if (batches[b].count == 0)
+					continue;
+				const Mesh &mesh = cubeLODs[b % numLODs].mesh;
+				glBindVertexArray(mesh.VAO);
+				setVertexDecodeUniforms(program, mesh);
+				setupInstanceAttributes(streamOffset + batches[b].first * sizeof(InstanceData));
+				glDrawElementsInstanced(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0, (GLsizei)batches[b].count);
+			}
+			glBindVertexArray(0); });
+	}
+	instanceStream.endFrame();
+}
 
-	glBindVertexArray(VAO);
-	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)positions.size());
-	glBindVertexArray(0);
+// Uniforms comuns a todos os materiais, enviados uma vez por programa a cada frame
+void setFrameUniforms(GLuint program, Camera &view)
+{
+	glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, value_ptr(view.getProjectionMatrix()));
+	glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, value_ptr(view.getViewMatrix()));
+	glUniform3fv(glGetUniformLocation(program, "lightPos"), 1, value_ptr(lightPos));
+	glUniform3fv(glGetUniformLocation(program, "viewPos"), 1, value_ptr(view.getPosition()));
+	glUniform3fv(glGetUniformLocation(program, "lightColor"), 1, value_ptr(lightColor));
+	glUniform3fv(glGetUniformLocation(program, "ambientColor"), 1, value_ptr(ambientColor)); // G-buffer e tiled
+	if (renderPath == RENDER_TILED)
+		tiledLighting.setUniforms(program);
+	if (shadowsEnabled)
+		shadowMap.setUniforms(program);
+	if (fogDistance > 0.0f)
+	{
+		glUniform3fv(glGetUniformLocation(program, "fogColor"), 1, value_ptr(clearColor));
+		glUniform1f(glGetUniformLocation(program, "fogStart"), fogDistance * 0.25f);
+		glUniform1f(glGetUniformLocation(program, "fogEnd"), fogDistance);
+	}
 }
-static bool mKeyPressedLastFrame = false;
 
-// Processa input de teclado (movimenta câmera e cubo selecionado)
-void processInput(GLFWwindow *window)
+// Retorna o batch do material, criando um novo se for a primeira vez que ele aparece
+uint32_t batchForMaterial(const Material &material)
 {
+	for (size_t b = 0; b < materials.size(); ++b)
+	{
+		if (materials[b] == material)
+			return (uint32_t)b;
+	}
+	materials.push_back(material);
+	return (uint32_t)(materials.size() - 1);
+}
 
-	// Detecta tecla M para ligar/desligar mouse
-    bool mKeyPressed = glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS;
-    if (mKeyPressed && !mKeyPressedLastFrame)
-    {
-        mouseEnabled = !mouseEnabled;
-        if (mouseEnabled)
-        {
-            glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-            firstMouse = true; // resetar para evitar salto no movimento
-            cout << "Mouse control ENABLED\n";
-        }
-        else
-        {
-            glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
-            cout << "Mouse control DISABLED\n";
-        }
-    }
+// Replica os cubos carregados do JSON em uma grade até 'count' objetos,
+// reaproveitando as texturas já carregadas
+void generateStressCubes(size_t count)
+{
+	if (cubes.empty())
+		return;
 
-    mKeyPressedLastFrame = mKeyPressed;
-	float cameraSpeed = 2.5f * deltaTime;
-	float cubeMoveSpeed = 1.0f * deltaTime;
-	float cubeRotateSpeed = 45.0f * deltaTime;
+	size_t side = (size_t)ceil(cbrt((double)count));
+	size_t original = cubes.size();
+	for (size_t i = original; i < count; ++i)
+	{
+		Cube cube = cubes[i % original];
+		cube.trajectory = -1; // as trajetórias são absolutas: as cópias ficam paradas
+		cube.id = -1;		  // e não acompanham a recarga da cena
+		cube.position = vec3((float)(i % side), (float)((i / side) % side), -(float)(i / (side * side))) * 2.0f - vec3((float)side, (float)side, 5.0f);
+		cube.rotation = vec3((float)(i % 360), (float)((i * 7) % 360), 0.0f);
+		cubes.push_back(cube);
+	}
+}
+// Consome os eventos do frame (Input.h): alternâncias, seleção e mouse aqui; o
+// movimento da câmera e do cubo selecionado vai para a simulação. Retorna true se
+// houve algum evento ou há ações de movimento ativas.
+bool processInput(GLFWwindow *window)
+{
+	input.update();
 
-	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-		glfwSetWindowShouldClose(window, true);
+	// M liga/desliga o controle da câmera pelo mouse
+	if (input.pressed(TOGGLE_MOUSE))
+	{
+		mouseEnabled = !mouseEnabled;
+		if (mouseEnabled)
+		{
+			glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+			firstMouse = true; // resetar para evitar salto no movimento
+			cout << "Mouse control ENABLED\n";
+		}
+		else
+		{
+			glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+			cout << "Mouse control DISABLED\n";
+		}
+	}
 
-	// Movimenta câmera
-	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-		camera.moveForward(cameraSpeed);
-	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-		camera.moveForward(-cameraSpeed);
-	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-		camera.moveRight(-cameraSpeed);
-	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-		camera.moveRight(cameraSpeed);
-	if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
-		camera.moveUp(cameraSpeed);
-	if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
-		camera.moveUp(-cameraSpeed);
+	if (input.pressed(QUIT))
+		glfwSetWindowShouldClose(window, true);
 
 	// Seleção de cubo 1-9
-	for (int i = GLFW_KEY_1; i <= GLFW_KEY_9; i++)
+	for (int k = 0; k < 9; ++k)
 	{
-		if (glfwGetKey(window, i) == GLFW_PRESS)
-		{
-			int idx = i - GLFW_KEY_1;
-			if (idx < (int)cubes.size())
-			{
-				selectedCube = idx;
-			}
-		}
+		if (input.pressed(SELECT_1 + k) && k < (int)cubes.size())
+			selectedCube = k;
+	}
+
+	// H: sombras em cache ou redesenhadas a cada frame (comparação de desempenho)
+	if (input.pressed(TOGGLE_SHADOW_CACHE) && shadowsEnabled)
+	{
+		shadowMap.setCaching(!shadowMap.cachingEnabled());
+		cout << "Sombras: " << (shadowMap.cachingEnabled() ? "camada estática em cache" : "redesenhadas a cada frame") << endl;
 	}
 
-	Cube &c = cubes[selectedCube];
-
-	// Movimento cubo selecionado (no plano XY e eixo Z)
-	if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
-		c.position.y += cubeMoveSpeed;
-	if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
-		c.position.y -= cubeMoveSpeed;
-	if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
-		c.position.x -= cubeMoveSpeed;
-	if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
-		c.position.x += cubeMoveSpeed;
-	if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS)
-		c.position.z += cubeMoveSpeed;
-	if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS)
-		c.position.z -= cubeMoveSpeed;
-
-	// Rotação cubo selecionado (IJKL/U/O)
-	if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS)
-		c.rotation.x += cubeRotateSpeed;
-	if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS)
-		c.rotation.x -= cubeRotateSpeed;
-	if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS)
-		c.rotation.y += cubeRotateSpeed;
-	if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS)
-		c.rotation.y -= cubeRotateSpeed;
-	if (glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS)
-		c.rotation.z += cubeRotateSpeed;
-	if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS)
-		c.rotation.z -= cubeRotateSpeed;
+	// Olhar pelo mouse e cliques, na ordem em que aconteceram
+	for (const InputEvent &e : input.events())
+	{
+		if (e.type == InputEvent::CURSOR)
+			mouse_callback(window, e.x, e.y);
+		else if (input.triggers(e, PICK))
+			pickAt(window, e.x, e.y);
+	}
+
+	// A recarga da cena pode ter removido todos os cubos
+	selectedCube = std::max(std::min(selectedCube, (int)cubes.size() - 1), 0);
+
+	// Movimento da câmera (WASD/QE) e do cubo selecionado (setas, R/F, IJKL/U/O):
+	// aplicados pela simulação a cada passo enquanto as ações estão ativas
+	uint32_t keys = 0;
+	for (int a = 0; a < SIM_ACTIONS; ++a)
+	{
+		if (input.down(a))
+			keys |= 1u << a;
+	}
+	simInput.keys.store(keys, memory_order_relaxed);
+	simInput.yaw.store(camera.getYaw(), memory_order_relaxed);
+	simInput.pitch.store(camera.getPitch(), memory_order_relaxed);
+	simInput.selected.store(cubes.empty() ? -1 : selectedCube, memory_order_relaxed);
+	return keys != 0 || !input.events().empty();
 }
-// Callback para controlar o olhar da câmera pelo mouse
+
+// Clique de seleção em (xpos, ypos): o cubo sob o centro da tela (mouse capturado)
+// ou sob o cursor
+void pickAt(GLFWwindow *window, double xpos, double ypos)
+{
+	float ndcX = 0.0f, ndcY = 0.0f;
+	if (!mouseEnabled)
+	{
+		int width, height;
+		glfwGetWindowSize(window, &width, &height);
+		ndcX = (float)(2.0 * xpos / width - 1.0);
+		ndcY = (float)(1.0 - 2.0 * ypos / height);
+	}
+
+	// Pela GPU: o pixel é desenhado no próximo frame e lido no seguinte
+	if (pickMode == PICK_GPU)
+	{
+		objectIds.requestPick((int)((ndcX * 0.5f + 0.5f) * WIDTH), (int)((ndcY * 0.5f + 0.5f) * HEIGHT));
+		return;
+	}
+
+	double start = glfwGetTime();
+	int hit = pickCube(ndcX, ndcY);
+	double us = (glfwGetTime() - start) * 1e6;
+	selectCube(hit, to_string(us) + " us");
+}
+
+// Aplica o resultado de uma seleção (-1: nada sob o cursor)
+void selectCube(int hit, const string &detail)
+{
+	if (hit < 0 || hit >= (int)cubes.size()) // a cena pode ter sido recarregada no meio
+	{
+		cout << "Nenhum cubo sob o cursor (" << detail << ")" << endl;
+		return;
+	}
+	selectedCube = hit;
+	cout << "Cubo selecionado: " << hit << " (id " << cubes[hit].id << ", " << detail << ")" << endl;
+}
+
+// Olhar da câmera pelo mouse, para cada evento de posição do cursor
 void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 {
     if (!mouseEnabled)
@@ -657,51 +1336,259 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
     camera.rotate(xoffset, yoffset);
 }
 
-bool loadCubesFromJSON(const string &jsonPath)
+// Material e textura do cubo i da cena; a textura vem do cache (0 se não carregar)
+Material sceneMaterial(const SceneDescription &scene, size_t i, const vec3 &scale, bool &textureFailed)
 {
-	cout << "Abrindo arquivo JSON: " << jsonPath << endl;
-	ifstream file("C:/Users/Kamar/Downloads/CGCCHibrido/assets/cube.json"); // substitua aqui pelo caminho absoluto
-	if (!file.is_open())
+	// Campos opcionais do material: "color", "specular" (0 desliga o termo
+	// especular) e "shininess"
+	Material material;
+	const SceneMaterial &m = scene.materials[i];
+	if (m.fields & SceneMaterial::HAS_COLOR)
+		material.color = m.color;
+	if (m.fields & SceneMaterial::HAS_SPECULAR)
+		material.specular = m.specular;
+	if (m.fields & SceneMaterial::HAS_SHININESS)
+		material.shininess = m.shininess;
+	material.nonUniformScale = scale.x != scale.y || scale.y != scale.z;
+	material.fog = fogDistance > 0.0f && renderPath != RENDER_DEFERRED;
+
+	// Sem textura o material usa só a cor (variante sem HAS_TEXTURE)
+	textureFailed = false;
+	if (scene.textures[i] >= 0)
 	{
-		cout << "Erro ao abrir arquivo JSON: " << jsonPath << endl;
-		return false;
+		const string &path = scene.texturePaths[scene.textures[i]];
+		auto it = textureCache.find(path);
+		if (it == textureCache.end())
+		{
+			it = textureCache.emplace(path, loadTexture(path)).first;
+			if (it->second == 0)
+				cout << "Falha ao carregar textura: " << path << endl;
+		}
+		material.texture = it->second;
+		textureFailed = it->second == 0;
 	}
+	return material;
+}
 
-	json j;
-	file >> j;
-
-	unordered_map<int, unsigned int> idToTextureID;
+// Trajetória do cubo i da cena (a posição inicial é o primeiro ponto); reaproveita
+// o espaço em trajectories se o cubo já tinha uma
+void setCubeTrajectory(Cube &cube, const SceneDescription &scene, size_t i)
+{
+	int32_t t = scene.trajectories[i];
+	if (t < 0)
+	{
+		cube.trajectory = -1;
+		return;
+	}
+	vector<vec3> points(scene.waypoints.begin() + scene.trajectoryStart[t], scene.waypoints.begin() + scene.trajectoryStart[t + 1]);
+	if (cube.trajectory >= 0)
+		trajectories[cube.trajectory].swap(points);
+	else
+	{
+		cube.trajectory = (int)trajectories.size();
+		trajectories.push_back(points);
+	}
+	cube.waypoint = 1;
+}
 
-	for (const auto &c : j)
+// Descarta as trajetórias sem cubo (removido ou sem "trajectory" na versão nova):
+// updateShadows inclui todas nos limites e as considera em movimento
+void compactTrajectories()
+{
+	vector<vector<vec3>> kept;
+	for (Cube &cube : cubes)
 	{
-		int id = c["id"];
-		string texPath = c["texture"];
-		cout << "Lendo cubo com id: " << id << ", textura: '" << texPath << "'" << endl;
+		if (cube.trajectory < 0)
+			continue;
+		kept.push_back(std::move(trajectories[cube.trajectory]));
+		cube.trajectory = (int)kept.size() - 1;
+	}
+	trajectories.swap(kept);
+}
 
-		if (texPath.empty())
-		{
-			cout << "loadTexture: caminho vazio para id " << id << endl;
-			continue; // evita tentar carregar textura vazia
-		}
+float cubeRadius(const Cube &cube)
+{
+	return meshRadius * std::max(cube.scale.x, std::max(cube.scale.y, cube.scale.z));
+}
 
-		if (idToTextureID.find(id) == idToTextureID.end())
+// Células do tamanho de um cubo: poucos objetos por célula e poucas células por objeto
+void rebuildPickGrid()
+{
+	pickGrid.setCellSize(2.0f * meshRadius);
+	for (size_t i = 0; i < cubes.size(); ++i)
+		pickGrid.insert((uint32_t)i, cubes[i].position, cubeRadius(cubes[i]));
+}
+
+// Cubo sob o ponto (ndcX, ndcY) da tela, -1 se nenhum
+int pickCube(float ndcX, float ndcY)
+{
+	mat4 inverseViewProjection = inverse(camera.getViewProjection());
+	vec4 nearPoint = inverseViewProjection * vec4(ndcX, ndcY, -1.0f, 1.0f);
+	vec4 farPoint = inverseViewProjection * vec4(ndcX, ndcY, 1.0f, 1.0f);
+	vec3 origin = vec3(nearPoint) / nearPoint.w;
+	vec3 dir = vec3(farPoint) / farPoint.w - origin;
+
+	// Teste exato: o raio no espaço do modelo contra a caixa do OBJ (slabs)
+	float t;
+	return pickGrid.raycast(origin, dir, 1.0f, t, [](uint32_t i, const vec3 &o, const vec3 &d, float &tHit)
+							{
+		const Cube &cube = cubes[i];
+		mat4 toModel = inverse(composeModel(cube.position, cube.rotation, cube.scale));
+		vec3 localOrigin = vec3(toModel * vec4(o, 1.0f)), localDir = vec3(toModel * vec4(d, 0.0f));
+		float tEnter = 0.0f, tExit = 1.0f;
+		for (int a = 0; a < 3; ++a)
 		{
-			unsigned int textureID = loadTexture(texPath);
-			if (textureID == 0)
+			// Paralelo ao eixo: dentro ou fora só pela origem (evita 0 / 0)
+			if (std::abs(localDir[a]) < 1e-12f)
 			{
-				cout << "Falha ao carregar textura: " << texPath << endl;
-				return false;
+				if (localOrigin[a] < meshBoundsMin[a] || localOrigin[a] > meshBoundsMax[a])
+					return false;
+				continue;
 			}
-			idToTextureID[id] = textureID;
+			float t1 = (meshBoundsMin[a] - localOrigin[a]) / localDir[a], t2 = (meshBoundsMax[a] - localOrigin[a]) / localDir[a];
+			tEnter = std::max(tEnter, std::min(t1, t2));
+			tExit = std::min(tExit, std::max(t1, t2));
 		}
+		tHit = tEnter;
+		return tEnter <= tExit; });
+}
 
+bool loadCubesFromJSON(const string &jsonPath)
+{
+	cout << "Abrindo cena: " << jsonPath << endl;
+	double start = glfwGetTime();
+	SceneDescription scene;
+	if (!loadSceneFile(jsonPath, scene))
+		return false;
+	cout << "Cena: " << scene.size() << " cubos, " << scene.texturePaths.size() << " texturas, " << scene.lights.size()
+		 << " luzes, lida em " << (glfwGetTime() - start) * 1000.0 << " ms" << endl;
+
+	// Formato com objeto raiz: "lights" e "ambient" (ver Lights.h)
+	if (scene.hasAmbient)
+		ambientColor = scene.ambient;
+	lights.insert(lights.end(), scene.lights.begin(), scene.lights.end());
+
+	cubes.reserve(cubes.size() + scene.size());
+	for (size_t i = 0; i < scene.size(); ++i)
+	{
 		Cube cube;
-		cube.position = vec3(c["initial_position"][0], c["initial_position"][1], c["initial_position"][2]);
+		cube.id = scene.ids[i];
+		cube.position = scene.positions[i];
 		cube.rotation = vec3(0.0f);
-		cube.scale = vec3(1.0f);
-		cube.textureID = idToTextureID[id];
-
+		cube.scale = scene.scales[i];
+		setCubeTrajectory(cube, scene, i);
+
+		bool textureFailed;
+		Material material = sceneMaterial(scene, i, cube.scale, textureFailed);
+		if (textureFailed)
+			return false;
+		cube.batch = batchForMaterial(material);
+		cubeIndexById[cube.id] = cubes.size();
 		cubes.push_back(cube);
 	}
+
+	// Acompanha o arquivo para a recarga a quente
+	scenePath = jsonPath;
+	loadedScene = std::move(scene);
+	string folder = filesystem::path(jsonPath).parent_path().string();
+	if (!sceneWatcher.watch(folder.empty() ? "." : folder))
+		cout << "Recarga da cena indisponível (não foi possível observar " << folder << ")" << endl;
 	return true;
-}
\ No newline at end of file
+}
+
+// Lê a cena de novo e aplica só as diferenças em relação à versão carregada
+void reloadScene()
+{
+	double start = glfwGetTime();
+	SceneDescription scene;
+	if (!loadSceneFile(scenePath, scene))
+	{
+		// Provavelmente o editor ainda está gravando: a próxima notificação tenta de novo
+		cout << "Cena mantida sem alterações" << endl;
+		return;
+	}
+	double readMs = (glfwGetTime() - start) * 1000.0;
+
+	start = glfwGetTime();
+	SceneDiff diff = diffScenes(loadedScene, scene);
+	if (!diff.reliable)
+		cout << "Ids repetidos na cena: todos os cubos são trocados" << endl;
+	stopSimulation(); // os cubos e as trajetórias mudam
+
+	// Alterados: só os campos que mudaram no arquivo (um cubo movido pelo teclado
+	// continua onde está se a posição dele no arquivo não mudou)
+	bool textureFailed;
+	for (const pair<size_t, size_t> &c : diff.changed)
+	{
+		size_t i = c.first, j = c.second;
+		Cube &cube = cubes[cubeIndexById[scene.ids[j]]];
+		if (loadedScene.positions[i] != scene.positions[j])
+			cube.position = scene.positions[j];
+		cube.scale = scene.scales[j];
+		cube.batch = batchForMaterial(sceneMaterial(scene, j, cube.scale, textureFailed));
+		if (textureFailed)
+			cout << "Cubo " << cube.id << ": textura não carregada, usando só a cor" << endl;
+		if (!sameTrajectory(loadedScene, i, scene, j))
+		{
+			cube.position = scene.positions[j];
+			setCubeTrajectory(cube, scene, j);
+		}
+	}
+
+	// Removidos: compacta cubes mantendo a ordem (as teclas 1-9 seguem os mesmos cubos)
+	if (!diff.removed.empty())
+	{
+		unordered_set<int> removedIds;
+		for (size_t i : diff.removed)
+			removedIds.insert(loadedScene.ids[i]);
+		size_t kept = 0;
+		for (size_t k = 0; k < cubes.size(); ++k)
+		{
+			if (cubes[k].id >= 0 && removedIds.count(cubes[k].id))
+				continue;
+			cubes[kept++] = cubes[k];
+		}
+		cubes.resize(kept);
+		cubeIndexById.clear();
+		for (size_t k = 0; k < cubes.size(); ++k)
+		{
+			if (cubes[k].id >= 0)
+				cubeIndexById[cubes[k].id] = k;
+		}
+	}
+
+	for (size_t j : diff.added)
+	{
+		Cube cube;
+		cube.id = scene.ids[j];
+		cube.position = scene.positions[j];
+		cube.rotation = vec3(0.0f);
+		cube.scale = scene.scales[j];
+		setCubeTrajectory(cube, scene, j);
+		cube.batch = batchForMaterial(sceneMaterial(scene, j, cube.scale, textureFailed));
+		if (textureFailed)
+			cout << "Cubo " << cube.id << ": textura não carregada, usando só a cor" << endl;
+		cubeIndexById[cube.id] = cubes.size();
+		cubes.push_back(cube);
+	}
+
+	if (diff.lightsChanged)
+	{
+		ambientColor = scene.hasAmbient ? scene.ambient : vec3(1.0f);
+		lights = scene.lights;
+		setupLights(extraLightCount);
+	}
+	if (!diff.empty())
+	{
+		shadowMap.invalidate();
+		shadowBoundsDirty = true;
+		rebuildPickGrid(); // a remoção muda os índices dos cubos
+	}
+	compactTrajectories();
+	startSimulation();
+
+	cout << "Cena recarregada: " << diff.added.size() << " cubos novos, " << diff.removed.size() << " removidos, "
+		 << diff.changed.size() << " alterados, " << diff.unchanged << " iguais" << (diff.lightsChanged ? ", luzes alteradas" : "")
+		 << " (leitura " << readMs << " ms, diferença e aplicação " << (glfwGetTime() - start) * 1000.0 << " ms)" << endl;
+	loadedScene = std::move(scene);
+}
@@ -0,0 +1,369 @@
+/*
+ * VertexFormat.h - formatos de vértice compactos (quantização de atributos)
+ *
+ * Cada atributo pode ser guardado em float (32 bits por componente) ou numa
+ * codificação compacta, decodificada no vertex shader por
+ * assets/shaders/vertex_decode.glsl (#include, ver ShaderManager.h):
+ *  - posição: float x3 (12 bytes) ou snorm16 x3 relativo à AABB da malha
+ *    (8 bytes com o preenchimento); o shader reconstrói p * escala + centro
+ *  - coordenada de textura: float x2 (8 bytes) ou half float x2 (4 bytes)
+ *  - normal: float x3 (12 bytes), octaédrica em snorm16 x2 (4 bytes) ou
+ *    xyz em GL_INT_2_10_10_10_REV (4 bytes, sem decodificação no shader)
+ *
+ * O layout continua intercalado, na ordem posição, textura, normal (locations 0, 1 e 2).
+ * VertexFormat::full() tem 32 bytes por vértice e VertexFormat::compact(), 16.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "MeshData.h"
+
+enum PositionEncoding
+{
+	POSITION_FLOAT32,
+	POSITION_SNORM16 // relativa à AABB: exige os uniforms positionScale/positionOffset
+};
+
+enum TexCoordEncoding
+{
+	TEXCOORD_FLOAT32,
+	TEXCOORD_HALF
+};
+
+enum NormalEncoding
+{
+	NORMAL_FLOAT32,
+	NORMAL_OCT16,		 // octaédrica, 2 x snorm16
+	NORMAL_INT_2_10_10_10 // xyz em 10 bits com sinal (w não usado)
+};
+
+struct VertexFormat
+{
+	PositionEncoding position = POSITION_FLOAT32;
+	TexCoordEncoding texCoord = TEXCOORD_FLOAT32;
+	NormalEncoding normal = NORMAL_FLOAT32;
+
+	static VertexFormat full() { return VertexFormat(); }
+
+	static VertexFormat compact(NormalEncoding normal = NORMAL_OCT16)
+	{
+		VertexFormat f;
+		f.position = POSITION_SNORM16;
+		f.texCoord = TEXCOORD_HALF;
+		f.normal = normal;
+		return f;
+	}
+
+	// "full", "compact" ou "compact10" (normais 10_10_10_2); falso se o nome não existe
+	static bool fromName(const std::string &name, VertexFormat &format)
+	{
+		if (name == "full")
+			format = full();
+		else if (name == "compact")
+			format = compact();
+		else if (name == "compact10")
+			format = compact(NORMAL_INT_2_10_10_10);
+		else
+			return false;
+		return true;
+	}
+
+	size_t positionBytes() const { return position == POSITION_FLOAT32 ? 12 : 8; }
+	size_t texCoordBytes() const { return texCoord == TEXCOORD_FLOAT32 ? 8 : 4; }
+	size_t normalBytes() const { return normal == NORMAL_FLOAT32 ? 12 : 4; }
+
+	size_t texCoordOffset() const { return positionBytes(); }
+	size_t normalOffset() const { return positionBytes() + texCoordBytes(); }
+	size_t stride() const { return positionBytes() + texCoordBytes() + normalBytes(); }
+
+	std::string name() const
+	{
+		std::string s = position == POSITION_FLOAT32 ? "pos f32" : "pos snorm16";
+		s += texCoord == TEXCOORD_FLOAT32 ? ", uv f32" : ", uv half";
+		s += normal == NORMAL_FLOAT32 ? ", normal f32" : normal == NORMAL_OCT16 ? ", normal oct16" : ", normal 10_10_10_2";
+		return s;
+	}
+};
+
+// --- codificação na CPU -----------------------------------------------------
+
+inline int16_t packSnorm16(float v)
+{
+	return (int16_t)std::lround(std::min(std::max(v, -1.0f), 1.0f) * 32767.0f);
+}
+
+inline float unpackSnorm16(int16_t v)
+{
+	return std::max(v / 32767.0f, -1.0f);
+}
+
+// float -> half (IEEE 754 binary16) com arredondamento para o par mais próximo
+inline uint16_t floatToHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	uint32_t sign = (bits >> 16) & 0x8000u;
+	uint32_t exponentBits = (bits >> 23) & 0xffu;
+	uint32_t mantissa = bits & 0x7fffffu;
+
+	if (exponentBits == 0xffu) // infinito ou NaN
+		return (uint16_t)(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+
+	int exponent = (int)exponentBits - 127 + 15;
+	if (exponent >= 31) // fora do alcance: infinito
+		return (uint16_t)(sign | 0x7c00u);
+
+	if (exponent <= 0) // subnormal em half
+	{
+		if (exponent < -10)
+			return (uint16_t)sign;
+		mantissa |= 0x800000u;
+		uint32_t shift = (uint32_t)(14 - exponent);
+		uint32_t half = mantissa >> shift;
+		uint32_t rest = mantissa & ((1u << shift) - 1u);
+		uint32_t middle = 1u << (shift - 1u);
+		if (rest > middle || (rest == middle && (half & 1u)))
+			++half;
+		return (uint16_t)(sign | half);
+	}
+
+	uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+	uint32_t rest = mantissa & 0x1fffu;
+	if (rest > 0x1000u || (rest == 0x1000u && (half & 1u)))
+		++half; // o carry para o expoente também é o resultado correto
+	return (uint16_t)half;
+}
+
+inline float halfToFloat(uint16_t half)
+{
+	uint32_t sign = (uint32_t)(half & 0x8000u) << 16;
+	uint32_t exponent = (half >> 10) & 0x1fu;
+	uint32_t mantissa = half & 0x3ffu;
+	uint32_t bits;
+
+	if (exponent == 0)
+	{
+		float f = std::ldexp((float)mantissa, -24);
+		return sign ? -f : f;
+	}
+	if (exponent == 31)
+		bits = sign | 0x7f800000u | (mantissa << 13);
+	else
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+
+	float f;
+	std::memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+// Projeção octaédrica de uma normal unitária no quadrado [-1, 1]^2
+inline glm::vec2 octEncode(glm::vec3 n)
+{
+	n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+	glm::vec2 p(n.x, n.y);
+	if (n.z < 0.0f)
+	{
+		p.x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+		p.y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return p;
+}
+
+inline glm::vec3 octDecode(glm::vec2 p)
+{
+	glm::vec3 v(p.x, p.y, 1.0f - std::abs(p.x) - std::abs(p.y));
+	if (v.z < 0.0f)
+	{
+		float x = v.x;
+		v.x = (1.0f - std::abs(v.y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		v.y = (1.0f - std::abs(x)) * (v.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return glm::normalize(v);
+}
+
+inline uint32_t packSnorm10(glm::vec3 n)
+{
+	uint32_t packed = 0;
+	for (int c = 0; c < 3; ++c)
+	{
+		int v = (int)std::lround(std::min(std::max(n[c], -1.0f), 1.0f) * 511.0f);
+		packed |= ((uint32_t)v & 0x3ffu) << (10 * c);
+	}
+	return packed;
+}
+
+inline glm::vec3 unpackSnorm10(uint32_t packed)
+{
+	glm::vec3 n;
+	for (int c = 0; c < 3; ++c)
+	{
+		int v = (int)((packed >> (10 * c)) & 0x3ffu);
+		if (v & 0x200)
+			v -= 0x400;
+		n[c] = std::max(v / 511.0f, -1.0f);
+	}
+	return n;
+}
+
+// Vértices codificados, prontos para o VBO
+struct PackedVertices
+{
+	VertexFormat format;
+	std::vector<uint8_t> bytes;
+	glm::vec3 positionScale = glm::vec3(1.0f);	// posição = decodificada * escala + centro
+	glm::vec3 positionOffset = glm::vec3(0.0f);
+	size_t vertexCount = 0;
+};
+
+inline PackedVertices packVertices(const MeshData &mesh, const VertexFormat &format)
+{
+	PackedVertices packed;
+	packed.format = format;
+	packed.vertexCount = mesh.vertexCount();
+
+	if (format.position == POSITION_SNORM16 && !mesh.positions.empty())
+	{
+		glm::vec3 lo = mesh.positions[0], hi = mesh.positions[0];
+		for (const glm::vec3 &p : mesh.positions)
+		{
+			lo = glm::min(lo, p);
+			hi = glm::max(hi, p);
+		}
+		packed.positionOffset = (lo + hi) * 0.5f;
+		packed.positionScale = (hi - lo) * 0.5f;
+		for (int c = 0; c < 3; ++c)
+			if (packed.positionScale[c] <= 0.0f)
+				packed.positionScale[c] = 1.0f; // malha plana neste eixo
+	}
+
+	size_t stride = format.stride();
+	packed.bytes.assign(stride * mesh.vertexCount(), 0);
+	for (size_t i = 0; i < mesh.vertexCount(); ++i)
+	{
+		uint8_t *v = packed.bytes.data() + i * stride;
+
+		const glm::vec3 &p = mesh.positions[i];
+		if (format.position == POSITION_FLOAT32)
+			std::memcpy(v, &p, 12);
+		else
+		{
+			glm::vec3 q = (p - packed.positionOffset) / packed.positionScale;
+			int16_t s[4] = {packSnorm16(q.x), packSnorm16(q.y), packSnorm16(q.z), 0};
+			std::memcpy(v, s, 8);
+		}
+
+		glm::vec2 t = i < mesh.texCoords.size() ? mesh.texCoords[i] : glm::vec2(0.0f);
+		uint8_t *tv = v + format.texCoordOffset();
+		if (format.texCoord == TEXCOORD_FLOAT32)
+			std::memcpy(tv, &t, 8);
+		else
+		{
+			uint16_t h[2] = {floatToHalf(t.s), floatToHalf(t.t)};
+			std::memcpy(tv, h, 4);
+		}
+
+		glm::vec3 n = i < mesh.normals.size() ? mesh.normals[i] : glm::vec3(0.0f, 1.0f, 0.0f);
+		uint8_t *nv = v + format.normalOffset();
+		if (format.normal == NORMAL_FLOAT32)
+			std::memcpy(nv, &n, 12);
+		else if (format.normal == NORMAL_OCT16)
+		{
+			glm::vec2 o = octEncode(n);
+			int16_t s[2] = {packSnorm16(o.x), packSnorm16(o.y)};
+			std::memcpy(nv, s, 4);
+		}
+		else
+		{
+			uint32_t s = packSnorm10(n);
+			std::memcpy(nv, &s, 4);
+		}
+	}
+	return packed;
+}
+
+// Inverso de packVertices para um vértice (medição do erro de quantização)
+inline void unpackVertex(const PackedVertices &packed, size_t i, glm::vec3 &position, glm::vec2 &texCoord, glm::vec3 &normal)
+{
+	const VertexFormat &format = packed.format;
+	const uint8_t *v = packed.bytes.data() + i * format.stride();
+
+	if (format.position == POSITION_FLOAT32)
+		std::memcpy(&position, v, 12);
+	else
+	{
+		int16_t s[3];
+		std::memcpy(s, v, 6);
+		position = glm::vec3(unpackSnorm16(s[0]), unpackSnorm16(s[1]), unpackSnorm16(s[2])) * packed.positionScale + packed.positionOffset;
+	}
+
+	const uint8_t *tv = v + format.texCoordOffset();
+	if (format.texCoord == TEXCOORD_FLOAT32)
+		std::memcpy(&texCoord, tv, 8);
+	else
+	{
+		uint16_t h[2];
+		std::memcpy(h, tv, 4);
+		texCoord = glm::vec2(halfToFloat(h[0]), halfToFloat(h[1]));
+	}
+
+	const uint8_t *nv = v + format.normalOffset();
+	if (format.normal == NORMAL_FLOAT32)
+		std::memcpy(&normal, nv, 12);
+	else if (format.normal == NORMAL_OCT16)
+	{
+		int16_t s[2];
+		std::memcpy(s, nv, 4);
+		normal = octDecode(glm::vec2(unpackSnorm16(s[0]), unpackSnorm16(s[1])));
+	}
+	else
+	{
+		uint32_t s;
+		std::memcpy(&s, nv, 4);
+		normal = glm::normalize(unpackSnorm10(s));
+	}
+}
+
+// Ponteiro só do atributo 0 (posição), para VAOs das passadas de profundidade
+inline void setupPositionAttribute(const VertexFormat &format)
+{
+	GLsizei stride = (GLsizei)format.stride();
+	if (format.position == POSITION_FLOAT32)
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid *)0);
+	else
+		glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, (GLvoid *)0);
+	glEnableVertexAttribArray(0);
+}
+
+// Ponteiros dos atributos 0 (posição), 1 (textura) e 2 (normal) para o VAO e o VBO ligados
+inline void setupVertexAttributes(const VertexFormat &format)
+{
+	GLsizei stride = (GLsizei)format.stride();
+
+	setupPositionAttribute(format);
+
+	GLvoid *texCoordOffset = (GLvoid *)format.texCoordOffset();
+	if (format.texCoord == TEXCOORD_FLOAT32)
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, texCoordOffset);
+	else
+		glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, stride, texCoordOffset);
+	glEnableVertexAttribArray(1);
+
+	GLvoid *normalOffset = (GLvoid *)format.normalOffset();
+	if (format.normal == NORMAL_FLOAT32)
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, normalOffset);
+	else if (format.normal == NORMAL_OCT16)
+		glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE, stride, normalOffset);
+	else
+		glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, normalOffset);
+	glEnableVertexAttribArray(2);
+}